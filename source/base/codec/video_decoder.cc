@@ -18,8 +18,11 @@
 
 #include "base/codec/video_decoder.h"
 
+#include "base/logging.h"
 #include "base/codec/video_decoder_vpx.h"
 #include "base/codec/video_decoder_zstd.h"
+#include "base/codec/video_util.h"
+#include "base/desktop/frame.h"
 
 namespace base {
 
@@ -42,4 +45,29 @@ std::unique_ptr<VideoDecoder> VideoDecoder::create(proto::VideoEncoding encoding
     }
 }
 
+// static
+bool VideoDecoder::applyMovedRects(const proto::VideoPacket& packet, Frame* frame)
+{
+    const Rect frame_rect = Rect::makeSize(frame->size());
+
+    for (int i = 0; i < packet.moved_rect_size(); ++i)
+    {
+        const proto::MovedRect& moved_rect = packet.moved_rect(i);
+
+        const Rect dest_rect = parseRect(moved_rect.dest_rect());
+        const Point source_pos(moved_rect.source_x(), moved_rect.source_y());
+
+        if (!frame_rect.containsRect(dest_rect) ||
+            !frame_rect.containsRect(Rect::makeXYWH(source_pos, dest_rect.size())))
+        {
+            LOG(LS_WARNING) << "The moved rectangle is outside the screen area";
+            return false;
+        }
+
+        frame->moveRect(source_pos, dest_rect);
+    }
+
+    return true;
+}
+
 } // namespace base
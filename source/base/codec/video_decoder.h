@@ -35,6 +35,11 @@ public:
     static std::unique_ptr<VideoDecoder> create(proto::VideoEncoding encoding);
 
     virtual bool decode(const proto::VideoPacket& packet, Frame* frame) = 0;
+
+protected:
+    // Copies the moved areas of |packet| inside |frame|. Must be called before the changed
+    // rectangles are drawn. Returns false if an area is outside of the frame.
+    static bool applyMovedRects(const proto::VideoPacket& packet, Frame* frame);
 };
 
 } // namespace base
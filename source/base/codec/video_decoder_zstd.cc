@@ -60,6 +60,9 @@ bool VideoDecoderZstd::decode(const proto::VideoPacket& packet, Frame* target_fr
         return false;
     }
 
+    if (!applyMovedRects(packet, target_frame))
+        return false;
+
     size_t ret = ZSTD_initDStream(stream_.get());
     DCHECK(!ZSTD_isError(ret)) << ZSTD_getErrorName(ret);
 
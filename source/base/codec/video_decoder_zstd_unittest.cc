@@ -0,0 +1,154 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+
+#include "base/codec/video_decoder_zstd.h"
+
+#include "base/codec/video_encoder_zstd.h"
+#include "base/codec/video_util.h"
+#include "base/desktop/frame_simple.h"
+#include "base/desktop/scroll_detector.h"
+#include "proto/desktop.pb.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <cstring>
+
+namespace base {
+
+namespace {
+
+const Size kFrameSize(640, 480);
+const int kCompressRatio = 8;
+
+// The alpha channel is not transferred, so it is left zero.
+void fillRect(Frame* frame, const Rect& rect)
+{
+    for (int y = rect.top(); y < rect.bottom(); ++y)
+    {
+        uint32_t* row = reinterpret_cast<uint32_t*>(frame->frameDataAtPos(rect.left(), y));
+
+        for (int x = 0; x < rect.width(); ++x)
+            row[x] = static_cast<uint32_t>(rand()) & 0x00FFFFFF;
+    }
+}
+
+bool isEqual(const Frame& frame1, const Frame& frame2)
+{
+    const size_t bytes_per_row =
+        static_cast<size_t>(frame1.size().width()) * frame1.format().bytesPerPixel();
+
+    for (int y = 0; y < frame1.size().height(); ++y)
+    {
+        if (memcmp(frame1.frameDataAtPos(0, y), frame2.frameDataAtPos(0, y), bytes_per_row) != 0)
+            return false;
+    }
+
+    return true;
+}
+
+void addMovedRect(const Rect& dest_rect, const Point& source_pos, proto::VideoPacket* packet)
+{
+    proto::MovedRect* moved_rect = packet->add_moved_rect();
+    serializeRect(dest_rect, moved_rect->mutable_dest_rect());
+    moved_rect->set_source_x(source_pos.x());
+    moved_rect->set_source_y(source_pos.y());
+}
+
+} // namespace
+
+TEST(VideoDecoderZstdTest, MovedRects)
+{
+    std::unique_ptr<FrameSimple> frame = FrameSimple::create(kFrameSize, PixelFormat::ARGB());
+    std::unique_ptr<FrameSimple> client_frame =
+        FrameSimple::create(kFrameSize, PixelFormat::ARGB());
+
+    std::unique_ptr<VideoEncoderZstd> encoder =
+        VideoEncoderZstd::create(PixelFormat::ARGB(), kCompressRatio);
+    std::unique_ptr<VideoDecoderZstd> decoder = VideoDecoderZstd::create();
+    ScrollDetector detector;
+    std::vector<ScrollDetector::MovedRect> moved_rects;
+    Region updated_region;
+
+    const Rect frame_rect = Rect::makeSize(kFrameSize);
+    fillRect(frame.get(), frame_rect);
+    frame->updatedRegion()->setRect(frame_rect);
+    detector.detect(*frame, &moved_rects, &updated_region);
+
+    proto::VideoPacket packet;
+    encoder->encode(frame.get(), &packet);
+    ASSERT_TRUE(decoder->decode(packet, client_frame.get()));
+    EXPECT_TRUE(isEqual(*frame, *client_frame));
+
+    const size_t full_packet_size = packet.ByteSizeLong();
+
+    // Scroll the content up and draw new lines at the bottom.
+    const int kScrollLines = 24;
+    frame->moveRect(Point(0, kScrollLines),
+                    Rect::makeWH(kFrameSize.width(), kFrameSize.height() - kScrollLines));
+    fillRect(frame.get(), Rect::makeLTRB(0, kFrameSize.height() - kScrollLines,
+                                         kFrameSize.width(), kFrameSize.height()));
+    frame->updatedRegion()->setRect(frame_rect);
+
+    detector.detect(*frame, &moved_rects, &updated_region);
+    ASSERT_EQ(moved_rects.size(), 1u);
+
+    packet.Clear();
+    for (const auto& moved_rect : moved_rects)
+        addMovedRect(moved_rect.dest_rect, moved_rect.source_pos, &packet);
+
+    frame->updatedRegion()->swap(&updated_region);
+    encoder->encode(frame.get(), &packet);
+
+    ASSERT_TRUE(decoder->decode(packet, client_frame.get()));
+    EXPECT_TRUE(isEqual(*frame, *client_frame));
+    EXPECT_LT(packet.ByteSizeLong(), full_packet_size / 10);
+}
+
+TEST(VideoDecoderZstdTest, MovedRectOutsideFrame)
+{
+    std::unique_ptr<FrameSimple> frame = FrameSimple::create(kFrameSize, PixelFormat::ARGB());
+    std::unique_ptr<FrameSimple> client_frame =
+        FrameSimple::create(kFrameSize, PixelFormat::ARGB());
+
+    std::unique_ptr<VideoEncoderZstd> encoder =
+        VideoEncoderZstd::create(PixelFormat::ARGB(), kCompressRatio);
+    std::unique_ptr<VideoDecoderZstd> decoder = VideoDecoderZstd::create();
+
+    fillRect(frame.get(), Rect::makeSize(kFrameSize));
+    frame->updatedRegion()->setRect(Rect::makeSize(kFrameSize));
+
+    proto::VideoPacket packet;
+    encoder->encode(frame.get(), &packet);
+    ASSERT_TRUE(decoder->decode(packet, client_frame.get()));
+
+    frame->updatedRegion()->setRect(Rect::makeWH(16, 16));
+
+    packet.Clear();
+    addMovedRect(Rect::makeXYWH(0, 0, 100, 100), Point(600, 0), &packet);
+    encoder->encode(frame.get(), &packet);
+    EXPECT_FALSE(decoder->decode(packet, client_frame.get()));
+
+    packet.Clear();
+    addMovedRect(Rect::makeXYWH(-1, 0, 100, 100), Point(0, 0), &packet);
+    encoder->encode(frame.get(), &packet);
+    EXPECT_FALSE(decoder->decode(packet, client_frame.get()));
+}
+
+} // namespace base
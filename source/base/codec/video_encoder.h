@@ -34,6 +34,9 @@ public:
 
     virtual void encode(const Frame* frame, proto::VideoPacket* packet) = 0;
 
+    // Sets the measured bandwidth of the network. Encoders without rate control ignore it.
+    virtual void setBandwidthEstimateKbps(int /* bandwidth_kbps */) {}
+
     proto::VideoEncoding encoding() const { return encoding_; }
 
 protected:
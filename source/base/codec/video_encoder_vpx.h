@@ -42,7 +42,7 @@ public:
     static std::unique_ptr<VideoEncoderVPX> createVP9();
 
     void encode(const Frame* frame, proto::VideoPacket* packet) override;
-    void setBandwidthEstimateKbps(int bandwidth_kbps);
+    void setBandwidthEstimateKbps(int bandwidth_kbps) override;
 
 private:
     explicit VideoEncoderVPX(proto::VideoEncoding encoding);
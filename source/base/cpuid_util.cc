@@ -21,11 +21,13 @@
 
 #include "base/bitset.h"
 
+#if defined(ARCH_CPU_X86_FAMILY)
 #if defined(CC_MSVC)
 #include <intrin.h>
 #else
 #include <cpuid.h>
 #endif // CC_MSVC
+#endif // defined(ARCH_CPU_X86_FAMILY)
 #include <cstring>
 
 namespace base {
@@ -44,7 +46,25 @@ CpuidUtil& CpuidUtil::operator=(const CpuidUtil& other)
     return *this;
 }
 
-#if defined(CC_MSVC)
+#if !defined(ARCH_CPU_X86_FAMILY)
+
+void CpuidUtil::get(int /* leaf */)
+{
+    memset(cpu_info_, 0, sizeof(cpu_info_));
+}
+
+void CpuidUtil::get(int /* leaf */, int /* subleaf */)
+{
+    memset(cpu_info_, 0, sizeof(cpu_info_));
+}
+
+// static
+uint64_t CpuidUtil::xcr0()
+{
+    return 0;
+}
+
+#elif defined(CC_MSVC)
 
 void CpuidUtil::get(int leaf)
 {
@@ -56,6 +76,12 @@ void CpuidUtil::get(int leaf, int subleaf)
     __cpuidex(cpu_info_, leaf, subleaf);
 }
 
+// static
+uint64_t CpuidUtil::xcr0()
+{
+    return _xgetbv(0);
+}
+
 #else
 
 void CpuidUtil::get(int leaf)
@@ -68,6 +94,16 @@ void CpuidUtil::get(int leaf, int subleaf)
     __get_cpuid_count(leaf, subleaf, &cpu_info_[0], &cpu_info_[1], &cpu_info_[2], &cpu_info_[3]);
 }
 
+// static
+uint64_t CpuidUtil::xcr0()
+{
+    uint32_t eax;
+    uint32_t edx;
+
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<uint64_t>(edx) << 32) | eax;
+}
+
 #endif // CC_MSVC
 
 // static
@@ -81,4 +117,49 @@ bool CpuidUtil::hasAesNi()
     return BitSet<uint32_t>(CpuidUtil(1).ecx()).test(25);
 }
 
+// static
+bool CpuidUtil::hasSse2()
+{
+    if (CpuidUtil(0).eax() < 1)
+        return false;
+
+    // Bit 26 of register EDX set to 1 indicates the support of SSE2 instructions.
+    return BitSet<uint32_t>(CpuidUtil(1).edx()).test(26);
+}
+
+// static
+bool CpuidUtil::hasAvx2()
+{
+    // Check if function 7 is supported.
+    if (CpuidUtil(0).eax() < 7)
+        return false;
+
+    // Bits 27 (OSXSAVE) and 28 (AVX) of register ECX.
+    BitSet<uint32_t> features(CpuidUtil(1).ecx());
+    if (!features.test(27) || !features.test(28))
+        return false;
+
+    // The operating system must save the state of XMM (bit 1) and YMM (bit 2) registers.
+    if ((xcr0() & 0x06) != 0x06)
+        return false;
+
+    // Bit 5 of register EBX set to 1 indicates the support of AVX2 instructions.
+    return BitSet<uint32_t>(CpuidUtil(7, 0).ebx()).test(5);
+}
+
+// static
+bool CpuidUtil::hasAvx512()
+{
+    if (!hasAvx2())
+        return false;
+
+    // The operating system must also save the state of opmask registers (bit 5) and ZMM registers
+    // (bits 6 and 7).
+    if ((xcr0() & 0xE6) != 0xE6)
+        return false;
+
+    // Bit 16 of register EBX set to 1 indicates the support of AVX-512 Foundation instructions.
+    return BitSet<uint32_t>(CpuidUtil(7, 0).ebx()).test(16);
+}
+
 } // namespace base
@@ -46,8 +46,18 @@ public:
     uint32_t edx() const { return static_cast<uint32_t>(cpu_info_[kEDX]); }
 
     static bool hasAesNi();
+    static bool hasSse2();
+
+    // Returns true if the processor supports the instruction set and the operating system saves
+    // the state of the extended registers when switching context.
+    static bool hasAvx2();
+    static bool hasAvx512();
 
 private:
+    // Returns bits of XCR0 register which indicate the register states saved by the operating
+    // system.
+    static uint64_t xcr0();
+
     static constexpr int kEAX = 0;
     static constexpr int kEBX = 1;
     static constexpr int kECX = 2;
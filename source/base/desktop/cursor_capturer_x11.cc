@@ -19,22 +19,104 @@
 #include "base/desktop/cursor_capturer_x11.h"
 
 #include "base/logging.h"
+#include "base/desktop/mouse_cursor.h"
+
+#include <X11/Xlib.h>
+#include <X11/extensions/Xfixes.h>
 
 namespace base {
 
 CursorCapturerX11::CursorCapturerX11() = default;
 
-CursorCapturerX11::~CursorCapturerX11() = default;
+CursorCapturerX11::~CursorCapturerX11()
+{
+    reset();
+}
 
 const MouseCursor* CursorCapturerX11::captureCursor()
 {
-    NOTIMPLEMENTED();
-    return nullptr;
+    if (!display_ && !init())
+        return nullptr;
+
+    while (XPending(display_))
+    {
+        XEvent event;
+        XNextEvent(display_, &event);
+
+        if (event.type == xfixes_event_base_ + XFixesCursorNotify)
+            cursor_changed_ = true;
+    }
+
+    if (!cursor_changed_)
+        return nullptr;
+
+    XFixesCursorImage* cursor_image = XFixesGetCursorImage(display_);
+    if (!cursor_image)
+    {
+        LOG(LS_WARNING) << "XFixesGetCursorImage failed";
+        return nullptr;
+    }
+
+    cursor_changed_ = false;
+
+    const Size size(cursor_image->width, cursor_image->height);
+    const size_t pixel_count = static_cast<size_t>(size.width()) * size.height();
+
+    ByteArray image;
+    image.resize(pixel_count * sizeof(uint32_t));
+
+    // The pixels are returned as unsigned long, which is 64 bits wide on 64-bit systems, but only
+    // the lower 32 bits contain ARGB.
+    uint32_t* dst = reinterpret_cast<uint32_t*>(image.data());
+    for (size_t i = 0; i < pixel_count; ++i)
+        dst[i] = static_cast<uint32_t>(cursor_image->pixels[i]);
+
+    const Point hotspot(cursor_image->xhot, cursor_image->yhot);
+    XFree(cursor_image);
+
+    std::unique_ptr<MouseCursor> mouse_cursor =
+        std::make_unique<MouseCursor>(std::move(image), size, hotspot);
+
+    if (mouse_cursor_ && mouse_cursor_->equals(*mouse_cursor))
+        return nullptr;
+
+    mouse_cursor_ = std::move(mouse_cursor);
+    return mouse_cursor_.get();
 }
 
 void CursorCapturerX11::reset()
 {
-    NOTIMPLEMENTED();
+    mouse_cursor_.reset();
+    cursor_changed_ = true;
+
+    if (display_)
+    {
+        XCloseDisplay(display_);
+        display_ = nullptr;
+    }
+}
+
+bool CursorCapturerX11::init()
+{
+    DCHECK(!display_);
+
+    display_ = XOpenDisplay(nullptr);
+    if (!display_)
+    {
+        LOG(LS_WARNING) << "Unable to open display";
+        return false;
+    }
+
+    int error_base = 0;
+    if (!XFixesQueryExtension(display_, &xfixes_event_base_, &error_base))
+    {
+        LOG(LS_WARNING) << "XFixes extension is not available";
+        reset();
+        return false;
+    }
+
+    XFixesSelectCursorInput(display_, DefaultRootWindow(display_), XFixesDisplayCursorNotifyMask);
+    return true;
 }
 
 } // namespace base
@@ -20,10 +20,17 @@
 #define BASE__DESKTOP__CURSOR_CAPTURER_X11_H
 
 #include "base/macros_magic.h"
-#include "desktop/cursor_capturer.h"
+#include "base/desktop/cursor_capturer.h"
+
+#include <memory>
+
+// Xlib.h defines macros that conflict with other headers, so it is included only by the source.
+typedef struct _XDisplay Display;
 
 namespace base {
 
+// Captures the cursor image with the XFixes extension. The image is read again only after the
+// server reports that the cursor has changed.
 class CursorCapturerX11 : public CursorCapturer
 {
 public:
@@ -34,6 +41,13 @@ public:
     void reset() override;
 
 private:
+    bool init();
+
+    Display* display_ = nullptr;
+    int xfixes_event_base_ = 0;
+    bool cursor_changed_ = true;
+    std::unique_ptr<MouseCursor> mouse_cursor_;
+
     DISALLOW_COPY_AND_ASSIGN(CursorCapturerX11);
 };
 
@@ -0,0 +1,90 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#include "base/desktop/diff_block_32bpp_avx2.h"
+
+#include "build/build_config.h"
+
+#if defined(ARCH_CPU_X86_FAMILY)
+
+#if defined(CC_MSVC)
+#include <intrin.h>
+#define TARGET_AVX2
+#else
+#include <immintrin.h>
+// The file is compiled without -mavx2, so the rest of the program does not use AVX2 instructions.
+// The functions are called only if the processor supports them.
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace base {
+
+namespace {
+
+// Returns XOR of 32 bytes of both images. The result is zero if the bytes are equal.
+TARGET_AVX2 FORCEINLINE __m256i diff32(const uint8_t* image1, const uint8_t* image2)
+{
+    return _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(image1)),
+                            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(image2)));
+}
+
+} // namespace
+
+TARGET_AVX2 uint8_t diffFullBlock_32bpp_32x32_AVX2(
+    const uint8_t* image1, const uint8_t* image2, int bytes_per_row)
+{
+    for (int i = 0; i < 32; ++i)
+    {
+        __m256i acc = diff32(image1, image2);
+        acc = _mm256_or_si256(acc, diff32(image1 + 32, image2 + 32));
+        acc = _mm256_or_si256(acc, diff32(image1 + 64, image2 + 64));
+        acc = _mm256_or_si256(acc, diff32(image1 + 96, image2 + 96));
+
+        // If the row has differences.
+        if (!_mm256_testz_si256(acc, acc))
+            return 1U;
+
+        image1 += bytes_per_row;
+        image2 += bytes_per_row;
+    }
+
+    return 0U;
+}
+
+TARGET_AVX2 uint8_t diffFullBlock_32bpp_16x16_AVX2(
+    const uint8_t* image1, const uint8_t* image2, int bytes_per_row)
+{
+    for (int i = 0; i < 16; ++i)
+    {
+        __m256i acc = diff32(image1, image2);
+        acc = _mm256_or_si256(acc, diff32(image1 + 32, image2 + 32));
+
+        // If the row has differences.
+        if (!_mm256_testz_si256(acc, acc))
+            return 1U;
+
+        image1 += bytes_per_row;
+        image2 += bytes_per_row;
+    }
+
+    return 0U;
+}
+
+} // namespace base
+
+#endif // defined(ARCH_CPU_X86_FAMILY)
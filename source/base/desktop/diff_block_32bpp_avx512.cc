@@ -0,0 +1,86 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#include "base/desktop/diff_block_32bpp_avx512.h"
+
+#include "build/build_config.h"
+
+#if defined(ARCH_CPU_X86_FAMILY)
+
+#if defined(CC_MSVC)
+#include <intrin.h>
+#define TARGET_AVX512
+#else
+#include <immintrin.h>
+// The functions are called only if the processor supports AVX-512 Foundation instructions.
+#define TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+
+namespace base {
+
+namespace {
+
+// Returns XOR of 64 bytes (16 pixels) of both images. The result is zero if the bytes are equal.
+TARGET_AVX512 FORCEINLINE __m512i diff64(const uint8_t* image1, const uint8_t* image2)
+{
+    return _mm512_xor_si512(_mm512_loadu_si512(image1), _mm512_loadu_si512(image2));
+}
+
+} // namespace
+
+TARGET_AVX512 uint8_t diffFullBlock_32bpp_32x32_AVX512(
+    const uint8_t* image1, const uint8_t* image2, int bytes_per_row)
+{
+    for (int i = 0; i < 32; ++i)
+    {
+        __m512i acc = _mm512_or_si512(diff64(image1, image2), diff64(image1 + 64, image2 + 64));
+
+        // If the row has differences.
+        if (_mm512_test_epi64_mask(acc, acc))
+            return 1U;
+
+        image1 += bytes_per_row;
+        image2 += bytes_per_row;
+    }
+
+    return 0U;
+}
+
+TARGET_AVX512 uint8_t diffFullBlock_32bpp_16x16_AVX512(
+    const uint8_t* image1, const uint8_t* image2, int bytes_per_row)
+{
+    for (int i = 0; i < 16; i += 2)
+    {
+        // A row of the block fits into one register, so two rows are checked at once.
+        __m512i acc = _mm512_or_si512(diff64(image1, image2),
+                                      diff64(image1 + bytes_per_row, image2 + bytes_per_row));
+
+        // If the rows have differences.
+        if (_mm512_test_epi64_mask(acc, acc))
+            return 1U;
+
+        image1 += bytes_per_row * 2;
+        image2 += bytes_per_row * 2;
+    }
+
+    return 0U;
+}
+
+} // namespace base
+
+#endif // defined(ARCH_CPU_X86_FAMILY)
@@ -16,12 +16,12 @@
 // along with this program. If not, see <https://www.gnu.org/licenses/>.
 //
 
+#include "base/desktop/diff_block_32bpp_c.h"
 #include "base/memory/aligned_memory.h"
-#include "desktop/diff_block_32bpp_c.h"
 
 #include <gtest/gtest.h>
 
-namespace desktop {
+namespace base {
 
 namespace {
 
@@ -193,4 +193,4 @@ TEST(diff_block_c, block_difference_test_first)
     }
 }
 
-} // namespace desktop
+} // namespace base
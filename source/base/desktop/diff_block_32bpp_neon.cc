@@ -0,0 +1,83 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#include "base/desktop/diff_block_32bpp_neon.h"
+
+#include "build/build_config.h"
+
+#if defined(ARCH_CPU_ARM_FAMILY) && (defined(__ARM_NEON) || defined(CC_MSVC))
+
+#include <arm_neon.h>
+
+namespace base {
+
+namespace {
+
+// Returns XOR of 64 bytes (16 pixels) of both images folded into one register. The result is zero
+// if the bytes are equal.
+FORCEINLINE uint8x16_t diff64(const uint8_t* image1, const uint8_t* image2)
+{
+    uint8x16_t acc = veorq_u8(vld1q_u8(image1), vld1q_u8(image2));
+    acc = vorrq_u8(acc, veorq_u8(vld1q_u8(image1 + 16), vld1q_u8(image2 + 16)));
+    acc = vorrq_u8(acc, veorq_u8(vld1q_u8(image1 + 32), vld1q_u8(image2 + 32)));
+    return vorrq_u8(acc, veorq_u8(vld1q_u8(image1 + 48), vld1q_u8(image2 + 48)));
+}
+
+FORCEINLINE bool isZero(uint8x16_t value)
+{
+    uint64x2_t value64 = vreinterpretq_u64_u8(value);
+    return (vgetq_lane_u64(value64, 0) | vgetq_lane_u64(value64, 1)) == 0;
+}
+
+} // namespace
+
+uint8_t diffFullBlock_32bpp_32x32_NEON(
+    const uint8_t* image1, const uint8_t* image2, int bytes_per_row)
+{
+    for (int i = 0; i < 32; ++i)
+    {
+        // If the row has differences.
+        if (!isZero(vorrq_u8(diff64(image1, image2), diff64(image1 + 64, image2 + 64))))
+            return 1U;
+
+        image1 += bytes_per_row;
+        image2 += bytes_per_row;
+    }
+
+    return 0U;
+}
+
+uint8_t diffFullBlock_32bpp_16x16_NEON(
+    const uint8_t* image1, const uint8_t* image2, int bytes_per_row)
+{
+    for (int i = 0; i < 16; ++i)
+    {
+        // If the row has differences.
+        if (!isZero(diff64(image1, image2)))
+            return 1U;
+
+        image1 += bytes_per_row;
+        image2 += bytes_per_row;
+    }
+
+    return 0U;
+}
+
+} // namespace base
+
+#endif // defined(ARCH_CPU_ARM_FAMILY) && (defined(__ARM_NEON) || defined(CC_MSVC))
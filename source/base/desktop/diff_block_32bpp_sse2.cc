@@ -20,6 +20,8 @@
 
 #include "build/build_config.h"
 
+#if defined(ARCH_CPU_X86_FAMILY)
+
 #if defined(CC_MSVC)
 #include <intrin.h>
 #else
@@ -118,3 +120,5 @@ uint8_t diffFullBlock_32bpp_16x16_SSE2(
 }
 
 } // namespace base
+
+#endif // defined(ARCH_CPU_X86_FAMILY)
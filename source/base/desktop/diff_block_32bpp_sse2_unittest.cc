@@ -16,13 +16,13 @@
 // along with this program. If not, see <https://www.gnu.org/licenses/>.
 //
 
+#include "base/cpuid_util.h"
+#include "base/desktop/diff_block_32bpp_sse2.h"
 #include "base/memory/aligned_memory.h"
-#include "desktop/diff_block_32bpp_sse2.h"
 
 #include <gtest/gtest.h>
-#include <libyuv/cpu_id.h>
 
-namespace desktop {
+namespace base {
 
 namespace {
 
@@ -60,7 +60,7 @@ void prepareBuffers(AlignedBuffer* block1, AlignedBuffer* block2, int block_size
 
 TEST(diff_block_sse2, block_difference_test_same)
 {
-    if (!libyuv::TestCpuFlag(libyuv::kCpuHasSSE2))
+    if (!CpuidUtil::hasSse2())
         return;
 
     AlignedBuffer block1;
@@ -97,7 +97,7 @@ TEST(diff_block_sse2, block_difference_test_same)
 
 TEST(diff_block_sse2, block_difference_test_last)
 {
-    if (!libyuv::TestCpuFlag(libyuv::kCpuHasSSE2))
+    if (!CpuidUtil::hasSse2())
         return;
 
     AlignedBuffer block1;
@@ -134,7 +134,7 @@ TEST(diff_block_sse2, block_difference_test_last)
 
 TEST(diff_block_sse2, block_difference_test_mid)
 {
-    if (!libyuv::TestCpuFlag(libyuv::kCpuHasSSE2))
+    if (!CpuidUtil::hasSse2())
         return;
 
     AlignedBuffer block1;
@@ -171,7 +171,7 @@ TEST(diff_block_sse2, block_difference_test_mid)
 
 TEST(diff_block_sse2, block_difference_test_first)
 {
-    if (!libyuv::TestCpuFlag(libyuv::kCpuHasSSE2))
+    if (!CpuidUtil::hasSse2())
         return;
 
     AlignedBuffer block1;
@@ -206,4 +206,4 @@ TEST(diff_block_sse2, block_difference_test_first)
     }
 }
 
-} // namespace desktop
+} // namespace base
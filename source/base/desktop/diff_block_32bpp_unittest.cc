@@ -0,0 +1,160 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#include "base/cpuid_util.h"
+#include "base/desktop/diff_block_32bpp_avx2.h"
+#include "base/desktop/diff_block_32bpp_avx512.h"
+#include "base/desktop/diff_block_32bpp_c.h"
+#include "base/desktop/diff_block_32bpp_neon.h"
+#include "base/desktop/diff_block_32bpp_sse2.h"
+#include "base/memory/aligned_memory.h"
+#include "build/build_config.h"
+
+#include <gtest/gtest.h>
+
+namespace base {
+
+namespace {
+
+using AlignedBuffer = std::unique_ptr<uint8_t, AlignedFreeDeleter>;
+using DiffFullBlockFunc = uint8_t(*)(const uint8_t*, const uint8_t*, int);
+
+// The same checks are done for each implementation that can be used on the current processor.
+struct DiffFunctions
+{
+    const char* name;
+    bool (*is_supported)();
+    DiffFullBlockFunc block_16x16;
+    DiffFullBlockFunc block_32x32;
+};
+
+bool alwaysSupported()
+{
+    return true;
+}
+
+const DiffFunctions kDiffFunctions[] =
+{
+    { "C", alwaysSupported, diffFullBlock_32bpp_16x16_C, diffFullBlock_32bpp_32x32_C },
+#if defined(ARCH_CPU_X86_FAMILY)
+    { "SSE2", CpuidUtil::hasSse2,
+      diffFullBlock_32bpp_16x16_SSE2, diffFullBlock_32bpp_32x32_SSE2 },
+    { "AVX2", CpuidUtil::hasAvx2,
+      diffFullBlock_32bpp_16x16_AVX2, diffFullBlock_32bpp_32x32_AVX2 },
+    { "AVX512", CpuidUtil::hasAvx512,
+      diffFullBlock_32bpp_16x16_AVX512, diffFullBlock_32bpp_32x32_AVX512 },
+#endif // defined(ARCH_CPU_X86_FAMILY)
+#if defined(ARCH_CPU_ARM_FAMILY) && (defined(__ARM_NEON) || defined(CC_MSVC))
+    { "NEON", alwaysSupported,
+      diffFullBlock_32bpp_16x16_NEON, diffFullBlock_32bpp_32x32_NEON },
+#endif
+};
+
+// Run 900 times to mimic 1280x720.
+const int kTimesToRun = 900;
+const int kBytesPerPixel = 4;
+const int kAlignment = 16;
+
+// The block is not changed.
+const int kNoChange = -1;
+
+int fullBlockSize(int block_size)
+{
+    return block_size * block_size * kBytesPerPixel;
+}
+
+class DiffBlockTest : public testing::TestWithParam<DiffFunctions>
+{
+protected:
+    // Compares a block with its copy in which the byte at |changed_byte| is changed.
+    void checkBlock(int block_size, int changed_byte, uint8_t expected)
+    {
+        const DiffFunctions& functions = GetParam();
+        const int full_block_size = fullBlockSize(block_size);
+
+        AlignedBuffer block1(reinterpret_cast<uint8_t*>(alignedAlloc(full_block_size, kAlignment)));
+        AlignedBuffer block2(reinterpret_cast<uint8_t*>(alignedAlloc(full_block_size, kAlignment)));
+
+        for (int i = 0; i < full_block_size; ++i)
+            block1.get()[i] = static_cast<uint8_t>(i);
+
+        memcpy(block2.get(), block1.get(), full_block_size);
+
+        if (changed_byte != kNoChange)
+            block2.get()[changed_byte] += 1;
+
+        DiffFullBlockFunc diff_full_block =
+            block_size == 32 ? functions.block_32x32 : functions.block_16x16;
+
+        for (int i = 0; i < kTimesToRun; ++i)
+        {
+            EXPECT_EQ(expected,
+                      diff_full_block(block1.get(), block2.get(), block_size * kBytesPerPixel));
+        }
+    }
+
+    bool isSupported() const { return GetParam().is_supported(); }
+};
+
+} // namespace
+
+TEST_P(DiffBlockTest, block_difference_test_same)
+{
+    if (!isSupported())
+        return;
+
+    checkBlock(32, kNoChange, 0);
+    checkBlock(16, kNoChange, 0);
+}
+
+TEST_P(DiffBlockTest, block_difference_test_last)
+{
+    if (!isSupported())
+        return;
+
+    checkBlock(32, fullBlockSize(32) - 2, 1);
+    checkBlock(16, fullBlockSize(16) - 2, 1);
+}
+
+TEST_P(DiffBlockTest, block_difference_test_mid)
+{
+    if (!isSupported())
+        return;
+
+    checkBlock(32, fullBlockSize(32) / 2 + 1, 1);
+    checkBlock(16, fullBlockSize(16) / 2 + 1, 1);
+}
+
+TEST_P(DiffBlockTest, block_difference_test_first)
+{
+    if (!isSupported())
+        return;
+
+    checkBlock(32, 0, 1);
+    checkBlock(16, 0, 1);
+}
+
+INSTANTIATE_TEST_SUITE_P(diff_block,
+                         DiffBlockTest,
+                         testing::ValuesIn(kDiffFunctions),
+                         [](const testing::TestParamInfo<DiffFunctions>& info)
+{
+    return std::string(info.param.name);
+});
+
+} // namespace base
@@ -18,20 +18,72 @@
 
 #include "base/desktop/differ.h"
 
+#include "base/cpuid_util.h"
 #include "base/logging.h"
-#include "base/desktop/diff_block_32bpp_sse2.h"
+#include "base/sys_info.h"
+#include "base/desktop/diff_block_32bpp_avx2.h"
+#include "base/desktop/diff_block_32bpp_avx512.h"
 #include "base/desktop/diff_block_32bpp_c.h"
+#include "base/desktop/diff_block_32bpp_neon.h"
+#include "base/desktop/diff_block_32bpp_sse2.h"
+#include "build/build_config.h"
 
+#include <algorithm>
+#include <condition_variable>
 #include <cstring>
-#include <libyuv/cpu_id.h>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace base {
 
 namespace {
 
-const int kBlockSize = 16;
 const int kBytesPerPixel = 4;
-const int kBytesPerBlock = kBlockSize * kBytesPerPixel;
+
+// The number of pixels of the frame for each thread that compares blocks. Smaller frames are
+// compared faster than threads are woken up.
+const int kPixelsPerThread = 2 * 1024 * 1024;
+
+// Maximum number of threads that are used by default. The comparison is limited by the memory
+// bandwidth, so more threads do not make it faster.
+const int kMaxDefaultThreadCount = 4;
+
+// The frame is divided into more bands than there are threads, so that threads which finish
+// their bands early (e.g. because the blocks are different at the first row) take the remaining
+// ones.
+const int kBandsPerThread = 4;
+
+using DiffFullBlockFunc = uint8_t(*)(const uint8_t*, const uint8_t*, int);
+
+struct DiffFunctions
+{
+    const char* name;
+    DiffFullBlockFunc block_16x16;
+    DiffFullBlockFunc block_32x32;
+};
+
+// Selects the fastest functions supported by the processor.
+DiffFunctions selectDiffFunctions()
+{
+#if defined(ARCH_CPU_ARM_FAMILY) && (defined(__ARM_NEON) || defined(CC_MSVC))
+    return { "NEON", diffFullBlock_32bpp_16x16_NEON, diffFullBlock_32bpp_32x32_NEON };
+#else
+#if defined(ARCH_CPU_X86_FAMILY)
+    if (CpuidUtil::hasAvx512())
+        return { "AVX-512", diffFullBlock_32bpp_16x16_AVX512, diffFullBlock_32bpp_32x32_AVX512 };
+
+    if (CpuidUtil::hasAvx2())
+        return { "AVX2", diffFullBlock_32bpp_16x16_AVX2, diffFullBlock_32bpp_32x32_AVX2 };
+
+    if (CpuidUtil::hasSse2())
+        return { "SSE2", diffFullBlock_32bpp_16x16_SSE2, diffFullBlock_32bpp_32x32_SSE2 };
+#endif // defined(ARCH_CPU_X86_FAMILY)
+
+    return { "C", diffFullBlock_32bpp_16x16_C, diffFullBlock_32bpp_32x32_C };
+#endif
+}
 
 // Check for diffs in upper-left portion of the block. The size of the portion to check is
 // specified by the |width| and |height| values.
@@ -55,17 +107,133 @@ uint8_t diffPartialBlock(const uint8_t* prev_image,
     return 0U;
 }
 
+} // namespace
 
+class Differ::WorkerPool
+{
+public:
+    // Creates |thread_count| - 1 threads, the calling thread of run() is also used.
+    explicit WorkerPool(int thread_count);
+    ~WorkerPool();
 
-} // namespace
+    int threadCount() const { return static_cast<int>(threads_.size()) + 1; }
+
+    // Calls |task| for each index from 0 to |count| (not including) on the threads of the pool and
+    // on the calling thread. Returns when all calls are completed.
+    void run(int count, const std::function<void(int)>& task);
+
+private:
+    void threadMain();
+
+    // Calls the tasks of |generation| until there are no more tasks left.
+    void runTasks(uint64_t generation);
+
+    std::vector<std::thread> threads_;
+
+    std::mutex lock_;
+    std::condition_variable work_event_;
+    std::condition_variable done_event_;
+
+    // The tasks are taken only if they belong to the current generation, so a thread that woke up
+    // late does not take the tasks of the next call of run().
+    uint64_t generation_ = 0;
+    const std::function<void(int)>* task_ = nullptr;
+    int task_count_ = 0;
+    int next_task_ = 0;
+    int pending_tasks_ = 0;
+    bool stopping_ = false;
+
+    DISALLOW_COPY_AND_ASSIGN(WorkerPool);
+};
+
+Differ::WorkerPool::WorkerPool(int thread_count)
+{
+    for (int i = 1; i < thread_count; ++i)
+        threads_.emplace_back(&WorkerPool::threadMain, this);
+}
+
+Differ::WorkerPool::~WorkerPool()
+{
+    {
+        std::scoped_lock lock(lock_);
+        stopping_ = true;
+    }
+
+    work_event_.notify_all();
+
+    for (auto& thread : threads_)
+        thread.join();
+}
+
+void Differ::WorkerPool::run(int count, const std::function<void(int)>& task)
+{
+    uint64_t generation;
+
+    {
+        std::scoped_lock lock(lock_);
+
+        generation = ++generation_;
+        task_ = &task;
+        task_count_ = count;
+        next_task_ = 0;
+        pending_tasks_ = count;
+    }
+
+    work_event_.notify_all();
+    runTasks(generation);
+
+    std::unique_lock lock(lock_);
+    done_event_.wait(lock, [this]() { return pending_tasks_ == 0; });
+    task_ = nullptr;
+}
+
+void Differ::WorkerPool::threadMain()
+{
+    uint64_t generation = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock lock(lock_);
+            work_event_.wait(lock, [&]() { return stopping_ || generation_ != generation; });
+
+            if (stopping_)
+                return;
+
+            generation = generation_;
+        }
+
+        runTasks(generation);
+    }
+}
+
+void Differ::WorkerPool::runTasks(uint64_t generation)
+{
+    std::unique_lock lock(lock_);
+
+    while (generation_ == generation && next_task_ < task_count_)
+    {
+        const int index = next_task_++;
+        const std::function<void(int)>& task = *task_;
+
+        lock.unlock();
+        task(index);
+        lock.lock();
+
+        if (--pending_tasks_ == 0)
+            done_event_.notify_one();
+    }
+}
 
-Differ::Differ(const Size& size)
+Differ::Differ(const Size& size, int block_size)
     : screen_rect_(Rect::makeSize(size)),
+      block_size_(block_size),
+      bytes_per_block_(block_size * kBytesPerPixel),
       bytes_per_row_(size.width() * kBytesPerPixel),
-      diff_width_(((size.width() + kBlockSize - 1) / kBlockSize) + 1),
-      diff_height_(((size.height() + kBlockSize - 1) / kBlockSize) + 1),
-      full_blocks_x_(size.width() / kBlockSize),
-      full_blocks_y_(size.height() / kBlockSize)
+      diff_width_(((size.width() + block_size - 1) / block_size) + 1),
+      diff_height_(((size.height() + block_size - 1) / block_size) + 1),
+      full_blocks_x_(size.width() / block_size),
+      full_blocks_y_(size.height() / block_size)
 {
     const int diff_info_size = diff_width_ * diff_height_;
 
@@ -73,55 +241,85 @@ Differ::Differ(const Size& size)
     memset(diff_info_.get(), 0, diff_info_size);
 
     // Calc size of partial blocks which may be present on right and bottom edge.
-    partial_column_width_ = size.width() - (full_blocks_x_ * kBlockSize);
-    partial_row_height_ = size.height() - (full_blocks_y_ * kBlockSize);
+    partial_column_width_ = size.width() - (full_blocks_x_ * block_size_);
+    partial_row_height_ = size.height() - (full_blocks_y_ * block_size_);
 
     // Offset from the start of one block-row to the next.
-    block_stride_y_ = bytes_per_row_ * kBlockSize;
+    block_stride_y_ = bytes_per_row_ * block_size_;
 
-    diff_full_block_func_ = diffFunction();
+    diff_full_block_func_ = diffFunction(block_size_);
     CHECK(diff_full_block_func_);
+
+    setThreadCount(defaultThreadCount(size));
 }
 
-// static
-Differ::DiffFullBlockFunc Differ::diffFunction()
+Differ::~Differ() = default;
+
+void Differ::setThreadCount(int thread_count)
 {
-    DiffFullBlockFunc func = nullptr;
+    thread_count = std::clamp(thread_count, 1, std::max(full_blocks_y_, 1));
 
-    if (libyuv::TestCpuFlag(libyuv::kCpuHasSSE2))
-    {
-        LOG(LS_INFO) << "SSE2 differ loaded";
+    if (thread_count == threadCount())
+        return;
 
-        if constexpr (kBlockSize == 16)
-            func = diffFullBlock_32bpp_16x16_SSE2;
-        else if constexpr (kBlockSize == 32)
-            func = diffFullBlock_32bpp_32x32_SSE2;
-    }
+    if (thread_count == 1)
+        worker_pool_.reset();
     else
+        worker_pool_ = std::make_unique<WorkerPool>(thread_count);
+}
+
+int Differ::threadCount() const
+{
+    return worker_pool_ ? worker_pool_->threadCount() : 1;
+}
+
+// static
+Differ::DiffFullBlockFunc Differ::diffFunction(int block_size)
+{
+    static const DiffFunctions functions = []()
     {
-        LOG(LS_INFO) << "C differ loaded";
+        DiffFunctions result = selectDiffFunctions();
+        LOG(LS_INFO) << result.name << " differ loaded";
+        return result;
+    }();
 
-        if constexpr (kBlockSize == 16)
-            func = diffFullBlock_32bpp_16x16_C;
-        else if constexpr (kBlockSize == 32)
-            func = diffFullBlock_32bpp_32x32_C;
+    switch (block_size)
+    {
+        case 16:
+            return functions.block_16x16;
+
+        case 32:
+            return functions.block_32x32;
+
+        default:
+            LOG(LS_ERROR) << "Unsupported block size: " << block_size;
+            return nullptr;
     }
+}
 
-    return func;
+// static
+int Differ::defaultThreadCount(const Size& size)
+{
+    const int64_t pixels = static_cast<int64_t>(size.width()) * size.height();
+    const int thread_count = static_cast<int>(std::min<int64_t>(
+        pixels / kPixelsPerThread, kMaxDefaultThreadCount));
+
+    return std::clamp(thread_count, 1, std::max(SysInfo::processorCores(), 1));
 }
 
 // Identify all of the blocks that contain changed pixels.
-void Differ::markDirtyBlocks(const uint8_t* prev_image, const uint8_t* curr_image)
+void Differ::markDirtyBlocks(const uint8_t* prev_image, const uint8_t* curr_image,
+                             int first_row, int last_row)
 {
-    const uint8_t* prev_block_row_start = prev_image;
-    const uint8_t* curr_block_row_start = curr_image;
+    const uint8_t* prev_block_row_start = prev_image + first_row * block_stride_y_;
+    const uint8_t* curr_block_row_start = curr_image + first_row * block_stride_y_;
 
     // Offset from the start of one diff_info row to the next.
     const int diff_stride = diff_width_;
 
-    uint8_t* is_diff_row_start = diff_info_.get();
+    uint8_t* is_diff_row_start = diff_info_.get() + first_row * diff_stride;
 
-    for (int y = 0; y < full_blocks_y_; ++y)
+    for (int y = first_row; y < last_row; ++y)
     {
         const uint8_t* prev_block = prev_block_row_start;
         const uint8_t* curr_block = curr_block_row_start;
@@ -134,8 +332,8 @@ void Differ::markDirtyBlocks(const uint8_t* prev_image, const uint8_t* curr_imag
             // incorporated into a dirty rect.
             *is_different = diff_full_block_func_(prev_block, curr_block, bytes_per_row_);
 
-            prev_block += kBytesPerBlock;
-            curr_block += kBytesPerBlock;
+            prev_block += bytes_per_block_;
+            curr_block += bytes_per_block_;
 
             ++is_different;
         }
@@ -147,8 +345,8 @@ void Differ::markDirtyBlocks(const uint8_t* prev_image, const uint8_t* curr_imag
             *is_different = diffPartialBlock(prev_block,
                                              curr_block,
                                              bytes_per_row_,
-                                             kBytesPerBlock,
-                                             kBlockSize);
+                                             partial_column_width_ * kBytesPerPixel,
+                                             block_size_);
         }
 
         // Update pointers for next row.
@@ -161,7 +359,7 @@ void Differ::markDirtyBlocks(const uint8_t* prev_image, const uint8_t* curr_imag
     // If the screen height is not a multiple of the block size, then this
     // handles the last partial row. This situation is far more common than
     // the 'partial column' case.
-    if (partial_row_height_ != 0)
+    if (last_row == full_blocks_y_ && partial_row_height_ != 0)
     {
         const uint8_t* prev_block = prev_block_row_start;
         const uint8_t* curr_block = curr_block_row_start;
@@ -173,11 +371,11 @@ void Differ::markDirtyBlocks(const uint8_t* prev_image, const uint8_t* curr_imag
             *is_different = diffPartialBlock(prev_block,
                                              curr_block,
                                              bytes_per_row_,
-                                             kBytesPerBlock,
+                                             bytes_per_block_,
                                              partial_row_height_);
 
-            prev_block += kBytesPerBlock;
-            curr_block += kBytesPerBlock;
+            prev_block += bytes_per_block_;
+            curr_block += bytes_per_block_;
             ++is_different;
         }
 
@@ -193,6 +391,24 @@ void Differ::markDirtyBlocks(const uint8_t* prev_image, const uint8_t* curr_imag
     }
 }
 
+uint8_t Differ::diffBlock(const uint8_t* prev_image, const uint8_t* curr_image, int x, int y) const
+{
+    const size_t offset = static_cast<size_t>(y) * static_cast<size_t>(block_stride_y_) +
+        static_cast<size_t>(x) * static_cast<size_t>(bytes_per_block_);
+
+    const int width = (x < full_blocks_x_) ? block_size_ : partial_column_width_;
+    const int height = (y < full_blocks_y_) ? block_size_ : partial_row_height_;
+
+    if (width == block_size_ && height == block_size_)
+        return diff_full_block_func_(prev_image + offset, curr_image + offset, bytes_per_row_);
+
+    return diffPartialBlock(prev_image + offset,
+                            curr_image + offset,
+                            bytes_per_row_,
+                            width * kBytesPerPixel,
+                            height);
+}
+
 //
 // After the dirty blocks have been identified, this routine merges adjacent
 // blocks into a region.
@@ -264,8 +480,8 @@ void Differ::mergeBlocks(Region* dirty_region)
                     }
                 } while (found_new_row);
 
-                Rect dirty_rect = Rect::makeXYWH(x * kBlockSize, y * kBlockSize,
-                                                 width * kBlockSize, height * kBlockSize);
+                Rect dirty_rect = Rect::makeXYWH(x * block_size_, y * block_size_,
+                                                 width * block_size_, height * block_size_);
 
                 dirty_rect.intersectWith(screen_rect_);
 
@@ -289,7 +505,23 @@ void Differ::calcDirtyRegion(const uint8_t* prev_image,
     dirty_region->clear();
 
     // Identify all the blocks that contain changed pixels.
-    markDirtyBlocks(prev_image, curr_image);
+    if (!worker_pool_)
+    {
+        markDirtyBlocks(prev_image, curr_image, 0, full_blocks_y_);
+    }
+    else
+    {
+        // Each band marks its own rows of |diff_info_|, so the bands do not overlap.
+        const int band_count =
+            std::min(worker_pool_->threadCount() * kBandsPerThread, full_blocks_y_);
+
+        worker_pool_->run(band_count, [&](int band)
+        {
+            markDirtyBlocks(prev_image, curr_image,
+                            full_blocks_y_ * band / band_count,
+                            full_blocks_y_ * (band + 1) / band_count);
+        });
+    }
 
     //
     // Now that we've identified the blocks that have changed, merge adjacent
@@ -298,4 +530,46 @@ void Differ::calcDirtyRegion(const uint8_t* prev_image,
     mergeBlocks(dirty_region);
 }
 
+void Differ::calcDirtyRegion(const uint8_t* prev_image,
+                             const uint8_t* curr_image,
+                             const Region& hint_region,
+                             Region* dirty_region)
+{
+    dirty_region->clear();
+
+    // Blocks that intersect the hint, in block coordinates. Rectangles of the region do not
+    // overlap, so each block is compared only once.
+    Region hint_blocks;
+
+    for (Region::Iterator it(hint_region); !it.isAtEnd(); it.advance())
+    {
+        Rect rect = it.rect();
+        rect.intersectWith(screen_rect_);
+
+        if (rect.isEmpty())
+            continue;
+
+        hint_blocks.addRect(Rect::makeLTRB(rect.left() / block_size_,
+                                           rect.top() / block_size_,
+                                           (rect.right() + block_size_ - 1) / block_size_,
+                                           (rect.bottom() + block_size_ - 1) / block_size_));
+    }
+
+    // The other blocks are already marked as unchanged: mergeBlocks() clears all marks.
+    for (Region::Iterator it(hint_blocks); !it.isAtEnd(); it.advance())
+    {
+        const Rect rect = it.rect();
+
+        for (int y = rect.top(); y < rect.bottom(); ++y)
+        {
+            uint8_t* is_different = diff_info_.get() + y * diff_width_;
+
+            for (int x = rect.left(); x < rect.right(); ++x)
+                is_different[x] = diffBlock(prev_image, curr_image, x, y);
+        }
+    }
+
+    mergeBlocks(dirty_region);
+}
+
 } // namespace base
@@ -30,22 +30,54 @@ namespace base {
 class Differ
 {
 public:
-    explicit Differ(const Size& size);
-    ~Differ() = default;
+    // Size of the blocks (in pixels) that are compared. A larger block is compared faster, but
+    // gives a less accurate region of changes. Supported sizes are 16 and 32.
+    static const int kDefaultBlockSize = 16;
+
+    explicit Differ(const Size& size, int block_size = kDefaultBlockSize);
+    ~Differ();
+
+    // Sets the number of threads that compare blocks, including the thread that calls
+    // calcDirtyRegion(). The frame is divided into horizontal bands which are compared
+    // concurrently, the result does not depend on the number of threads. By default the number is
+    // chosen according to the size of the frame and the number of processor cores.
+    void setThreadCount(int thread_count);
+    int threadCount() const;
 
     void calcDirtyRegion(const uint8_t* prev_image,
                          const uint8_t* curr_image,
                          Region* changed_region);
 
+    // Same as above, but compares only the blocks that intersect |hint_region|, the other blocks
+    // are considered unchanged. Used when the capturer knows approximately which areas of the
+    // screen could change (e.g. from the damage reported by the system). The result is the same
+    // as for the whole frame if all changes are inside |hint_region|.
+    void calcDirtyRegion(const uint8_t* prev_image,
+                         const uint8_t* curr_image,
+                         const Region& hint_region,
+                         Region* changed_region);
+
 private:
     typedef uint8_t(*DiffFullBlockFunc)(const uint8_t*, const uint8_t*, int);
 
-    static DiffFullBlockFunc diffFunction();
+    class WorkerPool;
+
+    static DiffFullBlockFunc diffFunction(int block_size);
+    static int defaultThreadCount(const Size& size);
 
-    void markDirtyBlocks(const uint8_t* prev_image, const uint8_t* curr_image);
+    // Compares block rows from |first_row| to |last_row| (not including). If |last_row| is the
+    // last full row, then the partial row below it is also compared.
+    void markDirtyBlocks(const uint8_t* prev_image, const uint8_t* curr_image,
+                         int first_row, int last_row);
     void mergeBlocks(Region* dirty_region);
 
+    // Compares the block at column |x| and row |y| (in blocks). The blocks at the right and bottom
+    // edges of the frame can be partial.
+    uint8_t diffBlock(const uint8_t* prev_image, const uint8_t* curr_image, int x, int y) const;
+
     const Rect screen_rect_;
+    const int block_size_;
+    const int bytes_per_block_;
     const int bytes_per_row_;
     const int diff_width_;
     const int diff_height_;
@@ -59,6 +91,10 @@ private:
     std::unique_ptr<uint8_t[]> diff_info_;
     DiffFullBlockFunc diff_full_block_func_;
 
+    // Threads which compare bands of the frame. Null if the blocks are compared only on the thread
+    // that calls calcDirtyRegion().
+    std::unique_ptr<WorkerPool> worker_pool_;
+
     DISALLOW_COPY_AND_ASSIGN(Differ);
 };
 
@@ -0,0 +1,391 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+
+// Benchmark of the functions that compare blocks of images and of the whole Differ. For the
+// functions the images are equal, so every block is compared completely, which is the worst case
+// for the differ. For the Differ a few pixels are changed, and the region of changes is checked to
+// be the same for any number of threads. The last table compares the whole frame with comparing
+// only the areas reported by the system (see Differ::calcDirtyRegion() with a hint) for a typical
+// office workload: a redrawn window, a line of typed text and a clock.
+//
+// Switches:
+//   --time=500         Duration of each run in milliseconds.
+//   --threads=1,2,4,8  Numbers of threads of the Differ.
+
+#include "base/command_line.h"
+#include "base/cpuid_util.h"
+#include "base/desktop/diff_block_32bpp_avx2.h"
+#include "base/desktop/diff_block_32bpp_avx512.h"
+#include "base/desktop/diff_block_32bpp_c.h"
+#include "base/desktop/diff_block_32bpp_neon.h"
+#include "base/desktop/diff_block_32bpp_sse2.h"
+#include "base/desktop/differ.h"
+#include "base/memory/aligned_memory.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_printf.h"
+#include "base/strings/string_split.h"
+#include "build/build_config.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace base {
+
+namespace {
+
+using AlignedBuffer = std::unique_ptr<uint8_t, AlignedFreeDeleter>;
+using Clock = std::chrono::steady_clock;
+using DiffFullBlockFunc = uint8_t(*)(const uint8_t*, const uint8_t*, int);
+
+const int kBytesPerPixel = 4;
+const int kAlignment = 64;
+
+struct Kernel
+{
+    const char* name;
+    int block_size;
+    DiffFullBlockFunc func;
+};
+
+std::vector<Kernel> supportedKernels()
+{
+    std::vector<Kernel> kernels;
+
+    kernels.push_back({ "C", 16, diffFullBlock_32bpp_16x16_C });
+    kernels.push_back({ "C", 32, diffFullBlock_32bpp_32x32_C });
+
+#if defined(ARCH_CPU_X86_FAMILY)
+    if (CpuidUtil::hasSse2())
+    {
+        kernels.push_back({ "SSE2", 16, diffFullBlock_32bpp_16x16_SSE2 });
+        kernels.push_back({ "SSE2", 32, diffFullBlock_32bpp_32x32_SSE2 });
+    }
+
+    if (CpuidUtil::hasAvx2())
+    {
+        kernels.push_back({ "AVX2", 16, diffFullBlock_32bpp_16x16_AVX2 });
+        kernels.push_back({ "AVX2", 32, diffFullBlock_32bpp_32x32_AVX2 });
+    }
+
+    if (CpuidUtil::hasAvx512())
+    {
+        kernels.push_back({ "AVX-512", 16, diffFullBlock_32bpp_16x16_AVX512 });
+        kernels.push_back({ "AVX-512", 32, diffFullBlock_32bpp_32x32_AVX512 });
+    }
+#elif defined(ARCH_CPU_ARM_FAMILY) && (defined(__ARM_NEON) || defined(CC_MSVC))
+    kernels.push_back({ "NEON", 16, diffFullBlock_32bpp_16x16_NEON });
+    kernels.push_back({ "NEON", 32, diffFullBlock_32bpp_32x32_NEON });
+#endif
+
+    return kernels;
+}
+
+class Frames
+{
+public:
+    explicit Frames(const Size& size)
+        : size_(size),
+          stride_(size.width() * kBytesPerPixel),
+          frame_size_(static_cast<size_t>(stride_) * static_cast<size_t>(size.height())),
+          prev_(static_cast<uint8_t*>(alignedAlloc(frame_size_, kAlignment))),
+          curr_(static_cast<uint8_t*>(alignedAlloc(frame_size_, kAlignment)))
+    {
+        for (size_t i = 0; i < frame_size_; ++i)
+            prev_.get()[i] = static_cast<uint8_t>(i * 7);
+
+        memcpy(curr_.get(), prev_.get(), frame_size_);
+    }
+
+    const Size& size() const { return size_; }
+    int stride() const { return stride_; }
+    size_t frameSize() const { return frame_size_; }
+    const uint8_t* prev() const { return prev_.get(); }
+    const uint8_t* curr() const { return curr_.get(); }
+
+    // Changes one pixel of the current image every |step| pixels.
+    void changePixels(size_t step)
+    {
+        for (size_t i = 0; i < frame_size_; i += step * kBytesPerPixel)
+            curr_.get()[i] ^= 0xFF;
+    }
+
+    // Changes all pixels of |rect| in the current image.
+    void changeRect(const Rect& rect)
+    {
+        for (int y = rect.top(); y < rect.bottom(); ++y)
+        {
+            uint8_t* row = curr_.get() + y * stride_ + rect.left() * kBytesPerPixel;
+
+            for (int x = 0; x < rect.width() * kBytesPerPixel; ++x)
+                row[x] ^= 0xFF;
+        }
+    }
+
+private:
+    const Size size_;
+    const int stride_;
+    const size_t frame_size_;
+    AlignedBuffer prev_;
+    AlignedBuffer curr_;
+};
+
+// Calls |func| until |duration| expires and returns the average time of one call in seconds.
+template <typename Function>
+double measure(const std::chrono::milliseconds& duration, Function func)
+{
+    // Warm up caches and let the processor raise the frequency.
+    func();
+
+    const Clock::time_point start_time = Clock::now();
+    Clock::time_point end_time;
+    int64_t count = 0;
+
+    do
+    {
+        func();
+        ++count;
+        end_time = Clock::now();
+    }
+    while (end_time - start_time < duration);
+
+    return std::chrono::duration<double>(end_time - start_time).count() /
+        static_cast<double>(count);
+}
+
+void runKernel(const Kernel& kernel, const Frames& frames, const std::chrono::milliseconds& duration)
+{
+    const int blocks_x = frames.size().width() / kernel.block_size;
+    const int blocks_y = frames.size().height() / kernel.block_size;
+    const int block_stride = frames.stride() * kernel.block_size;
+    const int bytes_per_block = kernel.block_size * kBytesPerPixel;
+
+    // Bytes of one image that are compared in one pass.
+    const double bytes = static_cast<double>(blocks_x) * blocks_y *
+        kernel.block_size * kernel.block_size * kBytesPerPixel;
+
+    volatile uint8_t result = 0;
+
+    double seconds = measure(duration, [&]()
+    {
+        uint8_t dirty = 0;
+
+        for (int y = 0; y < blocks_y; ++y)
+        {
+            const uint8_t* prev = frames.prev() + y * block_stride;
+            const uint8_t* curr = frames.curr() + y * block_stride;
+
+            for (int x = 0; x < blocks_x; ++x)
+            {
+                dirty |= kernel.func(prev, curr, frames.stride());
+
+                prev += bytes_per_block;
+                curr += bytes_per_block;
+            }
+        }
+
+        result = dirty;
+    });
+
+    std::string name = stringPrintf("%s/%dx%d/%dx%d", kernel.name,
+                                    kernel.block_size, kernel.block_size,
+                                    frames.size().width(), frames.size().height());
+
+    std::cout << stringPrintf("%-36s %10.3f %10.2f", name.c_str(), seconds * 1000.0,
+                              bytes / seconds / 1e9) << std::endl;
+}
+
+void runDifferWithHint(const Size& size, const std::chrono::milliseconds& duration)
+{
+    Frames frames(size);
+    Region hint_region;
+
+    const Rect changes[] =
+    {
+        // Redrawn window.
+        Rect::makeXYWH(600, 300, 640, 480),
+        // Typed text.
+        Rect::makeXYWH(100, 900, 400, 20),
+        // Clock.
+        Rect::makeXYWH(size.width() - 80, size.height() - 30, 60, 20)
+    };
+
+    for (const auto& rect : changes)
+    {
+        frames.changeRect(rect);
+
+        // The areas reported by the system are usually a bit larger than the changes.
+        Rect hint = rect;
+        hint.extend(4, 4, 4, 4);
+        hint_region.addRect(hint);
+    }
+
+    Differ differ(size, Differ::kDefaultBlockSize);
+    differ.setThreadCount(1);
+
+    Region full_region;
+    const double full_seconds = measure(duration, [&]()
+    {
+        differ.calcDirtyRegion(frames.prev(), frames.curr(), &full_region);
+    });
+
+    Region hint_dirty_region;
+    const double hint_seconds = measure(duration, [&]()
+    {
+        differ.calcDirtyRegion(frames.prev(), frames.curr(), hint_region, &hint_dirty_region);
+    });
+
+    int64_t hint_pixels = 0;
+    for (Region::Iterator it(hint_region); !it.isAtEnd(); it.advance())
+        hint_pixels += static_cast<int64_t>(it.rect().width()) * it.rect().height();
+
+    std::string name = stringPrintf("Differ/%dx%d/hint", size.width(), size.height());
+
+    std::cout << stringPrintf("%-36s %10.3f %10.3f %8.2f %8.1f %8s", name.c_str(),
+                              full_seconds * 1000.0, hint_seconds * 1000.0,
+                              full_seconds / hint_seconds,
+                              static_cast<double>(hint_pixels) * 100.0 /
+                                  (static_cast<double>(size.width()) * size.height()),
+                              hint_dirty_region.equals(full_region) ? "same" : "DIFFERS")
+              << std::endl;
+}
+
+// Returns the average time of calculation of the region of changes in seconds.
+double runDiffer(const Frames& frames, int block_size, int thread_count,
+                 const std::chrono::milliseconds& duration, Region* dirty_region)
+{
+    Differ differ(frames.size(), block_size);
+    differ.setThreadCount(thread_count);
+
+    return measure(duration, [&]()
+    {
+        differ.calcDirtyRegion(frames.prev(), frames.curr(), dirty_region);
+    });
+}
+
+} // namespace
+
+} // namespace base
+
+int main(int argc, const char* const* argv)
+{
+    base::CommandLine::init(argc, argv);
+    const base::CommandLine& command_line = *base::CommandLine::forCurrentProcess();
+
+    int time = 500;
+    if (command_line.hasSwitch(u"time"))
+    {
+        if (!base::stringToInt(command_line.switchValue(u"time"), &time) || time <= 0)
+        {
+            std::cout << "Invalid value of --time" << std::endl;
+            return 1;
+        }
+    }
+
+    const std::chrono::milliseconds duration(time);
+
+    std::cout << base::stringPrintf("%-36s %10s %10s", "Benchmark", "ms/frame", "GB/s")
+              << std::endl;
+
+    // Images of the small frame fit into the processor cache and show the speed of the functions
+    // themselves. For the large frame the speed is usually limited by the memory bandwidth.
+    for (const base::Size& size : { base::Size(256, 256), base::Size(3840, 2160) })
+    {
+        base::Frames frames(size);
+
+        for (const auto& kernel : base::supportedKernels())
+            base::runKernel(kernel, frames, duration);
+    }
+
+    std::vector<int> thread_counts;
+    if (command_line.hasSwitch(u"threads"))
+    {
+        for (const auto& item : base::splitString(command_line.switchValue(u"threads"), u",",
+                                                  base::TRIM_WHITESPACE,
+                                                  base::SPLIT_WANT_NONEMPTY))
+        {
+            int thread_count;
+            if (!base::stringToInt(item, &thread_count) || thread_count <= 0)
+            {
+                std::cout << "Invalid value of --threads" << std::endl;
+                return 1;
+            }
+
+            thread_counts.push_back(thread_count);
+        }
+    }
+    else
+    {
+        thread_counts = { 1, 2, 4, 8 };
+    }
+
+    std::cout << std::endl
+              << base::stringPrintf("%-36s %10s %10s %8s %8s",
+                                    "Benchmark", "ms/frame", "GB/s", "Speedup", "Output")
+              << std::endl;
+
+    for (const base::Size& size :
+         { base::Size(1920, 1080), base::Size(3840, 2160), base::Size(5120, 2880) })
+    {
+        base::Frames frames(size);
+
+        // About one of 150 blocks of 16x16 pixels is changed.
+        frames.changePixels(16 * 16 * 150 + 1);
+
+        for (int block_size : { 16, 32 })
+        {
+            // The result of one thread is the reference for the others.
+            base::Region serial_region;
+            const double serial_seconds =
+                base::runDiffer(frames, block_size, 1, duration, &serial_region);
+
+            for (int thread_count : thread_counts)
+            {
+                base::Region dirty_region;
+                const double seconds = thread_count == 1 ? serial_seconds :
+                    base::runDiffer(frames, block_size, thread_count, duration, &dirty_region);
+
+                if (thread_count == 1)
+                    dirty_region = serial_region;
+
+                std::string name = base::stringPrintf(
+                    "Differ/%dx%d/block:%d/threads:%d", size.width(), size.height(), block_size,
+                    thread_count);
+
+                std::cout << base::stringPrintf(
+                    "%-36s %10.3f %10.2f %8.2f %8s", name.c_str(), seconds * 1000.0,
+                    static_cast<double>(frames.frameSize()) / seconds / 1e9,
+                    serial_seconds / seconds,
+                    dirty_region.equals(serial_region) ? "same" : "DIFFERS") << std::endl;
+            }
+        }
+    }
+
+    std::cout << std::endl
+              << base::stringPrintf("%-36s %10s %10s %8s %8s %8s", "Benchmark", "Full ms",
+                                    "Hint ms", "Speedup", "Hint %", "Output")
+              << std::endl;
+
+    for (const base::Size& size : { base::Size(1920, 1080), base::Size(3840, 2160) })
+        base::runDifferWithHint(size, duration);
+
+    return 0;
+}
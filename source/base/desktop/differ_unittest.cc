@@ -0,0 +1,275 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+
+#include "base/desktop/differ.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <vector>
+
+namespace base {
+
+namespace {
+
+const int kBytesPerPixel = 4;
+
+class DifferTest
+{
+public:
+    DifferTest(const Size& size, int block_size)
+        : size_(size),
+          block_size_(block_size),
+          prev_(static_cast<size_t>(size.width() * size.height() * kBytesPerPixel)),
+          curr_(prev_.size())
+    {
+        for (size_t i = 0; i < prev_.size(); ++i)
+            prev_[i] = static_cast<uint8_t>(rand());
+
+        curr_ = prev_;
+    }
+
+    void changePixel(int x, int y)
+    {
+        curr_[static_cast<size_t>((y * size_.width() + x) * kBytesPerPixel)] += 1;
+
+        const Rect block = Rect::makeXYWH((x / block_size_) * block_size_,
+                                          (y / block_size_) * block_size_,
+                                          block_size_, block_size_);
+
+        changed_blocks_.push_back(block);
+        expected_.addRect(block);
+        expected_.intersectWith(Rect::makeSize(size_));
+    }
+
+    // Checks the result for |hint_region|. Only the changed blocks that intersect the hint are
+    // expected.
+    void checkWithHint(const Region& hint_region)
+    {
+        Region expected;
+
+        for (const auto& block : changed_blocks_)
+        {
+            Region intersection(block);
+            intersection.intersectWith(hint_region);
+
+            if (!intersection.isEmpty())
+                expected.addRect(block);
+        }
+
+        expected.intersectWith(Rect::makeSize(size_));
+
+        Differ differ(size_, block_size_);
+
+        for (int i = 0; i < 3; ++i)
+        {
+            Region dirty_region;
+            differ.calcDirtyRegion(prev_.data(), curr_.data(), hint_region, &dirty_region);
+            EXPECT_TRUE(dirty_region.equals(expected));
+
+            // The hint does not affect the comparison of the whole frame.
+            differ.calcDirtyRegion(prev_.data(), curr_.data(), &dirty_region);
+            EXPECT_TRUE(dirty_region.equals(expected_));
+        }
+    }
+
+    void check()
+    {
+        // The result does not depend on the number of threads.
+        for (int thread_count : { 1, 2, 3, 8 })
+        {
+            SCOPED_TRACE(thread_count);
+
+            Differ differ(size_, block_size_);
+            differ.setThreadCount(thread_count);
+
+            for (int i = 0; i < 3; ++i)
+            {
+                Region dirty_region;
+                differ.calcDirtyRegion(prev_.data(), curr_.data(), &dirty_region);
+                EXPECT_TRUE(dirty_region.equals(expected_));
+
+                // The same images do not have differences.
+                differ.calcDirtyRegion(curr_.data(), curr_.data(), &dirty_region);
+                EXPECT_TRUE(dirty_region.isEmpty());
+            }
+        }
+    }
+
+private:
+    const Size size_;
+    const int block_size_;
+    std::vector<uint8_t> prev_;
+    std::vector<uint8_t> curr_;
+    std::vector<Rect> changed_blocks_;
+    Region expected_;
+};
+
+} // namespace
+
+TEST(differ_test, thread_count)
+{
+    Differ differ(Size(640, 480), 16);
+
+    differ.setThreadCount(4);
+    EXPECT_EQ(differ.threadCount(), 4);
+
+    differ.setThreadCount(1);
+    EXPECT_EQ(differ.threadCount(), 1);
+
+    // There are not more threads than block rows.
+    Differ small_differ(Size(640, 40), 16);
+    small_differ.setThreadCount(8);
+    EXPECT_EQ(small_differ.threadCount(), 2);
+}
+
+TEST(differ_test, no_changes)
+{
+    for (int block_size : { 16, 32 })
+    {
+        DifferTest test(Size(640, 480), block_size);
+        test.check();
+    }
+}
+
+TEST(differ_test, single_pixel)
+{
+    for (int block_size : { 16, 32 })
+    {
+        DifferTest test(Size(640, 480), block_size);
+        test.changePixel(100, 200);
+        test.check();
+    }
+}
+
+TEST(differ_test, corners)
+{
+    for (int block_size : { 16, 32 })
+    {
+        DifferTest test(Size(640, 480), block_size);
+        test.changePixel(0, 0);
+        test.changePixel(639, 0);
+        test.changePixel(0, 479);
+        test.changePixel(639, 479);
+        test.check();
+    }
+}
+
+TEST(differ_test, partial_blocks)
+{
+    // The width and height are not multiples of the block size.
+    for (int block_size : { 16, 32 })
+    {
+        DifferTest test(Size(643, 487), block_size);
+        test.changePixel(642, 10);
+        test.changePixel(10, 486);
+        test.changePixel(642, 486);
+        test.changePixel(320, 240);
+        test.check();
+    }
+}
+
+TEST(differ_test, random_pixels)
+{
+    for (int block_size : { 16, 32 })
+    {
+        DifferTest test(Size(1021, 765), block_size);
+
+        for (int i = 0; i < 100; ++i)
+            test.changePixel(rand() % 1021, rand() % 765);
+
+        test.check();
+    }
+}
+
+TEST(differ_test, hint_covers_changes)
+{
+    for (int block_size : { 16, 32 })
+    {
+        DifferTest test(Size(1021, 765), block_size);
+        test.changePixel(100, 100);
+        test.changePixel(500, 300);
+        test.changePixel(1020, 764);
+
+        Region hint;
+        hint.addRect(Rect::makeXYWH(90, 95, 20, 10));
+        hint.addRect(Rect::makeXYWH(500, 300, 1, 1));
+        hint.addRect(Rect::makeXYWH(1000, 700, 100, 100));
+
+        test.checkWithHint(hint);
+    }
+}
+
+TEST(differ_test, hint_excludes_changes)
+{
+    for (int block_size : { 16, 32 })
+    {
+        DifferTest test(Size(640, 480), block_size);
+        test.changePixel(100, 100);
+        test.changePixel(600, 400);
+
+        // Only the first change is inside the hint.
+        test.checkWithHint(Region(Rect::makeXYWH(64, 64, 64, 64)));
+
+        // Changes outside of the hint are not detected.
+        test.checkWithHint(Region(Rect::makeXYWH(300, 0, 100, 100)));
+
+        // The hint touches the block of the change with one pixel.
+        test.checkWithHint(Region(Rect::makeXYWH(0, 0, 97, 97)));
+    }
+}
+
+TEST(differ_test, hint_empty_and_full)
+{
+    for (int block_size : { 16, 32 })
+    {
+        DifferTest test(Size(643, 487), block_size);
+
+        for (int i = 0; i < 50; ++i)
+            test.changePixel(rand() % 643, rand() % 487);
+
+        test.checkWithHint(Region());
+        test.checkWithHint(Region(Rect::makeSize(Size(643, 487))));
+
+        // The hint is larger than the screen.
+        test.checkWithHint(Region(Rect::makeXYWH(-100, -100, 1000, 1000)));
+    }
+}
+
+TEST(differ_test, hint_random)
+{
+    for (int block_size : { 16, 32 })
+    {
+        DifferTest test(Size(1021, 765), block_size);
+
+        for (int i = 0; i < 200; ++i)
+            test.changePixel(rand() % 1021, rand() % 765);
+
+        Region hint;
+        for (int i = 0; i < 20; ++i)
+        {
+            hint.addRect(Rect::makeXYWH(rand() % 1021, rand() % 765,
+                                        rand() % 200 + 1, rand() % 200 + 1));
+        }
+
+        test.checkWithHint(hint);
+    }
+}
+
+} // namespace base
@@ -45,6 +45,10 @@ public:
     void copyPixelsFrom(const uint8_t* src_buffer, int src_stride, const Rect& dest_rect);
     void copyPixelsFrom(const Frame& src_frame, const Point& src_pos, const Rect& dest_rect);
 
+    // Copies the area of the size of |dest_rect| at |src_pos| of this frame to |dest_rect|. The
+    // areas may overlap.
+    void moveRect(const Point& src_pos, const Rect& dest_rect);
+
     const Region& constUpdatedRegion() const { return updated_region_; }
     Region* updatedRegion() { return &updated_region_; }
 
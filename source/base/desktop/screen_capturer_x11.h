@@ -16,13 +16,28 @@
 // along with this program. If not, see <https://www.gnu.org/licenses/>.
 //
 
+
 #ifndef BASE__DESKTOP__SCREEN_CAPTURER_X11_H
 #define BASE__DESKTOP__SCREEN_CAPTURER_X11_H
 
 #include "base/desktop/screen_capturer.h"
 
+// Xlib.h defines macros that conflict with other headers, so it is included only by the source.
+// The identifiers of the X server resources are declared as in the X11 headers.
+typedef struct _XDisplay Display;
+typedef unsigned long XID;
+typedef XID Window;
+typedef XID Damage;
+typedef XID XserverRegion;
+
 namespace base {
 
+class Differ;
+
+// Captures the screen of the X server specified by the DISPLAY environment variable. The pixels
+// are read with the MIT-SHM extension directly into the frames if it is available. The XDamage
+// extension reports the areas that could change, so only these areas are compared with the
+// previous frame. The screens are the monitors reported by the XRandR extension.
 class ScreenCapturerX11 : public ScreenCapturer
 {
 public:
@@ -39,7 +54,64 @@ protected:
     // ScreenCapturer implementation.
     void reset() override;
 
+    // Reads |rect| of the selected screen into the same area of |frame|. The rectangle is in the
+    // coordinates of the frame. When the shared memory is used, the whole frame is read. Called
+    // after the damage is fetched.
+    virtual bool readImage(Frame* frame, const Rect& rect);
+
 private:
+    struct Monitor
+    {
+        Screen screen;
+        Rect rect;
+    };
+
+    // XWindowAttributes of the root window.
+    struct RootAttributes;
+
+    bool init();
+    void initDamage();
+    void initRandR();
+    void updateMonitors();
+    void processPendingEvents();
+    Rect screenRect(ScreenId screen_id) const;
+
+    // Reads and clears the region damaged since the previous call. The region is in the
+    // coordinates of the selected screen.
+    void fetchDamage(Region* damage_region);
+
+    std::unique_ptr<Frame> createFrame(const Size& size);
+    const Frame* captureImage();
+
+    Display* display_ = nullptr;
+    Window root_window_ = 0;
+    std::unique_ptr<RootAttributes> root_attributes_;
+    Point dpi_;
+
+    // True if the frames are filled by the X server through the shared memory.
+    bool use_shm_ = false;
+
+    bool use_damage_ = false;
+    int damage_event_base_ = 0;
+    Damage damage_handle_ = 0;
+    XserverRegion damage_region_ = 0;
+
+    bool use_randr_ = false;
+    int randr_event_base_ = 0;
+    std::vector<Monitor> monitors_;
+
+    ScreenId current_screen_id_ = kFullDesktopScreenId;
+
+    // Area of the selected screen in the coordinates of the root window.
+    Rect screen_rect_;
+
+    FrameQueue<Frame> queue_;
+    std::unique_ptr<Differ> differ_;
+
+    // The changes of the previous frame. They are missing in the current frame of the queue if
+    // the frame is not filled completely.
+    Region last_updated_region_;
+
     DISALLOW_COPY_AND_ASSIGN(ScreenCapturerX11);
 };
 
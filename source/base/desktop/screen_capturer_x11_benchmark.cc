@@ -0,0 +1,256 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+
+// Benchmark of ScreenCapturerX11. Measures the latency of captureFrame() and the processor time
+// spent by the process for each frame. The X server is specified by the DISPLAY environment
+// variable, the resolution is the resolution of the server. For example:
+//
+//   Xvfb :99 -screen 0 1920x1080x24 &
+//   DISPLAY=:99 aspia_screen_capturer_x11_benchmark
+//
+//   Xvfb :99 -screen 0 3840x2160x24 &
+//   DISPLAY=:99 aspia_screen_capturer_x11_benchmark
+//
+// The changes of the screen are drawn by a separate connection to the server before each frame.
+// The time of drawing is not included in the results.
+//
+// Switches:
+//   --frames=200  Number of frames captured for each workload.
+
+#include "base/command_line.h"
+#include "base/desktop/frame.h"
+#include "base/desktop/screen_capturer_x11.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_printf.h"
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+
+#include <sys/resource.h>
+
+#include <X11/Xlib.h>
+
+namespace base {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Returns the processor time (user and system) of the process in seconds.
+double processorTime()
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+
+    auto seconds = [](const struct timeval& time)
+    {
+        return static_cast<double>(time.tv_sec) + static_cast<double>(time.tv_usec) / 1e6;
+    };
+
+    return seconds(usage.ru_utime) + seconds(usage.ru_stime);
+}
+
+class Painter
+{
+public:
+    Painter()
+        : display_(XOpenDisplay(nullptr))
+    {
+        if (!display_)
+            return;
+
+        root_window_ = DefaultRootWindow(display_);
+        gc_ = XCreateGC(display_, root_window_, 0, nullptr);
+
+        const int screen = DefaultScreen(display_);
+        size_ = Size(DisplayWidth(display_, screen), DisplayHeight(display_, screen));
+    }
+
+    ~Painter()
+    {
+        if (!display_)
+            return;
+
+        XFreeGC(display_, gc_);
+        XCloseDisplay(display_);
+    }
+
+    bool isValid() const { return display_ != nullptr; }
+    const Size& size() const { return size_; }
+
+    void fillRect(const Rect& rect, unsigned long color)
+    {
+        XSetForeground(display_, gc_, color);
+        XFillRectangle(display_, root_window_, gc_, rect.x(), rect.y(), rect.width(),
+                       rect.height());
+    }
+
+    // Waits until the server draws everything.
+    void sync() { XSync(display_, False); }
+
+private:
+    Display* display_;
+    Window root_window_ = 0;
+    GC gc_ = nullptr;
+    Size size_;
+
+    DISALLOW_COPY_AND_ASSIGN(Painter);
+};
+
+struct Workload
+{
+    const char* name;
+
+    // Draws the changes of frame |index|.
+    std::function<void(Painter* painter, int index)> draw;
+};
+
+void runWorkload(ScreenCapturerX11* capturer, Painter* painter, const Workload& workload,
+                 int frame_count)
+{
+    ScreenCapturer::Error error;
+
+    // The first frame is always captured completely.
+    if (!capturer->captureFrame(&error))
+    {
+        std::cout << "Failed to capture frame" << std::endl;
+        return;
+    }
+
+    Clock::duration capture_time = Clock::duration::zero();
+    Clock::duration max_capture_time = Clock::duration::zero();
+    double processor_time = 0;
+    int64_t updated_pixels = 0;
+
+    for (int i = 0; i < frame_count; ++i)
+    {
+        workload.draw(painter, i);
+        painter->sync();
+
+        const double processor_start_time = processorTime();
+        const Clock::time_point start_time = Clock::now();
+
+        const Frame* frame = capturer->captureFrame(&error);
+
+        const Clock::duration time = Clock::now() - start_time;
+        processor_time += processorTime() - processor_start_time;
+
+        if (!frame)
+        {
+            std::cout << "Failed to capture frame" << std::endl;
+            return;
+        }
+
+        capture_time += time;
+        if (time > max_capture_time)
+            max_capture_time = time;
+
+        for (Region::Iterator it(frame->constUpdatedRegion()); !it.isAtEnd(); it.advance())
+            updated_pixels += static_cast<int64_t>(it.rect().width()) * it.rect().height();
+    }
+
+    const Size& size = painter->size();
+    const double total_pixels = static_cast<double>(size.width()) * size.height() * frame_count;
+
+    std::string name = stringPrintf("%dx%d/%s", size.width(), size.height(), workload.name);
+
+    std::cout << stringPrintf(
+        "%-32s %10.3f %10.3f %10.3f %10.2f", name.c_str(),
+        std::chrono::duration<double, std::milli>(capture_time).count() / frame_count,
+        std::chrono::duration<double, std::milli>(max_capture_time).count(),
+        processor_time * 1000.0 / frame_count,
+        static_cast<double>(updated_pixels) * 100.0 / total_pixels) << std::endl;
+}
+
+} // namespace
+
+} // namespace base
+
+int main(int argc, const char* const* argv)
+{
+    base::CommandLine::init(argc, argv);
+    const base::CommandLine& command_line = *base::CommandLine::forCurrentProcess();
+
+    int frame_count = 200;
+    if (command_line.hasSwitch(u"frames"))
+    {
+        if (!base::stringToInt(command_line.switchValue(u"frames"), &frame_count) ||
+            frame_count <= 0)
+        {
+            std::cout << "Invalid value of --frames" << std::endl;
+            return 1;
+        }
+    }
+
+    base::Painter painter;
+    if (!painter.isValid())
+    {
+        std::cout << "Unable to open display" << std::endl;
+        return 1;
+    }
+
+    const base::Size size = painter.size();
+
+    const base::Workload workloads[] =
+    {
+        // Nothing is changed.
+        { "idle", [](base::Painter* /* painter */, int /* index */) {} },
+
+        // A clock and a blinking caret.
+        { "clock", [size](base::Painter* painter, int index)
+            {
+                painter->fillRect(
+                    base::Rect::makeXYWH(size.width() - 80, size.height() - 30, 60, 20),
+                    index & 1 ? 0x202020 : 0xE0E0E0);
+                painter->fillRect(base::Rect::makeXYWH(200, 300, 2, 16),
+                                  index & 1 ? 0x000000 : 0xFFFFFF);
+            }
+        },
+
+        // A window of 640x480 is redrawn.
+        { "window", [](base::Painter* painter, int index)
+            {
+                painter->fillRect(base::Rect::makeXYWH(400, 200, 640, 480),
+                                  static_cast<unsigned long>(index * 0x030507) & 0xFFFFFF);
+            }
+        },
+
+        // The whole screen is changed, e.g. a video is played in full screen.
+        { "fullscreen", [size](base::Painter* painter, int index)
+            {
+                painter->fillRect(base::Rect::makeSize(size),
+                                  static_cast<unsigned long>(index * 0x070503) & 0xFFFFFF);
+            }
+        }
+    };
+
+    std::cout << base::stringPrintf("%-32s %10s %10s %10s %10s", "Benchmark", "ms/frame",
+                                    "max ms", "CPU ms", "Updated %") << std::endl;
+
+    for (const auto& workload : workloads)
+    {
+        // Each workload starts with a new capturer, so the results do not depend on the order.
+        base::ScreenCapturerX11 capturer;
+        base::runWorkload(&capturer, &painter, workload, frame_count);
+    }
+
+    return 0;
+}
@@ -0,0 +1,235 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+
+// Xlib.h defines macros like None and Status, so gtest is included before it.
+#include <gtest/gtest.h>
+
+#include "base/desktop/cursor_capturer_x11.h"
+#include "base/desktop/frame.h"
+#include "base/desktop/mouse_cursor.h"
+#include "base/desktop/screen_capturer_x11.h"
+
+#include <X11/Xlib.h>
+
+#include <functional>
+
+namespace base {
+
+namespace {
+
+// The tests need an X server, e.g. "Xvfb :99 -screen 0 1920x1080x24" with DISPLAY=:99. They are
+// skipped if the display cannot be opened.
+class ScreenCapturerX11Test : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        display_ = XOpenDisplay(nullptr);
+        if (!display_)
+            GTEST_SKIP() << "X server is not available";
+
+        root_window_ = DefaultRootWindow(display_);
+        gc_ = XCreateGC(display_, root_window_, 0, nullptr);
+    }
+
+    void TearDown() override
+    {
+        if (!display_)
+            return;
+
+        XFreeGC(display_, gc_);
+        XCloseDisplay(display_);
+    }
+
+    // Fills |rect| of the root window with |color| (0xRRGGBB) and waits for the server to draw it.
+    void fillRect(const Rect& rect, unsigned long color)
+    {
+        XSetForeground(display_, gc_, color);
+        XFillRectangle(display_, root_window_, gc_, rect.x(), rect.y(), rect.width(),
+                       rect.height());
+        XSync(display_, False);
+    }
+
+    Size rootSize() const
+    {
+        const int screen = DefaultScreen(display_);
+        return Size(DisplayWidth(display_, screen), DisplayHeight(display_, screen));
+    }
+
+    Display* display_ = nullptr;
+    Window root_window_ = 0;
+    GC gc_ = nullptr;
+};
+
+// Draws on the screen after the damage is fetched and before the screen is read.
+class LateDrawingCapturer : public ScreenCapturerX11
+{
+public:
+    using DrawCallback = std::function<void()>;
+
+    void drawOnNextRead(DrawCallback callback) { callback_ = std::move(callback); }
+
+protected:
+    bool readImage(Frame* frame, const Rect& rect) override
+    {
+        if (callback_)
+        {
+            callback_();
+            callback_ = nullptr;
+        }
+
+        return ScreenCapturerX11::readImage(frame, rect);
+    }
+
+private:
+    DrawCallback callback_;
+};
+
+uint32_t pixelAt(const Frame& frame, const Point& pos)
+{
+    const uint8_t* pixel = frame.frameDataAtPos(pos);
+
+    // The pixels are B, G, R, X in memory.
+    return (static_cast<uint32_t>(pixel[2]) << 16) |
+           (static_cast<uint32_t>(pixel[1]) << 8) |
+           static_cast<uint32_t>(pixel[0]);
+}
+
+} // namespace
+
+TEST_F(ScreenCapturerX11Test, ScreenList)
+{
+    ScreenCapturerX11 capturer;
+
+    ScreenCapturer::ScreenList screens;
+    ASSERT_TRUE(capturer.screenList(&screens));
+    ASSERT_FALSE(screens.empty());
+    EXPECT_EQ(capturer.screenCount(), static_cast<int>(screens.size()));
+
+    for (const auto& screen : screens)
+        EXPECT_TRUE(capturer.selectScreen(screen.id));
+
+    EXPECT_TRUE(capturer.selectScreen(ScreenCapturer::kFullDesktopScreenId));
+    EXPECT_FALSE(capturer.selectScreen(ScreenCapturer::kInvalidScreenId));
+}
+
+TEST_F(ScreenCapturerX11Test, FirstFrame)
+{
+    ScreenCapturerX11 capturer;
+    ScreenCapturer::Error error;
+
+    const Frame* frame = capturer.captureFrame(&error);
+    ASSERT_EQ(error, ScreenCapturer::Error::SUCCEEDED);
+    ASSERT_NE(frame, nullptr);
+
+    EXPECT_EQ(frame->size(), rootSize());
+
+    // The first frame is updated completely.
+    Region expected_region(Rect::makeSize(frame->size()));
+    EXPECT_TRUE(frame->constUpdatedRegion().equals(expected_region));
+}
+
+TEST_F(ScreenCapturerX11Test, UpdatedRegion)
+{
+    ScreenCapturerX11 capturer;
+    ScreenCapturer::Error error;
+
+    const Rect rect = Rect::makeXYWH(96, 64, 64, 32);
+    fillRect(rect, 0x000000);
+
+    ASSERT_NE(capturer.captureFrame(&error), nullptr);
+
+    fillRect(rect, 0xFF8000);
+
+    const Frame* frame = capturer.captureFrame(&error);
+    ASSERT_NE(frame, nullptr);
+    EXPECT_EQ(pixelAt(*frame, Point(100, 70)), 0xFF8000u);
+    EXPECT_EQ(pixelAt(*frame, Point(159, 95)), 0xFF8000u);
+
+    // The region is aligned to the blocks of the differ, so it can be larger than the rectangle.
+    Region changed_region(rect);
+    changed_region.subtract(frame->constUpdatedRegion());
+    EXPECT_TRUE(changed_region.isEmpty());
+
+    Region unchanged_region(frame->constUpdatedRegion());
+    unchanged_region.intersectWith(Rect::makeXYWH(256, 256, 16, 16));
+    EXPECT_TRUE(unchanged_region.isEmpty());
+
+    // Nothing is changed. The frame of the queue that was captured two frames ago must get the
+    // changes of the previous frame.
+    frame = capturer.captureFrame(&error);
+    ASSERT_NE(frame, nullptr);
+    EXPECT_TRUE(frame->constUpdatedRegion().isEmpty());
+    EXPECT_EQ(pixelAt(*frame, Point(100, 70)), 0xFF8000u);
+
+    fillRect(Rect::makeXYWH(128, 80, 8, 8), 0x0000FF);
+
+    frame = capturer.captureFrame(&error);
+    ASSERT_NE(frame, nullptr);
+    EXPECT_EQ(pixelAt(*frame, Point(130, 82)), 0x0000FFu);
+    EXPECT_EQ(pixelAt(*frame, Point(100, 70)), 0xFF8000u);
+    EXPECT_FALSE(frame->constUpdatedRegion().isEmpty());
+}
+
+TEST_F(ScreenCapturerX11Test, ChangedWhileCaptured)
+{
+    LateDrawingCapturer capturer;
+    ScreenCapturer::Error error;
+
+    const Rect rect = Rect::makeXYWH(300, 200, 40, 40);
+    fillRect(rect, 0x000000);
+
+    ASSERT_NE(capturer.captureFrame(&error), nullptr);
+    ASSERT_NE(capturer.captureFrame(&error), nullptr);
+
+    // The change is not in the damage fetched for this frame, but can already be in its pixels.
+    // Another area is damaged, so the screen is read even if only the damaged areas are read.
+    fillRect(Rect::makeXYWH(20, 20, 8, 8), 0x123456);
+    capturer.drawOnNextRead([this, rect]() { fillRect(rect, 0x00FF00); });
+
+    const Frame* frame = capturer.captureFrame(&error);
+    ASSERT_NE(frame, nullptr);
+    Region updated_region(frame->constUpdatedRegion());
+
+    // Whichever frame contains the change, it must be in the updated region of one of them.
+    frame = capturer.captureFrame(&error);
+    ASSERT_NE(frame, nullptr);
+    EXPECT_EQ(pixelAt(*frame, Point(310, 210)), 0x00FF00u);
+    updated_region.addRegion(frame->constUpdatedRegion());
+
+    Region changed_region(rect);
+    changed_region.subtract(updated_region);
+    EXPECT_TRUE(changed_region.isEmpty());
+}
+
+TEST_F(ScreenCapturerX11Test, Cursor)
+{
+    CursorCapturerX11 capturer;
+
+    const MouseCursor* cursor = capturer.captureCursor();
+    ASSERT_NE(cursor, nullptr);
+    EXPECT_FALSE(cursor->size().isEmpty());
+    EXPECT_EQ(cursor->constImage().size(),
+              static_cast<size_t>(cursor->width() * cursor->height()) * sizeof(uint32_t));
+
+    // The cursor is not changed.
+    EXPECT_EQ(capturer.captureCursor(), nullptr);
+}
+
+} // namespace base
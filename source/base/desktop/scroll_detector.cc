@@ -0,0 +1,333 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+
+#include "base/desktop/scroll_detector.h"
+
+#include "base/logging.h"
+#include "base/desktop/frame_simple.h"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+
+namespace base {
+
+namespace {
+
+// Moved areas are searched only in the updated rectangles which are not smaller than this size.
+const int kMinRectSize = 64;
+
+// Minimum number of rows (or columns) of a moved area.
+const int kMinMoveLength = 32;
+
+// Minimum number of changed rows (or columns) which have the same offset. Rows that occur more
+// than once in the previous frame (e.g. empty lines of text) are not counted.
+const int kMinVotes = 16;
+
+// Columns are hashed only in this number of rows, evenly spaced in the rectangle. The found
+// areas are compared completely anyway.
+const int kColumnHashRows = 64;
+
+const size_t kMaxMovedRects = 4;
+const int kBytesPerPixel = 4;
+
+const uint64_t kHashOffset = 14695981039346656037ULL;
+const uint64_t kHashPrime = 1099511628211ULL;
+
+uint64_t step(uint64_t hash, uint64_t value)
+{
+    return (hash ^ value) * kHashPrime;
+}
+
+uint64_t mix(uint64_t hash, uint64_t value)
+{
+    hash = step(hash, value);
+    return hash ^ (hash >> 32);
+}
+
+uint64_t hashRow(const uint8_t* data, int width)
+{
+    const size_t size = static_cast<size_t>(width) * kBytesPerPixel;
+
+    // Four independent hashes are calculated, so that the multiplications do not wait for each
+    // other.
+    uint64_t lanes[4] = { kHashOffset, kHashOffset + 1, kHashOffset + 2, kHashOffset + 3 };
+    size_t offset = 0;
+
+    for (; offset + sizeof(lanes) <= size; offset += sizeof(lanes))
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            uint64_t value;
+            memcpy(&value, data + offset + i * sizeof(value), sizeof(value));
+            lanes[i] = step(lanes[i], value);
+        }
+    }
+
+    uint64_t hash = mix(mix(mix(lanes[0], lanes[1]), lanes[2]), lanes[3]);
+
+    for (; offset < size; offset += kBytesPerPixel)
+    {
+        uint32_t value;
+        memcpy(&value, data + offset, sizeof(value));
+        hash = mix(hash, value);
+    }
+
+    return hash;
+}
+
+void hashRows(const Frame& frame, const Rect& rect, std::vector<uint64_t>* hashes)
+{
+    hashes->resize(rect.height());
+
+    for (int y = 0; y < rect.height(); ++y)
+        (*hashes)[y] = hashRow(frame.frameDataAtPos(rect.left(), rect.top() + y), rect.width());
+}
+
+void hashColumns(const Frame& frame, const Rect& rect, std::vector<uint64_t>* hashes)
+{
+    hashes->assign(rect.width(), kHashOffset);
+
+    const int rows = std::min(rect.height(), kColumnHashRows);
+
+    for (int i = 0; i < rows; ++i)
+    {
+        const int y = rect.top() + i * rect.height() / rows;
+        const uint8_t* row = frame.frameDataAtPos(rect.left(), y);
+
+        for (int x = 0; x < rect.width(); ++x)
+        {
+            uint32_t value;
+            memcpy(&value, row + x * kBytesPerPixel, sizeof(value));
+            (*hashes)[x] = step((*hashes)[x], value);
+        }
+    }
+
+    for (auto& hash : *hashes)
+        hash ^= hash >> 32;
+}
+
+struct Shift
+{
+    // Offset of the elements in the current frame relative to the previous frame.
+    int offset;
+
+    // The first element and the number of elements in the current frame.
+    int start;
+    int length;
+};
+
+// Finds the offset with which most of the changed elements of |curr| are found in |prev| and the
+// longest run of elements that are equal with this offset.
+bool findShift(const std::vector<uint64_t>& prev, const std::vector<uint64_t>& curr, Shift* shift)
+{
+    DCHECK_EQ(prev.size(), curr.size());
+
+    const int count = static_cast<int>(curr.size());
+
+    // Position of each element of the previous frame or -1 if the element is not unique.
+    std::unordered_map<uint64_t, int> positions;
+    positions.reserve(count);
+
+    for (int i = 0; i < count; ++i)
+    {
+        auto result = positions.emplace(prev[i], i);
+        if (!result.second)
+            result.first->second = -1;
+    }
+
+    std::vector<int> votes(count * 2, 0);
+    int best_offset = 0;
+    int best_votes = 0;
+
+    for (int i = 0; i < count; ++i)
+    {
+        if (curr[i] == prev[i])
+            continue;
+
+        auto it = positions.find(curr[i]);
+        if (it == positions.end() || it->second == -1)
+            continue;
+
+        const int offset = i - it->second;
+
+        int& offset_votes = votes[offset + count];
+        if (++offset_votes > best_votes)
+        {
+            best_votes = offset_votes;
+            best_offset = offset;
+        }
+    }
+
+    if (best_votes < kMinVotes)
+        return false;
+
+    const int first = std::max(0, best_offset);
+    const int last = std::min(count, count + best_offset);
+
+    int run_start = first;
+    int run_length = 0;
+
+    shift->offset = best_offset;
+    shift->start = first;
+    shift->length = 0;
+
+    for (int i = first; i < last; ++i)
+    {
+        if (curr[i] != prev[i - best_offset])
+        {
+            run_length = 0;
+            continue;
+        }
+
+        if (!run_length)
+            run_start = i;
+
+        if (++run_length > shift->length)
+        {
+            shift->start = run_start;
+            shift->length = run_length;
+        }
+    }
+
+    return shift->length >= kMinMoveLength;
+}
+
+} // namespace
+
+ScrollDetector::ScrollDetector() = default;
+
+ScrollDetector::~ScrollDetector() = default;
+
+void ScrollDetector::detect(const Frame& frame,
+                            std::vector<MovedRect>* moved_rects,
+                            Region* updated_region)
+{
+    DCHECK(moved_rects);
+    DCHECK(updated_region);
+
+    moved_rects->clear();
+    *updated_region = frame.constUpdatedRegion();
+
+    // The row hashes of the previous call are valid only until the previous frame is updated
+    // again.
+    const Rect hashed_rect = hashed_rect_;
+    hashed_rect_ = Rect();
+
+    if (!prev_frame_ || prev_frame_->size() != frame.size() ||
+        prev_frame_->format() != frame.format())
+    {
+        prev_frame_ = FrameSimple::create(frame.size(), frame.format());
+        prev_frame_->copyPixelsFrom(frame, Point(0, 0), Rect::makeSize(frame.size()));
+        return;
+    }
+
+    if (frame.format().bytesPerPixel() == kBytesPerPixel)
+    {
+        for (Region::Iterator it(frame.constUpdatedRegion()); !it.isAtEnd(); it.advance())
+        {
+            const Rect& rect = it.rect();
+
+            if (rect.width() < kMinRectSize || rect.height() < kMinRectSize)
+                continue;
+
+            MovedRect moved_rect;
+
+            if (findVerticalMove(frame, rect, rect.equals(hashed_rect), &moved_rect) ||
+                findHorizontalMove(frame, rect, &moved_rect))
+            {
+                moved_rects->push_back(moved_rect);
+                updated_region->subtract(moved_rect.dest_rect);
+
+                if (moved_rects->size() == kMaxMovedRects)
+                    break;
+            }
+        }
+    }
+
+    for (Region::Iterator it(frame.constUpdatedRegion()); !it.isAtEnd(); it.advance())
+        prev_frame_->copyPixelsFrom(frame, it.rect().topLeft(), it.rect());
+}
+
+void ScrollDetector::reset()
+{
+    prev_frame_.reset();
+    hashed_rect_ = Rect();
+}
+
+bool ScrollDetector::findVerticalMove(
+    const Frame& frame, const Rect& rect, bool is_hashed, MovedRect* moved_rect)
+{
+    // While a window is scrolled, the same rectangle is usually updated in each frame. Then the
+    // previous frame contains the rows that were hashed in the previous call.
+    if (is_hashed)
+        prev_row_hashes_.swap(curr_row_hashes_);
+    else
+        hashRows(*prev_frame_, rect, &prev_row_hashes_);
+
+    hashRows(frame, rect, &curr_row_hashes_);
+    hashed_rect_ = rect;
+
+    Shift shift;
+    if (!findShift(prev_row_hashes_, curr_row_hashes_, &shift))
+        return false;
+
+    moved_rect->dest_rect =
+        Rect::makeXYWH(rect.left(), rect.top() + shift.start, rect.width(), shift.length);
+    moved_rect->source_pos = Point(rect.left(), rect.top() + shift.start - shift.offset);
+
+    return isMoved(frame, *moved_rect);
+}
+
+bool ScrollDetector::findHorizontalMove(const Frame& frame, const Rect& rect, MovedRect* moved_rect)
+{
+    hashColumns(*prev_frame_, rect, &prev_column_hashes_);
+    hashColumns(frame, rect, &curr_column_hashes_);
+
+    Shift shift;
+    if (!findShift(prev_column_hashes_, curr_column_hashes_, &shift))
+        return false;
+
+    moved_rect->dest_rect =
+        Rect::makeXYWH(rect.left() + shift.start, rect.top(), shift.length, rect.height());
+    moved_rect->source_pos = Point(rect.left() + shift.start - shift.offset, rect.top());
+
+    return isMoved(frame, *moved_rect);
+}
+
+bool ScrollDetector::isMoved(const Frame& frame, const MovedRect& moved_rect) const
+{
+    // Hashes can match for different pixels, so the area is compared completely.
+    const Rect& dest_rect = moved_rect.dest_rect;
+    const size_t bytes_per_row = static_cast<size_t>(dest_rect.width()) * kBytesPerPixel;
+
+    for (int y = 0; y < dest_rect.height(); ++y)
+    {
+        const uint8_t* prev_row = prev_frame_->frameDataAtPos(
+            moved_rect.source_pos.x(), moved_rect.source_pos.y() + y);
+        const uint8_t* curr_row = frame.frameDataAtPos(dest_rect.x(), dest_rect.y() + y);
+
+        if (memcmp(prev_row, curr_row, bytes_per_row) != 0)
+            return false;
+    }
+
+    return true;
+}
+
+} // namespace base
@@ -0,0 +1,84 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+
+#ifndef BASE__DESKTOP__SCROLL_DETECTOR_H
+#define BASE__DESKTOP__SCROLL_DETECTOR_H
+
+#include "base/macros_magic.h"
+#include "base/desktop/region.h"
+
+#include <memory>
+#include <vector>
+
+namespace base {
+
+class Frame;
+
+// Class to search for areas of the screen that were moved since the previous frame (e.g. when a
+// window is scrolled or dragged). Instead of the pixels of such an area, it is enough to send the
+// position from which it was copied. The class keeps a copy of the previous frame, so the moves
+// are found relative to the image that the client already has.
+class ScrollDetector
+{
+public:
+    ScrollDetector();
+    ~ScrollDetector();
+
+    struct MovedRect
+    {
+        Rect dest_rect;
+        Point source_pos;
+    };
+
+    // Searches for moved areas inside the updated region of |frame|. Each area is searched only
+    // inside one rectangle of the region, so the areas do not affect each other. |updated_region|
+    // receives the updated region of |frame| without the found areas. Frames with 32 bits per
+    // pixel are supported, for other frames the moved areas are not searched.
+    void detect(const Frame& frame,
+                std::vector<MovedRect>* moved_rects,
+                Region* updated_region);
+
+    // Forgets the previous frame. Must be called if the client did not receive some of the frames
+    // passed to detect().
+    void reset();
+
+private:
+    // |is_hashed| is true if the rows of |rect| were hashed in the previous call.
+    bool findVerticalMove(
+        const Frame& frame, const Rect& rect, bool is_hashed, MovedRect* moved_rect);
+    bool findHorizontalMove(const Frame& frame, const Rect& rect, MovedRect* moved_rect);
+    bool isMoved(const Frame& frame, const MovedRect& moved_rect) const;
+
+    std::unique_ptr<Frame> prev_frame_;
+
+    // Hashes of rows and columns of the rectangle in the previous and the current frame.
+    std::vector<uint64_t> prev_row_hashes_;
+    std::vector<uint64_t> curr_row_hashes_;
+    std::vector<uint64_t> prev_column_hashes_;
+    std::vector<uint64_t> curr_column_hashes_;
+
+    // The rectangle for which |curr_row_hashes_| were calculated in the last call.
+    Rect hashed_rect_;
+
+    DISALLOW_COPY_AND_ASSIGN(ScrollDetector);
+};
+
+} // namespace base
+
+#endif // BASE__DESKTOP__SCROLL_DETECTOR_H
@@ -0,0 +1,259 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+
+#include "base/desktop/scroll_detector.h"
+
+#include "base/desktop/frame_simple.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <cstring>
+
+namespace base {
+
+namespace {
+
+const Size kFrameSize(640, 480);
+
+std::unique_ptr<FrameSimple> createFrame(const Size& size = kFrameSize)
+{
+    std::unique_ptr<FrameSimple> frame = FrameSimple::create(size, PixelFormat::ARGB());
+
+    uint8_t* data = frame->frameData();
+    const size_t data_size = static_cast<size_t>(frame->stride()) * size.height();
+
+    for (size_t i = 0; i < data_size; ++i)
+        data[i] = static_cast<uint8_t>(rand());
+
+    frame->updatedRegion()->setRect(Rect::makeSize(size));
+    return frame;
+}
+
+std::unique_ptr<FrameSimple> copyFrame(const Frame& frame)
+{
+    std::unique_ptr<FrameSimple> copy = FrameSimple::create(frame.size(), frame.format());
+    copy->copyPixelsFrom(frame, Point(0, 0), Rect::makeSize(frame.size()));
+    return copy;
+}
+
+void fillRect(Frame* frame, const Rect& rect)
+{
+    for (int y = rect.top(); y < rect.bottom(); ++y)
+    {
+        uint8_t* row = frame->frameDataAtPos(rect.left(), y);
+
+        for (int i = 0; i < rect.width() * frame->format().bytesPerPixel(); ++i)
+            row[i] = static_cast<uint8_t>(rand());
+    }
+}
+
+bool isEqual(const Frame& frame1, const Frame& frame2)
+{
+    const size_t bytes_per_row =
+        static_cast<size_t>(frame1.size().width()) * frame1.format().bytesPerPixel();
+
+    for (int y = 0; y < frame1.size().height(); ++y)
+    {
+        if (memcmp(frame1.frameDataAtPos(0, y), frame2.frameDataAtPos(0, y), bytes_per_row) != 0)
+            return false;
+    }
+
+    return true;
+}
+
+// Creates the frame which the client gets from |client_frame| after the moved areas and the
+// remaining updated region of |frame| are applied.
+void applyUpdate(const Frame& frame,
+                 const std::vector<ScrollDetector::MovedRect>& moved_rects,
+                 const Region& updated_region,
+                 Frame* client_frame)
+{
+    for (const auto& moved_rect : moved_rects)
+        client_frame->moveRect(moved_rect.source_pos, moved_rect.dest_rect);
+
+    for (Region::Iterator it(updated_region); !it.isAtEnd(); it.advance())
+        client_frame->copyPixelsFrom(frame, it.rect().topLeft(), it.rect());
+}
+
+class ScrollDetectorTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        frame_ = createFrame();
+        client_frame_ = copyFrame(*frame_);
+
+        detector_.detect(*frame_, &moved_rects_, &updated_region_);
+        EXPECT_TRUE(moved_rects_.empty());
+        EXPECT_TRUE(updated_region_.equals(frame_->constUpdatedRegion()));
+    }
+
+    // Moves the area |rect| of the frame by |dx|, |dy| inside |rect|. The uncovered part of |rect|
+    // gets new content.
+    void scroll(const Rect& rect, int dx, int dy)
+    {
+        Rect dest_rect = Rect::makeXYWH(rect.left() + std::max(dx, 0),
+                                        rect.top() + std::max(dy, 0),
+                                        rect.width() - abs(dx),
+                                        rect.height() - abs(dy));
+
+        frame_->moveRect(Point(dest_rect.left() - dx, dest_rect.top() - dy), dest_rect);
+
+        Region uncovered(rect);
+        uncovered.subtract(dest_rect);
+
+        for (Region::Iterator it(uncovered); !it.isAtEnd(); it.advance())
+            fillRect(frame_.get(), it.rect());
+
+        frame_->updatedRegion()->setRect(rect);
+    }
+
+    void detectAndApply()
+    {
+        detector_.detect(*frame_, &moved_rects_, &updated_region_);
+        applyUpdate(*frame_, moved_rects_, updated_region_, client_frame_.get());
+        EXPECT_TRUE(isEqual(*frame_, *client_frame_));
+    }
+
+    int updatedArea() const
+    {
+        int area = 0;
+
+        for (Region::Iterator it(updated_region_); !it.isAtEnd(); it.advance())
+            area += it.rect().width() * it.rect().height();
+
+        return area;
+    }
+
+    ScrollDetector detector_;
+    std::unique_ptr<FrameSimple> frame_;
+    std::unique_ptr<FrameSimple> client_frame_;
+    std::vector<ScrollDetector::MovedRect> moved_rects_;
+    Region updated_region_;
+};
+
+} // namespace
+
+TEST_F(ScrollDetectorTest, ScrollUp)
+{
+    const Rect rect = Rect::makeXYWH(100, 50, 400, 300);
+    scroll(rect, 0, -20);
+    detectAndApply();
+
+    ASSERT_EQ(moved_rects_.size(), 1u);
+    EXPECT_EQ(moved_rects_[0].dest_rect, Rect::makeXYWH(100, 50, 400, 280));
+    EXPECT_EQ(moved_rects_[0].source_pos, Point(100, 70));
+    EXPECT_EQ(updatedArea(), 400 * 20);
+}
+
+TEST_F(ScrollDetectorTest, ScrollDown)
+{
+    const Rect rect = Rect::makeXYWH(0, 0, 640, 480);
+    scroll(rect, 0, 100);
+    detectAndApply();
+
+    ASSERT_EQ(moved_rects_.size(), 1u);
+    EXPECT_EQ(moved_rects_[0].dest_rect, Rect::makeXYWH(0, 100, 640, 380));
+    EXPECT_EQ(moved_rects_[0].source_pos, Point(0, 0));
+    EXPECT_EQ(updatedArea(), 640 * 100);
+}
+
+TEST_F(ScrollDetectorTest, ScrollLeftAndRight)
+{
+    const Rect rect = Rect::makeXYWH(64, 64, 256, 128);
+
+    scroll(rect, -40, 0);
+    detectAndApply();
+
+    ASSERT_EQ(moved_rects_.size(), 1u);
+    EXPECT_EQ(moved_rects_[0].dest_rect, Rect::makeXYWH(64, 64, 216, 128));
+    EXPECT_EQ(moved_rects_[0].source_pos, Point(104, 64));
+
+    scroll(rect, 40, 0);
+    detectAndApply();
+
+    ASSERT_EQ(moved_rects_.size(), 1u);
+    EXPECT_EQ(moved_rects_[0].dest_rect, Rect::makeXYWH(104, 64, 216, 128));
+    EXPECT_EQ(moved_rects_[0].source_pos, Point(64, 64));
+}
+
+TEST_F(ScrollDetectorTest, SequenceOfScrolls)
+{
+    const Rect rect = Rect::makeXYWH(32, 16, 512, 400);
+
+    for (int i = 0; i < 10; ++i)
+    {
+        scroll(rect, 0, (i % 3) ? -(i * 5) : i * 7);
+        detectAndApply();
+    }
+}
+
+TEST_F(ScrollDetectorTest, NoMove)
+{
+    const Rect rect = Rect::makeXYWH(10, 10, 300, 200);
+
+    fillRect(frame_.get(), rect);
+    frame_->updatedRegion()->setRect(rect);
+    detectAndApply();
+
+    EXPECT_TRUE(moved_rects_.empty());
+    EXPECT_TRUE(updated_region_.equals(Region(rect)));
+}
+
+TEST_F(ScrollDetectorTest, SmallRect)
+{
+    const Rect rect = Rect::makeXYWH(10, 10, 600, 40);
+    scroll(rect, 0, -5);
+    detectAndApply();
+
+    EXPECT_TRUE(moved_rects_.empty());
+}
+
+TEST_F(ScrollDetectorTest, Reset)
+{
+    detector_.reset();
+
+    scroll(Rect::makeSize(kFrameSize), 0, -20);
+    detectAndApply();
+
+    EXPECT_TRUE(moved_rects_.empty());
+    EXPECT_TRUE(updated_region_.equals(frame_->constUpdatedRegion()));
+
+    scroll(Rect::makeSize(kFrameSize), 0, -20);
+    detectAndApply();
+
+    EXPECT_EQ(moved_rects_.size(), 1u);
+}
+
+TEST_F(ScrollDetectorTest, SizeChanged)
+{
+    frame_ = createFrame(Size(800, 600));
+    client_frame_ = copyFrame(*frame_);
+
+    detector_.detect(*frame_, &moved_rects_, &updated_region_);
+    EXPECT_TRUE(moved_rects_.empty());
+
+    scroll(Rect::makeSize(frame_->size()), 0, 30);
+    detectAndApply();
+
+    EXPECT_EQ(moved_rects_.size(), 1u);
+}
+
+} // namespace base
@@ -0,0 +1,140 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+
+#include "base/desktop/x11/shared_x_image.h"
+
+#include "base/logging.h"
+#include "base/desktop/x11/x_error_trap.h"
+
+#include <X11/Xutil.h>
+
+#include <sys/ipc.h>
+#include <sys/shm.h>
+
+namespace base {
+
+SharedXImage::SharedXImage(Display* display)
+    : display_(display)
+{
+    shm_segment_info_.shmseg = 0;
+    shm_segment_info_.shmid = -1;
+    shm_segment_info_.shmaddr = nullptr;
+    shm_segment_info_.readOnly = False;
+}
+
+SharedXImage::~SharedXImage()
+{
+    if (attached_)
+    {
+        XShmDetach(display_, &shm_segment_info_);
+        XSync(display_, False);
+    }
+
+    // The data of the image is the shared memory segment, it is not freed here.
+    if (image_)
+        XDestroyImage(image_);
+
+    if (shm_segment_info_.shmaddr)
+        shmdt(shm_segment_info_.shmaddr);
+}
+
+// static
+std::unique_ptr<SharedXImage> SharedXImage::create(
+    Display* display, const XWindowAttributes& attributes, const Size& size)
+{
+    if (!XShmQueryExtension(display))
+        return nullptr;
+
+    std::unique_ptr<SharedXImage> shared_image(new SharedXImage(display));
+    XShmSegmentInfo* shm_segment_info = &shared_image->shm_segment_info_;
+
+    shared_image->image_ = XShmCreateImage(display, attributes.visual, attributes.depth, ZPixmap,
+                                           nullptr, shm_segment_info,
+                                           size.width(), size.height());
+    if (!shared_image->image_)
+    {
+        LOG(LS_WARNING) << "XShmCreateImage failed";
+        return nullptr;
+    }
+
+    if (!isSupportedFormat(shared_image->image_))
+    {
+        LOG(LS_WARNING) << "Unsupported pixel format (bpp: "
+                        << shared_image->image_->bits_per_pixel << ")";
+        return nullptr;
+    }
+
+    shm_segment_info->shmid = shmget(
+        IPC_PRIVATE, shared_image->image_->bytes_per_line * shared_image->image_->height,
+        IPC_CREAT | 0600);
+    if (shm_segment_info->shmid == -1)
+    {
+        PLOG(LS_WARNING) << "shmget failed";
+        return nullptr;
+    }
+
+    void* address = shmat(shm_segment_info->shmid, nullptr, 0);
+
+    // The segment is destroyed when both the X server and this process detach from it.
+    shmctl(shm_segment_info->shmid, IPC_RMID, nullptr);
+
+    if (address == reinterpret_cast<void*>(-1))
+    {
+        PLOG(LS_WARNING) << "shmat failed";
+        return nullptr;
+    }
+
+    shm_segment_info->shmaddr = reinterpret_cast<char*>(address);
+    shared_image->image_->data = shm_segment_info->shmaddr;
+
+    // XShmAttach fails if the X server does not have access to the segment (e.g. the display is
+    // remote).
+    XErrorTrap error_trap(display);
+    shared_image->attached_ = XShmAttach(display, shm_segment_info);
+    if (error_trap.lastErrorAndDisable() != 0 || !shared_image->attached_)
+    {
+        LOG(LS_INFO) << "Unable to attach the shared memory segment";
+        shared_image->attached_ = false;
+        return nullptr;
+    }
+
+    return shared_image;
+}
+
+// static
+bool SharedXImage::isSupportedFormat(const XImage* image)
+{
+    return image->bits_per_pixel == 32 &&
+           image->byte_order == LSBFirst &&
+           image->red_mask == 0xFF0000 &&
+           image->green_mask == 0xFF00 &&
+           image->blue_mask == 0xFF;
+}
+
+bool SharedXImage::read(Drawable drawable, const Point& top_left)
+{
+    // The request fails if the area is outside the drawable, e.g. when the screen has just been
+    // resized.
+    XErrorTrap error_trap(display_);
+    const bool result =
+        XShmGetImage(display_, drawable, image_, top_left.x(), top_left.y(), AllPlanes);
+    return error_trap.lastErrorAndDisable() == 0 && result;
+}
+
+} // namespace base
@@ -0,0 +1,71 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+
+#ifndef BASE__DESKTOP__X11__SHARED_X_IMAGE_H
+#define BASE__DESKTOP__X11__SHARED_X_IMAGE_H
+
+#include "base/macros_magic.h"
+#include "base/desktop/geometry.h"
+#include "base/ipc/shared_memory.h"
+
+#include <X11/Xlib.h>
+#include <X11/extensions/XShm.h>
+
+namespace base {
+
+// Image in a shared memory segment of the MIT-SHM extension. The X server writes the pixels
+// directly to the segment, so a frame attached to it (see SharedMemoryFrame::attach) is filled
+// without copying. The object must be destroyed before the display is closed.
+class SharedXImage : public SharedMemoryBase
+{
+public:
+    ~SharedXImage();
+
+    // Creates an image of |size| for windows with |attributes|. Returns nullptr if the extension
+    // is not available (e.g. the display is remote) or the pixel format is not supported.
+    static std::unique_ptr<SharedXImage> create(
+        Display* display, const XWindowAttributes& attributes, const Size& size);
+
+    // Returns true if the pixels of |image| have the layout of PixelFormat::ARGB().
+    static bool isSupportedFormat(const XImage* image);
+
+    // Reads the area of the size of the image at |top_left| of |drawable|.
+    bool read(Drawable drawable, const Point& top_left);
+
+    int stride() const { return image_->bytes_per_line; }
+
+    // SharedMemoryBase implementation.
+    void* data() override { return shm_segment_info_.shmaddr; }
+    Handle handle() const override { return shm_segment_info_.shmid; }
+    int id() const override { return shm_segment_info_.shmid; }
+
+private:
+    explicit SharedXImage(Display* display);
+
+    Display* display_;
+    XImage* image_ = nullptr;
+    XShmSegmentInfo shm_segment_info_;
+    bool attached_ = false;
+
+    DISALLOW_COPY_AND_ASSIGN(SharedXImage);
+};
+
+} // namespace base
+
+#endif // BASE__DESKTOP__X11__SHARED_X_IMAGE_H
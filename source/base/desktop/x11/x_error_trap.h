@@ -0,0 +1,52 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+
+#ifndef BASE__DESKTOP__X11__X_ERROR_TRAP_H
+#define BASE__DESKTOP__X11__X_ERROR_TRAP_H
+
+#include "base/macros_magic.h"
+
+#include <X11/Xlib.h>
+
+namespace base {
+
+// Helper class that registers an X error handler for the lifetime of the object. By default an X
+// error terminates the process, with the trap the error code is saved instead. The handler is
+// global for the process, so the traps must be used from one thread and must not be nested.
+class XErrorTrap
+{
+public:
+    explicit XErrorTrap(Display* display);
+    ~XErrorTrap();
+
+    // Waits until the server processes the previous requests and returns the code of the last
+    // error or 0 if there were no errors. The handler is restored after the call.
+    int lastErrorAndDisable();
+
+private:
+    Display* display_;
+    XErrorHandler original_error_handler_;
+    bool enabled_ = true;
+
+    DISALLOW_COPY_AND_ASSIGN(XErrorTrap);
+};
+
+} // namespace base
+
+#endif // BASE__DESKTOP__X11__X_ERROR_TRAP_H
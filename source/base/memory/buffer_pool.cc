@@ -0,0 +1,75 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#include "base/memory/buffer_pool.h"
+
+namespace base {
+
+BufferPool::BufferPool(size_t max_cached_size)
+    : max_cached_size_(max_cached_size)
+{
+    // Nothing
+}
+
+BufferPool::~BufferPool() = default;
+
+ByteArray BufferPool::acquire(size_t size)
+{
+    {
+        std::scoped_lock lock(lock_);
+
+        auto it = buffers_.find(size);
+        if (it != buffers_.end() && !it->second.empty())
+        {
+            ByteArray buffer = std::move(it->second.back());
+            it->second.pop_back();
+
+            cached_size_ -= size;
+            return buffer;
+        }
+    }
+
+    return ByteArray(size);
+}
+
+void BufferPool::release(ByteArray&& buffer)
+{
+    const size_t size = buffer.size();
+    if (!size)
+        return;
+
+    std::scoped_lock lock(lock_);
+
+    if (cached_size_ + size > max_cached_size_)
+    {
+        // The buffer is freed when leaving the method.
+        ByteArray unused = std::move(buffer);
+        return;
+    }
+
+    buffers_[size].emplace_back(std::move(buffer));
+    cached_size_ += size;
+}
+
+size_t BufferPool::cachedSize() const
+{
+    std::scoped_lock lock(lock_);
+    return cached_size_;
+}
+
+} // namespace base
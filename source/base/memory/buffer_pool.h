@@ -0,0 +1,62 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef BASE__MEMORY__BUFFER_POOL_H
+#define BASE__MEMORY__BUFFER_POOL_H
+
+#include "base/macros_magic.h"
+#include "base/memory/byte_array.h"
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace base {
+
+// Pool of buffers that can be shared by many owners that need a buffer only from time to time.
+// Released buffers are kept for reuse (up to the specified total size) and are returned by
+// acquire() if their size matches exactly. The methods of the class are thread safe.
+class BufferPool
+{
+public:
+    // |max_cached_size| is the maximum total size of the buffers kept in the pool.
+    explicit BufferPool(size_t max_cached_size);
+    ~BufferPool();
+
+    // Returns a buffer of |size| bytes. The contents of the buffer are undefined.
+    ByteArray acquire(size_t size);
+
+    // Returns the buffer to the pool. If the pool is full, then the buffer is freed.
+    void release(ByteArray&& buffer);
+
+    // Total size of the buffers kept in the pool.
+    size_t cachedSize() const;
+
+private:
+    const size_t max_cached_size_;
+
+    mutable std::mutex lock_;
+    std::map<size_t, std::vector<ByteArray>> buffers_;
+    size_t cached_size_ = 0;
+
+    DISALLOW_COPY_AND_ASSIGN(BufferPool);
+};
+
+} // namespace base
+
+#endif // BASE__MEMORY__BUFFER_POOL_H
@@ -0,0 +1,75 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#include "base/memory/buffer_pool.h"
+
+#include <gtest/gtest.h>
+
+namespace base {
+
+TEST(BufferPoolTest, Reuse)
+{
+    BufferPool pool(64 * 1024);
+
+    ByteArray first = pool.acquire(8 * 1024);
+    EXPECT_EQ(first.size(), 8 * 1024);
+    EXPECT_EQ(pool.cachedSize(), 0);
+
+    const uint8_t* data = first.data();
+
+    pool.release(std::move(first));
+    EXPECT_EQ(pool.cachedSize(), 8 * 1024);
+
+    // A buffer of a different size is allocated.
+    ByteArray second = pool.acquire(16 * 1024);
+    EXPECT_EQ(second.size(), 16 * 1024);
+    EXPECT_EQ(pool.cachedSize(), 8 * 1024);
+
+    // A buffer of the same size is reused.
+    ByteArray third = pool.acquire(8 * 1024);
+    EXPECT_EQ(third.size(), 8 * 1024);
+    EXPECT_EQ(third.data(), data);
+    EXPECT_EQ(pool.cachedSize(), 0);
+
+    // Empty buffers are ignored.
+    pool.release(ByteArray());
+    EXPECT_EQ(pool.cachedSize(), 0);
+}
+
+TEST(BufferPoolTest, Limit)
+{
+    BufferPool pool(20 * 1024);
+
+    pool.release(ByteArray(8 * 1024));
+    pool.release(ByteArray(8 * 1024));
+    EXPECT_EQ(pool.cachedSize(), 16 * 1024);
+
+    // The buffer does not fit into the pool and is freed.
+    pool.release(ByteArray(8 * 1024));
+    EXPECT_EQ(pool.cachedSize(), 16 * 1024);
+
+    pool.release(ByteArray(4 * 1024));
+    EXPECT_EQ(pool.cachedSize(), 20 * 1024);
+
+    pool.acquire(8 * 1024);
+    pool.acquire(8 * 1024);
+    pool.acquire(4 * 1024);
+    EXPECT_EQ(pool.cachedSize(), 0);
+}
+
+} // namespace base
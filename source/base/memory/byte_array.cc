@@ -129,12 +129,30 @@ base::ByteArray serialize(const google::protobuf::MessageLite& message)
         return base::ByteArray();
 
     base::ByteArray buffer;
+    buffer.reserve(size + 1);
     buffer.resize(size);
 
     message.SerializeWithCachedSizesToArray(buffer.data());
     return buffer;
 }
 
+void serialize(const google::protobuf::MessageLite& message, base::ByteArray* buffer)
+{
+    DCHECK(buffer);
+
+    const size_t size = message.ByteSizeLong();
+
+    // The old contents are not needed, so they are not copied if the buffer grows.
+    buffer->clear();
+    buffer->reserve(size + 1);
+    buffer->resize(size);
+
+    if (buffer->empty())
+        return;
+
+    message.SerializeWithCachedSizesToArray(buffer->data());
+}
+
 int compare(const base::ByteArray& first, const base::ByteArray& second)
 {
     if (first.empty() && second.empty())
@@ -37,8 +37,14 @@ std::string toStdString(const ByteArray& in);
 ByteArray fromHex(std::string_view in);
 std::string toHex(const ByteArray& in);
 
+// Serializes the message. The capacity of the result is one byte more than the size, so
+// NetworkChannel can append the flag of the message without reallocation.
 base::ByteArray serialize(const google::protobuf::MessageLite& message);
 
+// Serializes the message into |buffer|. The memory of the buffer is reused if its capacity is
+// enough. One spare byte is reserved as above.
+void serialize(const google::protobuf::MessageLite& message, base::ByteArray* buffer);
+
 template <class T>
 bool parse(const base::ByteArray& buffer, T* message)
 {
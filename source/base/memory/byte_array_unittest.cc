@@ -17,6 +17,7 @@
 //
 
 #include "base/memory/byte_array.h"
+#include "proto/common.pb.h"
 
 #include <random>
 
@@ -124,4 +125,39 @@ TEST(ByteArray, HexConvert)
     }
 }
 
+TEST(ByteArray, Serialize)
+{
+    proto::Version version;
+    version.set_major(1);
+    version.set_minor(2);
+    version.set_patch(300);
+
+    ByteArray expected = serialize(version);
+
+    // A byte can be appended to the serialized message without reallocation.
+    EXPECT_GT(expected.capacity(), expected.size());
+
+    // The buffer keeps its memory when a smaller message is serialized into it.
+    ByteArray buffer(1024);
+    const uint8_t* data = buffer.data();
+
+    serialize(version, &buffer);
+    EXPECT_TRUE(equals(buffer, expected));
+    EXPECT_EQ(buffer.data(), data);
+
+    // The spare byte is also reserved when the buffer grows.
+    ByteArray small_buffer(2);
+    serialize(version, &small_buffer);
+    EXPECT_TRUE(equals(small_buffer, expected));
+    EXPECT_GT(small_buffer.capacity(), small_buffer.size());
+
+    proto::Version parsed;
+    EXPECT_TRUE(parse(buffer, &parsed));
+    EXPECT_EQ(parsed.patch(), 300);
+
+    // An empty message gives an empty buffer.
+    serialize(proto::Version(), &buffer);
+    EXPECT_TRUE(buffer.empty());
+}
+
 } // namespace base
@@ -0,0 +1,207 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#include "base/memory/ring_buffer.h"
+
+#include "base/logging.h"
+
+#include <cstring>
+
+namespace base {
+
+RingBuffer::RingBuffer(size_t capacity)
+    : buffer_(capacity)
+{
+    // Nothing
+}
+
+RingBuffer::RingBuffer(RingBuffer&& other) noexcept
+    : buffer_(std::move(other.buffer_)),
+      begin_(other.begin_),
+      size_(other.size_)
+{
+    other.begin_ = 0;
+    other.size_ = 0;
+}
+
+RingBuffer& RingBuffer::operator=(RingBuffer&& other) noexcept
+{
+    if (&other != this)
+    {
+        buffer_ = std::move(other.buffer_);
+        begin_ = other.begin_;
+        size_ = other.size_;
+
+        other.begin_ = 0;
+        other.size_ = 0;
+    }
+
+    return *this;
+}
+
+RingBuffer::~RingBuffer() = default;
+
+std::array<RingBuffer::Region, 2> RingBuffer::freeRegions()
+{
+    std::array<Region, 2> regions = { Region{ nullptr, 0 }, Region{ nullptr, 0 } };
+
+    if (isFull())
+        return regions;
+
+    const size_t end = (begin_ + size_) % capacity();
+
+    if (end >= begin_)
+    {
+        // The free space wraps around the end of the buffer.
+        regions[0] = { buffer_.data() + end, capacity() - end };
+        regions[1] = { buffer_.data(), begin_ };
+    }
+    else
+    {
+        regions[0] = { buffer_.data() + end, begin_ - end };
+    }
+
+    return regions;
+}
+
+std::array<RingBuffer::ConstRegion, 2> RingBuffer::dataRegions() const
+{
+    std::array<ConstRegion, 2> regions = { ConstRegion{ nullptr, 0 }, ConstRegion{ nullptr, 0 } };
+
+    if (isEmpty())
+        return regions;
+
+    const size_t tail = capacity() - begin_;
+
+    if (size_ <= tail)
+    {
+        regions[0] = { buffer_.data() + begin_, size_ };
+    }
+    else
+    {
+        // The data wraps around the end of the buffer.
+        regions[0] = { buffer_.data() + begin_, tail };
+        regions[1] = { buffer_.data(), size_ - tail };
+    }
+
+    return regions;
+}
+
+void RingBuffer::commit(size_t size)
+{
+    DCHECK_LE(size, freeSpace());
+    size_ += size;
+}
+
+void RingBuffer::consume(size_t size)
+{
+    DCHECK_LE(size, size_);
+
+    if (!size)
+        return;
+
+    // Only the beginning of the data moves. The rest of the data and the free space stay in place,
+    // so the regions returned before remain valid.
+    size_ -= size;
+    begin_ = (begin_ + size) % capacity();
+}
+
+size_t RingBuffer::write(const void* data, size_t size)
+{
+    const uint8_t* source = reinterpret_cast<const uint8_t*>(data);
+    size_t written = 0;
+
+    for (const Region& region : freeRegions())
+    {
+        size_t count = std::min(region.size, size - written);
+        if (!count)
+            break;
+
+        memcpy(region.data, source + written, count);
+        written += count;
+    }
+
+    commit(written);
+    return written;
+}
+
+size_t RingBuffer::peek(void* data, size_t size) const
+{
+    uint8_t* target = reinterpret_cast<uint8_t*>(data);
+    size_t copied = 0;
+
+    for (const ConstRegion& region : dataRegions())
+    {
+        size_t count = std::min(region.size, size - copied);
+        if (!count)
+            break;
+
+        memcpy(target + copied, region.data, count);
+        copied += count;
+    }
+
+    return copied;
+}
+
+size_t RingBuffer::read(void* data, size_t size)
+{
+    size_t copied = peek(data, size);
+    consume(copied);
+    return copied;
+}
+
+void RingBuffer::resize(size_t capacity)
+{
+    DCHECK_GE(capacity, size_);
+
+    if (capacity == this->capacity())
+        return;
+
+    ByteArray buffer(capacity);
+    peek(buffer.data(), size_);
+
+    buffer_ = std::move(buffer);
+    begin_ = 0;
+}
+
+void RingBuffer::clear()
+{
+    begin_ = 0;
+    size_ = 0;
+}
+
+void RingBuffer::assign(ByteArray&& buffer)
+{
+    DCHECK(isEmpty());
+
+    buffer_ = std::move(buffer);
+    begin_ = 0;
+}
+
+ByteArray RingBuffer::release()
+{
+    DCHECK(isEmpty());
+
+    ByteArray buffer;
+    buffer.swap(buffer_);
+
+    begin_ = 0;
+    return buffer;
+}
+
+} // namespace base
@@ -0,0 +1,110 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef BASE__MEMORY__RING_BUFFER_H
+#define BASE__MEMORY__RING_BUFFER_H
+
+#include "base/macros_magic.h"
+#include "base/memory/byte_array.h"
+
+#include <array>
+
+namespace base {
+
+// Circular byte buffer. Data is appended at the end and removed from the beginning. The buffer
+// allows you to fill in free space and consume stored data directly (for example, with
+// scatter/gather I/O) without intermediate copies.
+class RingBuffer
+{
+public:
+    struct Region
+    {
+        uint8_t* data;
+        size_t size;
+    };
+
+    struct ConstRegion
+    {
+        const uint8_t* data;
+        size_t size;
+    };
+
+    RingBuffer() = default;
+    explicit RingBuffer(size_t capacity);
+    RingBuffer(RingBuffer&& other) noexcept;
+    RingBuffer& operator=(RingBuffer&& other) noexcept;
+    ~RingBuffer();
+
+    size_t capacity() const { return buffer_.size(); }
+    size_t size() const { return size_; }
+    size_t freeSpace() const { return capacity() - size_; }
+
+    bool isEmpty() const { return size_ == 0; }
+    bool isFull() const { return size_ == capacity(); }
+
+    // Returns the free space of the buffer as up to two contiguous regions. If the free space is
+    // contiguous, then the second region is empty.
+    std::array<Region, 2> freeRegions();
+
+    // Returns the stored data as up to two contiguous regions in the order of their addition.
+    // If the data is contiguous, then the second region is empty.
+    std::array<ConstRegion, 2> dataRegions() const;
+
+    // Marks |size| bytes written to the free space as stored data.
+    void commit(size_t size);
+
+    // Removes |size| bytes from the beginning of the stored data.
+    void consume(size_t size);
+
+    // Copies data to the end of the buffer. Returns the number of bytes copied, which may be less
+    // than |size| if there is not enough free space.
+    size_t write(const void* data, size_t size);
+
+    // Copies data from the beginning of the buffer without removing it. Returns the number of
+    // bytes copied.
+    size_t peek(void* data, size_t size) const;
+
+    // Copies and removes data from the beginning of the buffer. Returns the number of bytes
+    // copied.
+    size_t read(void* data, size_t size);
+
+    // Changes the capacity of the buffer. The stored data is preserved, so |capacity| must not be
+    // less than size().
+    void resize(size_t capacity);
+
+    // Removes all stored data. The capacity does not change.
+    void clear();
+
+    // Replaces the storage of an empty buffer with |buffer|. The capacity becomes equal to the
+    // size of |buffer|.
+    void assign(ByteArray&& buffer);
+
+    // Takes the storage from an empty buffer. The capacity becomes zero.
+    ByteArray release();
+
+private:
+    ByteArray buffer_;
+    size_t begin_ = 0;
+    size_t size_ = 0;
+
+    DISALLOW_COPY_AND_ASSIGN(RingBuffer);
+};
+
+} // namespace base
+
+#endif // BASE__MEMORY__RING_BUFFER_H
@@ -0,0 +1,201 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#include "base/memory/ring_buffer.h"
+
+#include <random>
+
+#include <gtest/gtest.h>
+
+namespace base {
+
+TEST(RingBuffer, Empty)
+{
+    RingBuffer buffer;
+
+    EXPECT_EQ(buffer.capacity(), 0);
+    EXPECT_EQ(buffer.size(), 0);
+    EXPECT_TRUE(buffer.isEmpty());
+    EXPECT_TRUE(buffer.isFull());
+
+    uint8_t data[4] = { 1, 2, 3, 4 };
+    EXPECT_EQ(buffer.write(data, sizeof(data)), 0);
+    EXPECT_EQ(buffer.read(data, sizeof(data)), 0);
+
+    for (const auto& region : buffer.freeRegions())
+        EXPECT_EQ(region.size, 0);
+
+    for (const auto& region : buffer.dataRegions())
+        EXPECT_EQ(region.size, 0);
+}
+
+TEST(RingBuffer, WriteRead)
+{
+    RingBuffer buffer(8);
+
+    const uint8_t source[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+
+    EXPECT_EQ(buffer.write(source, 6), 6);
+    EXPECT_EQ(buffer.size(), 6);
+    EXPECT_EQ(buffer.freeSpace(), 2);
+
+    uint8_t target[10] = { 0 };
+    EXPECT_EQ(buffer.read(target, 4), 4);
+    EXPECT_EQ(memcmp(target, source, 4), 0);
+    EXPECT_EQ(buffer.size(), 2);
+
+    // The data wraps around the end of the buffer.
+    EXPECT_EQ(buffer.write(source + 6, 4), 4);
+    EXPECT_EQ(buffer.size(), 6);
+
+    std::array<RingBuffer::ConstRegion, 2> data_regions = buffer.dataRegions();
+    EXPECT_EQ(data_regions[0].size, 4);
+    EXPECT_EQ(data_regions[1].size, 2);
+
+    // Only 2 bytes of free space.
+    EXPECT_EQ(buffer.write(source, sizeof(source)), 2);
+    EXPECT_TRUE(buffer.isFull());
+
+    EXPECT_EQ(buffer.read(target, sizeof(target)), 8);
+    EXPECT_EQ(memcmp(target, source + 4, 6), 0);
+    EXPECT_EQ(memcmp(target + 6, source, 2), 0);
+    EXPECT_TRUE(buffer.isEmpty());
+}
+
+TEST(RingBuffer, CommitConsume)
+{
+    RingBuffer buffer(16);
+
+    std::array<RingBuffer::Region, 2> free_regions = buffer.freeRegions();
+    EXPECT_EQ(free_regions[0].size, 16);
+    EXPECT_EQ(free_regions[1].size, 0);
+
+    memset(free_regions[0].data, 0xAA, 10);
+    buffer.commit(10);
+    buffer.consume(6);
+
+    free_regions = buffer.freeRegions();
+    EXPECT_EQ(free_regions[0].size, 6);
+    EXPECT_EQ(free_regions[1].size, 6);
+
+    memset(free_regions[0].data, 0xBB, free_regions[0].size);
+    memset(free_regions[1].data, 0xCC, free_regions[1].size);
+    buffer.commit(free_regions[0].size + free_regions[1].size);
+    EXPECT_TRUE(buffer.isFull());
+
+    uint8_t target[16];
+    EXPECT_EQ(buffer.read(target, sizeof(target)), 16);
+
+    for (int i = 0; i < 4; ++i)
+        EXPECT_EQ(target[i], 0xAA);
+    for (int i = 4; i < 10; ++i)
+        EXPECT_EQ(target[i], 0xBB);
+    for (int i = 10; i < 16; ++i)
+        EXPECT_EQ(target[i], 0xCC);
+}
+
+TEST(RingBuffer, Resize)
+{
+    RingBuffer buffer(8);
+
+    const uint8_t source[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+
+    EXPECT_EQ(buffer.write(source, 6), 6);
+    buffer.consume(4);
+    EXPECT_EQ(buffer.write(source + 6, 2), 2);
+    EXPECT_EQ(buffer.write(source, 2), 2);
+
+    // Grow the buffer with the wrapped data.
+    buffer.resize(32);
+    EXPECT_EQ(buffer.capacity(), 32);
+    EXPECT_EQ(buffer.size(), 6);
+    EXPECT_EQ(buffer.freeSpace(), 26);
+
+    uint8_t target[6];
+    EXPECT_EQ(buffer.peek(target, sizeof(target)), 6);
+
+    const uint8_t expected[] = { 5, 6, 7, 8, 1, 2 };
+    EXPECT_EQ(memcmp(target, expected, sizeof(expected)), 0);
+
+    // Shrink the buffer to the size of the data.
+    buffer.resize(6);
+    EXPECT_TRUE(buffer.isFull());
+    EXPECT_EQ(buffer.read(target, sizeof(target)), 6);
+    EXPECT_EQ(memcmp(target, expected, sizeof(expected)), 0);
+
+    buffer.resize(0);
+    EXPECT_EQ(buffer.capacity(), 0);
+}
+
+TEST(RingBuffer, AssignRelease)
+{
+    RingBuffer buffer;
+    EXPECT_EQ(buffer.capacity(), 0);
+
+    buffer.assign(ByteArray(8));
+    EXPECT_EQ(buffer.capacity(), 8);
+    EXPECT_TRUE(buffer.isEmpty());
+
+    const uint8_t source[] = { 1, 2, 3, 4, 5, 6 };
+    uint8_t target[8];
+
+    EXPECT_EQ(buffer.write(source, sizeof(source)), 6);
+    EXPECT_EQ(buffer.read(target, 4), 4);
+    EXPECT_EQ(buffer.read(target, 4), 2);
+    EXPECT_TRUE(buffer.isEmpty());
+
+    ByteArray storage = buffer.release();
+    EXPECT_EQ(storage.size(), 8);
+    EXPECT_EQ(buffer.capacity(), 0);
+    EXPECT_TRUE(buffer.isEmpty());
+
+    // The buffer starts from the beginning of the new storage.
+    buffer.assign(std::move(storage));
+    EXPECT_EQ(buffer.write(source, sizeof(source)), 6);
+    EXPECT_EQ(buffer.dataRegions()[0].size, 6);
+    EXPECT_EQ(buffer.read(target, sizeof(target)), 6);
+    EXPECT_EQ(memcmp(target, source, sizeof(source)), 0);
+}
+
+TEST(RingBuffer, Stream)
+{
+    std::mt19937 engine(12345);
+    std::uniform_int_distribution<size_t> distance(1, 100);
+
+    RingBuffer buffer(64);
+
+    uint8_t next_write = 0;
+    uint8_t next_read = 0;
+
+    for (int i = 0; i < 10000; ++i)
+    {
+        uint8_t data[100];
+
+        size_t count = std::min(distance(engine), buffer.freeSpace());
+        for (size_t j = 0; j < count; ++j)
+            data[j] = next_write++;
+
+        EXPECT_EQ(buffer.write(data, count), count);
+
+        count = buffer.read(data, distance(engine));
+        for (size_t j = 0; j < count; ++j)
+            ASSERT_EQ(data[j], next_read++);
+    }
+}
+
+} // namespace base
@@ -0,0 +1,129 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#include "base/net/link_estimator.h"
+
+#include "base/logging.h"
+
+#include <algorithm>
+
+namespace base {
+
+LinkEstimator::LinkEstimator() = default;
+
+LinkEstimator::~LinkEstimator() = default;
+
+bool LinkEstimator::addSample(const Sample& sample)
+{
+    if (!has_samples_)
+    {
+        has_samples_ = true;
+
+        interval_time_ = sample.time;
+        interval_bytes_acked_ = sample.bytes_acked;
+        interval_app_limited_ = !sample.bytes_queued;
+
+        updateRtt(sample.time, sample.rtt);
+        return false;
+    }
+
+    DCHECK(sample.time >= interval_time_);
+
+    updateRtt(sample.time, sample.rtt);
+
+    const int64_t previous_rate = delivery_rate_;
+    updateRate(sample);
+
+    // Data waiting in the queue of the sender is sent at the delivery rate. Data in the queues of
+    // the path increases the round-trip time above the minimum.
+    queue_delay_ = std::max(rtt_ - min_rtt_, Microseconds::zero());
+    if (delivery_rate_)
+        queue_delay_ += Microseconds(sample.bytes_queued * 1000000 / delivery_rate_);
+
+    return delivery_rate_ != previous_rate;
+}
+
+void LinkEstimator::reset()
+{
+    *this = LinkEstimator();
+}
+
+void LinkEstimator::updateRtt(const TimePoint& time, const Microseconds& rtt)
+{
+    if (rtt <= Microseconds::zero())
+        return;
+
+    if (rtt_ == Microseconds::zero())
+    {
+        rtt_ = rtt;
+        rtt_variation_ = rtt / 2;
+    }
+    else
+    {
+        const Microseconds delta = rtt_ > rtt ? rtt_ - rtt : rtt - rtt_;
+
+        rtt_variation_ = (rtt_variation_ * 3 + delta) / 4;
+        rtt_ = (rtt_ * 7 + rtt) / 8;
+    }
+
+    // The minimum is forgotten after a while, because the route may change.
+    if (min_rtt_ == Microseconds::zero() || rtt <= min_rtt_ || time - min_rtt_time_ > kMinRttWindow)
+    {
+        min_rtt_ = rtt;
+        min_rtt_time_ = time;
+    }
+}
+
+void LinkEstimator::updateRate(const Sample& sample)
+{
+    if (sample.bytes_acked < interval_bytes_acked_)
+    {
+        // The counter of the TCP stack is not reliable (e.g. it was reset). Start a new interval.
+        interval_time_ = sample.time;
+        interval_bytes_acked_ = sample.bytes_acked;
+        interval_app_limited_ = !sample.bytes_queued;
+        return;
+    }
+
+    if (!sample.bytes_queued)
+        interval_app_limited_ = true;
+
+    const Microseconds elapsed =
+        std::chrono::duration_cast<Microseconds>(sample.time - interval_time_);
+    if (elapsed < kRateInterval)
+        return;
+
+    const int64_t rate =
+        (sample.bytes_acked - interval_bytes_acked_) * 1000000 / elapsed.count();
+
+    // If the sender did not have enough data, then the measured rate is less than the rate the
+    // path can deliver. Such a measurement can only increase the estimate.
+    if (!interval_app_limited_ || rate > delivery_rate_)
+    {
+        if (!delivery_rate_)
+            delivery_rate_ = rate;
+        else
+            delivery_rate_ = (delivery_rate_ * 3 + rate) / 4;
+    }
+
+    interval_time_ = sample.time;
+    interval_bytes_acked_ = sample.bytes_acked;
+    interval_app_limited_ = !sample.bytes_queued;
+}
+
+} // namespace base
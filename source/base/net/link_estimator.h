@@ -0,0 +1,103 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef BASE__NET__LINK_ESTIMATOR_H
+#define BASE__NET__LINK_ESTIMATOR_H
+
+#include <chrono>
+#include <cstdint>
+
+namespace base {
+
+// Estimates the state of the network path from periodic samples of the TCP connection: smoothed
+// round-trip time, the rate at which the peer acknowledges the data (delivery rate) and the time
+// that a new message waits before it reaches the peer (queue delay). The samples are taken by
+// NetworkChannel from the statistics of the TCP stack, so no additional packets are sent.
+class LinkEstimator
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimePoint = Clock::time_point;
+    using Microseconds = std::chrono::microseconds;
+
+    struct Sample
+    {
+        TimePoint time;
+
+        // Round-trip time measured by the TCP stack. Zero if unknown.
+        Microseconds rtt { 0 };
+
+        // Total number of bytes acknowledged by the peer.
+        int64_t bytes_acked = 0;
+
+        // Number of bytes accepted for sending but not yet sent to the network.
+        int64_t bytes_queued = 0;
+    };
+
+    LinkEstimator();
+    ~LinkEstimator();
+
+    // Adds a sample. The time of the samples must not decrease.
+    // Returns true if the delivery rate was updated.
+    bool addSample(const Sample& sample);
+
+    void reset();
+
+    // Smoothed round-trip time and its variation (RFC 6298). Zero if unknown.
+    Microseconds rtt() const { return rtt_; }
+    Microseconds rttVariation() const { return rtt_variation_; }
+
+    // Minimum round-trip time over the last kMinRttWindow. This is the round-trip time without
+    // queues on the path.
+    Microseconds minRtt() const { return min_rtt_; }
+
+    // Number of bytes per second acknowledged by the peer. Zero if unknown.
+    int64_t deliveryRate() const { return delivery_rate_; }
+
+    // The time for which the data queued at the sender and on the path delays a new message.
+    Microseconds queueDelay() const { return queue_delay_; }
+
+    static constexpr std::chrono::milliseconds kRateInterval { 200 };
+    static constexpr std::chrono::seconds kMinRttWindow { 10 };
+
+private:
+    void updateRtt(const TimePoint& time, const Microseconds& rtt);
+    void updateRate(const Sample& sample);
+
+    bool has_samples_ = false;
+
+    Microseconds rtt_ { 0 };
+    Microseconds rtt_variation_ { 0 };
+    Microseconds min_rtt_ { 0 };
+    TimePoint min_rtt_time_;
+
+    // Start of the current interval of the delivery rate measurement.
+    TimePoint interval_time_;
+    int64_t interval_bytes_acked_ = 0;
+
+    // True if the queue became empty during the interval. In this case the sender did not have
+    // enough data to fill the path and the measured rate is only the lower bound.
+    bool interval_app_limited_ = false;
+
+    int64_t delivery_rate_ = 0;
+    Microseconds queue_delay_ { 0 };
+};
+
+} // namespace base
+
+#endif // BASE__NET__LINK_ESTIMATOR_H
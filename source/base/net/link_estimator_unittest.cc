@@ -0,0 +1,159 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#include "base/net/link_estimator.h"
+
+#include <gtest/gtest.h>
+
+namespace base {
+
+namespace {
+
+using Microseconds = LinkEstimator::Microseconds;
+using Milliseconds = std::chrono::milliseconds;
+
+// Model of a path with a bottleneck link. The sender writes |send_rate| bytes per second, the link
+// delivers at most |link_rate| bytes per second and the excess is accumulated in the queue of the
+// sender.
+class Path
+{
+public:
+    Path(int64_t link_rate, const Milliseconds& base_rtt)
+        : link_rate_(link_rate),
+          base_rtt_(base_rtt)
+    {
+        // Nothing
+    }
+
+    void setLinkRate(int64_t link_rate) { link_rate_ = link_rate; }
+
+    LinkEstimator::Sample step(int64_t send_rate, const Milliseconds& duration)
+    {
+        queued_ += send_rate * duration.count() / 1000;
+
+        int64_t delivered = std::min(queued_, link_rate_ * duration.count() / 1000);
+        queued_ -= delivered;
+        acked_ += delivered;
+        time_ += duration;
+
+        LinkEstimator::Sample sample;
+        sample.time = time_;
+        sample.rtt = base_rtt_;
+        sample.bytes_acked = acked_;
+        sample.bytes_queued = queued_;
+        return sample;
+    }
+
+private:
+    int64_t link_rate_;
+    const Milliseconds base_rtt_;
+
+    LinkEstimator::TimePoint time_ = LinkEstimator::Clock::now();
+    int64_t acked_ = 0;
+    int64_t queued_ = 0;
+};
+
+} // namespace
+
+TEST(LinkEstimatorTest, Rtt)
+{
+    LinkEstimator estimator;
+    LinkEstimator::Sample sample;
+    sample.time = LinkEstimator::Clock::now();
+
+    EXPECT_EQ(estimator.rtt(), Microseconds::zero());
+
+    // Unknown round-trip time is ignored.
+    estimator.addSample(sample);
+    EXPECT_EQ(estimator.rtt(), Microseconds::zero());
+
+    sample.rtt = Milliseconds(40);
+    estimator.addSample(sample);
+    EXPECT_EQ(estimator.rtt(), Milliseconds(40));
+    EXPECT_EQ(estimator.rttVariation(), Milliseconds(20));
+    EXPECT_EQ(estimator.minRtt(), Milliseconds(40));
+
+    // The queue on the path increases the round-trip time, but not the minimum.
+    sample.rtt = Milliseconds(120);
+    for (int i = 0; i < 50; ++i)
+    {
+        sample.time += Milliseconds(100);
+        estimator.addSample(sample);
+    }
+
+    EXPECT_GT(estimator.rtt(), Milliseconds(115));
+    EXPECT_LE(estimator.rtt(), Milliseconds(120));
+    EXPECT_EQ(estimator.minRtt(), Milliseconds(40));
+    EXPECT_GT(estimator.queueDelay(), Milliseconds(75));
+
+    // The minimum is forgotten after the window.
+    sample.time += LinkEstimator::kMinRttWindow;
+    estimator.addSample(sample);
+    EXPECT_EQ(estimator.minRtt(), Milliseconds(120));
+    EXPECT_LT(estimator.queueDelay(), Milliseconds(5));
+}
+
+TEST(LinkEstimatorTest, DeliveryRate)
+{
+    static const int64_t kLinkRate = 1000000;
+
+    LinkEstimator estimator;
+    Path path(kLinkRate, Milliseconds(40));
+
+    // The sender writes more than the link can deliver.
+    for (int i = 0; i < 40; ++i)
+        estimator.addSample(path.step(kLinkRate * 2, Milliseconds(50)));
+
+    EXPECT_EQ(estimator.deliveryRate(), kLinkRate);
+
+    // Two seconds of sending at twice the rate leave two seconds of data in the queue.
+    EXPECT_GT(estimator.queueDelay(), Milliseconds(1950));
+    EXPECT_LT(estimator.queueDelay(), Milliseconds(2050));
+
+    // The link becomes slower.
+    path.setLinkRate(kLinkRate / 4);
+    for (int i = 0; i < 80; ++i)
+        estimator.addSample(path.step(kLinkRate, Milliseconds(50)));
+
+    EXPECT_GT(estimator.deliveryRate(), kLinkRate / 4 * 95 / 100);
+    EXPECT_LT(estimator.deliveryRate(), kLinkRate / 4 * 105 / 100);
+}
+
+TEST(LinkEstimatorTest, AppLimited)
+{
+    static const int64_t kLinkRate = 1000000;
+
+    LinkEstimator estimator;
+    Path path(kLinkRate, Milliseconds(40));
+
+    for (int i = 0; i < 40; ++i)
+        estimator.addSample(path.step(kLinkRate * 2, Milliseconds(50)));
+    EXPECT_EQ(estimator.deliveryRate(), kLinkRate);
+
+    // The queue is drained and then the sender writes less than the link can deliver. This does
+    // not decrease the estimate.
+    for (int i = 0; i < 40; ++i)
+        estimator.addSample(path.step(0, Milliseconds(50)));
+    for (int i = 0; i < 40; ++i)
+        estimator.addSample(path.step(kLinkRate / 10, Milliseconds(50)));
+
+    EXPECT_EQ(estimator.deliveryRate(), kLinkRate);
+    EXPECT_EQ(estimator.queueDelay(), Microseconds::zero());
+}
+
+} // namespace base
@@ -0,0 +1,417 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+
+#include "base/net/message_compressor.h"
+
+#include "base/logging.h"
+
+namespace base {
+
+namespace {
+
+// The fastest level. Higher levels give only a few percent for small messages.
+const int kCompressionLevel = 1;
+
+// The dictionary is trained with "zstd --train --maxdict=4096 --dictID=1" on serialized host and
+// relay lists, system information and file lists. When it is retrained, the ID must be changed,
+// so that peers with different dictionaries do not use compression with each other.
+const uint8_t kDictionary[] =
+{
+    0x37, 0xA4, 0x30, 0xEC, 0x01, 0x00, 0x00, 0x00, 0x44, 0x10, 0x10, 0xC4, 0xB2, 0x0E, 0x03, 0xC0,
+    0x00, 0x30, 0x00, 0x0C, 0x00, 0x03, 0xC0, 0x00, 0x30, 0x00, 0x36, 0x11, 0xC0, 0x38, 0xF7, 0xDD,
+    0x1F, 0x5C, 0xFA, 0x36, 0xE7, 0xFC, 0x08, 0x00, 0x10, 0x81, 0xEB, 0xBA, 0xAE, 0xEB, 0xBA, 0xAE,
+    0xEB, 0xBA, 0xB9, 0xCE, 0x17, 0x4B, 0x29, 0xA5, 0x4C, 0x32, 0x95, 0x22, 0x72, 0xE5, 0x53, 0x1E,
+    0x1E, 0xFE, 0x00, 0x3D, 0xEF, 0x3F, 0xD0, 0x97, 0xE0, 0xE7, 0x91, 0x0D, 0x02, 0xB3, 0x03, 0x00,
+    0x00, 0x04, 0x84, 0x06, 0xE5, 0xE2, 0x41, 0xB1, 0x5A, 0x00, 0x04, 0x40, 0x8D, 0x9B, 0xA1, 0x0B,
+    0x15, 0x47, 0xD2, 0x88, 0x30, 0xC9, 0x51, 0x18, 0x45, 0x51, 0xCA, 0x18, 0x84, 0x90, 0x01, 0x00,
+    0x88, 0x31, 0x22, 0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF4, 0x09, 0xCB, 0xE2, 0x82,
+    0xA9, 0x71, 0x40, 0x20, 0x1E, 0x1A, 0x49, 0x51, 0x50, 0x3A, 0x34, 0x20, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x0A, 0x09,
+    0x44, 0x65, 0x6C, 0x6C, 0x20, 0x49, 0x6E, 0x63, 0x2E, 0x12, 0x07, 0x48, 0x31, 0x31, 0x30, 0x4D,
+    0x2D, 0x4B, 0x22, 0x2C, 0x0A, 0x18, 0x41, 0x6D, 0x65, 0x72, 0x69, 0x63, 0x61, 0x6E, 0x20, 0x4D,
+    0x65, 0x67, 0x61, 0x74, 0x72, 0x65, 0x6E, 0x64, 0x73, 0x20, 0x49, 0x6E, 0x56, 0x09, 0x23, 0x50,
+    0x60, 0x5F, 0x00, 0x00, 0x00, 0x00, 0x11, 0x54, 0x0C, 0xBB, 0x1D, 0x00, 0x00, 0x00, 0x00, 0x1A,
+    0x0E, 0x31, 0x39, 0x32, 0x2E, 0x31, 0x35, 0x31, 0x2E, 0x32, 0x34, 0x2E, 0x31, 0x32, 0x33, 0x22,
+    0x06, 0x08, 0x02, 0x10, 0x05, 0x18, 0x03, 0x2A, 0x1E, 0x57, 0x69, 0x6E, 0x64, 0x6F, 0x00, 0x00,
+    0x00, 0x00, 0x1A, 0x0B, 0x39, 0x35, 0x2E, 0x39, 0x33, 0x2E, 0x38, 0x39, 0x2E, 0x36, 0x32, 0x22,
+    0x06, 0x08, 0x02, 0x10, 0x03, 0x18, 0x02, 0x2A, 0x0F, 0x57, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73,
+    0x20, 0x38, 0x2E, 0x31, 0x20, 0x50, 0x72, 0x6F, 0x32, 0x0E, 0x4C, 0x41, 0x50, 0x54, 0x4F, 0x50,
+    0x18, 0x93, 0xB0, 0x95, 0x9E, 0x06, 0x0A, 0x16, 0x0A, 0x0C, 0x24, 0x52, 0x65, 0x63, 0x79, 0x63,
+    0x6C, 0x65, 0x2E, 0x42, 0x69, 0x6E, 0x18, 0xAF, 0xAB, 0xD7, 0x90, 0x06, 0x20, 0x01, 0x0A, 0x19,
+    0x0A, 0x0B, 0x69, 0x6E, 0x76, 0x6F, 0x69, 0x63, 0x65, 0x2E, 0x6C, 0x6E, 0x6B, 0x10, 0x82, 0xB5,
+    0x98, 0xDA, 0x00, 0x00, 0x1A, 0x0E, 0x31, 0x30, 0x2E, 0x32, 0x31, 0x32, 0x2E, 0x31, 0x38, 0x38,
+    0x2E, 0x31, 0x31, 0x33, 0x22, 0x06, 0x08, 0x02, 0x10, 0x02, 0x18, 0x02, 0x2A, 0x0E, 0x57, 0x69,
+    0x6E, 0x64, 0x6F, 0x77, 0x73, 0x20, 0x31, 0x31, 0x20, 0x50, 0x72, 0x6F, 0x32, 0x0B, 0x4B, 0x41,
+    0x53, 0x53, 0x41, 0x2D, 0x32, 0x32, 0x35, 0x22, 0x04, 0x08, 0x02, 0x10, 0x06, 0x2A, 0x1C, 0x57,
+    0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x20, 0x53, 0x65, 0x72, 0x76, 0x65, 0x72, 0x20, 0x32, 0x30,
+    0x31, 0x39, 0x20, 0x53, 0x74, 0x61, 0x6E, 0x64, 0x61, 0x72, 0x64, 0x32, 0x0C, 0x44, 0x45, 0x53,
+    0x4B, 0x54, 0x4F, 0x50, 0x2D, 0x58, 0x74, 0x69, 0x63, 0x41, 0x4D, 0x44, 0x12, 0x27, 0x49, 0x6E,
+    0x74, 0x65, 0x6C, 0x28, 0x52, 0x29, 0x20, 0x50, 0x65, 0x6E, 0x74, 0x69, 0x75, 0x6D, 0x28, 0x52,
+    0x29, 0x20, 0x43, 0x50, 0x55, 0x20, 0x47, 0x34, 0x35, 0x36, 0x30, 0x20, 0x40, 0x20, 0x33, 0x2E,
+    0x35, 0x30, 0x47, 0x48, 0x7A, 0x18, 0x01, 0x20, 0x00, 0x1A, 0x0E, 0x31, 0x37, 0x32, 0x2E, 0x32,
+    0x33, 0x31, 0x2E, 0x31, 0x37, 0x35, 0x2E, 0x31, 0x36, 0x22, 0x06, 0x08, 0x02, 0x10, 0x02, 0x18,
+    0x03, 0x2A, 0x0E, 0x57, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x20, 0x31, 0x31, 0x20, 0x50, 0x72,
+    0x6F, 0x32, 0x0C, 0x4B, 0x41, 0x53, 0x53, 0x41, 0x2D, 0x4C, 0x8F, 0xAA, 0x83, 0x92, 0x06, 0x0A,
+    0x19, 0x0A, 0x0B, 0x44, 0x65, 0x73, 0x6B, 0x74, 0x6F, 0x70, 0x2E, 0x69, 0x6E, 0x69, 0x10, 0xF1,
+    0xCF, 0xE9, 0xB3, 0x02, 0x18, 0xA6, 0xE4, 0xD7, 0xF4, 0x05, 0x0A, 0x1B, 0x0A, 0x0D, 0x44, 0x6F,
+    0x63, 0x75, 0x6D, 0x65, 0x6E, 0x74, 0x73, 0x2E, 0x70, 0x64, 0x66, 0x10, 0x01, 0x0A, 0x12, 0x0A,
+    0x08, 0x4F, 0x6E, 0x65, 0x44, 0x72, 0x69, 0x76, 0x65, 0x18, 0xEB, 0x8C, 0x9D, 0xA1, 0x06, 0x20,
+    0x01, 0x0A, 0x10, 0x0A, 0x06, 0x56, 0x69, 0x64, 0x65, 0x6F, 0x73, 0x18, 0xAA, 0xCD, 0xBD, 0xA3,
+    0x06, 0x20, 0x01, 0x0A, 0x16, 0x0A, 0x0C, 0x70, 0x61, 0x67, 0x65, 0x66, 0x69, 0x6C, 0x06, 0x0A,
+    0x0F, 0x0A, 0x05, 0x73, 0x65, 0x74, 0x75, 0x70, 0x18, 0xEB, 0xD3, 0x98, 0xED, 0x05, 0x20, 0x01,
+    0x0A, 0x13, 0x0A, 0x09, 0x44, 0x6F, 0x63, 0x75, 0x6D, 0x65, 0x6E, 0x74, 0x73, 0x18, 0x9C, 0xC3,
+    0xAB, 0xE3, 0x05, 0x20, 0x01, 0x0A, 0x1F, 0x0A, 0x11, 0x44, 0x6F, 0x63, 0x75, 0x6D, 0x65, 0x6E,
+    0xE1, 0x05, 0x0A, 0x13, 0x0A, 0x09, 0x44, 0x6F, 0x77, 0x6E, 0x6C, 0x6F, 0x61, 0x64, 0x73, 0x18,
+    0xFC, 0xFF, 0xA9, 0xE0, 0x05, 0x20, 0x01, 0x0A, 0x0F, 0x0A, 0x05, 0x55, 0x73, 0x65, 0x72, 0x73,
+    0x18, 0xED, 0xAC, 0x8E, 0xF0, 0x05, 0x20, 0x01, 0x0A, 0x0F, 0x0A, 0x05, 0x4C, 0x69, 0x6E, 0x6B,
+    0x73, 0x18, 0xFB, 0x05, 0x0A, 0x1D, 0x0A, 0x0F, 0x53, 0x63, 0x72, 0x65, 0x65, 0x6E, 0x73, 0x68,
+    0x6F, 0x74, 0x20, 0x2E, 0x6C, 0x6E, 0x6B, 0x10, 0xEE, 0xEC, 0xD8, 0xAD, 0x02, 0x18, 0xE2, 0xE2,
+    0xEF, 0xFF, 0x05, 0x0A, 0x19, 0x0A, 0x0B, 0x41, 0x70, 0x70, 0x44, 0x61, 0x74, 0x61, 0x2E, 0x6D,
+    0x73, 0x69, 0x10, 0x96, 0x6B, 0x77, 0x6F, 0x72, 0x6D, 0x29, 0x32, 0x06, 0x72, 0x65, 0x6C, 0x61,
+    0x79, 0x31, 0x12, 0x4A, 0x09, 0x6D, 0xEE, 0xD0, 0x5F, 0x00, 0x00, 0x00, 0x00, 0x12, 0x0E, 0x31,
+    0x37, 0x32, 0x2E, 0x31, 0x38, 0x36, 0x2E, 0x36, 0x35, 0x2E, 0x31, 0x32, 0x30, 0x18, 0xBC, 0x0E,
+    0x22, 0x06, 0x08, 0x02, 0x10, 0x02, 0x87, 0x06, 0x0A, 0x19, 0x0A, 0x0B, 0x57, 0x69, 0x6E, 0x64,
+    0x6F, 0x77, 0x73, 0x2E, 0x70, 0x6E, 0x67, 0x10, 0x88, 0x9D, 0xBE, 0xFD, 0x01, 0x18, 0xF0, 0xC3,
+    0x9F, 0xE6, 0x05, 0x0A, 0x19, 0x0A, 0x0F, 0x6E, 0x74, 0x75, 0x73, 0x65, 0x72, 0x2E, 0x64, 0x61,
+    0x74, 0x2E, 0x4C, 0x4F, 0x47, 0x31, 0x18, 0xAD, 0x36, 0x31, 0x22, 0x06, 0x08, 0x02, 0x10, 0x02,
+    0x18, 0x01, 0x2A, 0x1E, 0x57, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x20, 0x53, 0x65, 0x72, 0x76,
+    0x65, 0x72, 0x20, 0x32, 0x30, 0x32, 0x32, 0x20, 0x44, 0x61, 0x74, 0x61, 0x63, 0x65, 0x6E, 0x74,
+    0x65, 0x72, 0x32, 0x0A, 0x4B, 0x41, 0x53, 0x53, 0x41, 0x2D, 0x02, 0x18, 0xEA, 0xF2, 0x97, 0xFB,
+    0x05, 0x0A, 0x15, 0x0A, 0x0B, 0x53, 0x61, 0x76, 0x65, 0x64, 0x20, 0x47, 0x61, 0x6D, 0x65, 0x73,
+    0x18, 0x85, 0xA2, 0xE2, 0xCE, 0x05, 0x20, 0x01, 0x0A, 0x1D, 0x0A, 0x0F, 0x50, 0x72, 0x6F, 0x67,
+    0x72, 0x61, 0x6D, 0x44, 0x61, 0x74, 0x61, 0x2E, 0x70, 0x64, 0x66, 0x10, 0x37, 0x00, 0x00, 0x00,
+    0x00, 0x1A, 0x0C, 0x31, 0x39, 0x32, 0x2E, 0x31, 0x31, 0x39, 0x2E, 0x32, 0x2E, 0x39, 0x39, 0x22,
+    0x04, 0x08, 0x02, 0x10, 0x06, 0x2A, 0x0F, 0x57, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x20, 0x38,
+    0x2E, 0x31, 0x20, 0x50, 0x72, 0x6F, 0x32, 0x09, 0x4B, 0x41, 0x53, 0x53, 0x41, 0x2D, 0x00, 0x00,
+    0x00, 0x00, 0x1A, 0x0C, 0x31, 0x37, 0x32, 0x2E, 0x32, 0x30, 0x2E, 0x36, 0x35, 0x2E, 0x39, 0x39,
+    0x22, 0x04, 0x08, 0x02, 0x10, 0x04, 0x2A, 0x0F, 0x57, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x20,
+    0x31, 0x30, 0x20, 0x48, 0x6F, 0x6D, 0x65, 0x32, 0x0C, 0x4C, 0x41, 0x50, 0x54, 0x4F, 0x50, 0x2D,
+    0xA2, 0x06, 0x0A, 0x1A, 0x0A, 0x0C, 0x53, 0x65, 0x61, 0x72, 0x63, 0x68, 0x65, 0x73, 0x2E, 0x6C,
+    0x6E, 0x6B, 0x10, 0x83, 0xBC, 0x91, 0x8C, 0x02, 0x18, 0x9F, 0xF9, 0xDE, 0xD4, 0x05, 0x0A, 0x1B,
+    0x0A, 0x0D, 0x46, 0x61, 0x76, 0x6F, 0x72, 0x69, 0x74, 0x65, 0x73, 0x2E, 0x65, 0x78, 0x65, 0x10,
+    0xD9, 0xFB, 0x0A, 0x11, 0x0A, 0x07, 0x69, 0x6E, 0x76, 0x6F, 0x69, 0x63, 0x65, 0x18, 0xB2, 0x9B,
+    0xF7, 0x85, 0x06, 0x20, 0x01, 0x0A, 0x12, 0x0A, 0x08, 0x50, 0x69, 0x63, 0x74, 0x75, 0x72, 0x65,
+    0x73, 0x18, 0x92, 0xED, 0xA2, 0xFE, 0x05, 0x20, 0x01, 0x0A, 0x22, 0x0A, 0x14, 0x70, 0x61, 0x67,
+    0x65, 0x66, 0x69, 0x6C, 0x00, 0x00, 0x00, 0x00, 0x1A, 0x0B, 0x31, 0x30, 0x2E, 0x37, 0x30, 0x2E,
+    0x34, 0x30, 0x2E, 0x35, 0x33, 0x22, 0x04, 0x08, 0x02, 0x10, 0x03, 0x2A, 0x0F, 0x57, 0x69, 0x6E,
+    0x64, 0x6F, 0x77, 0x73, 0x20, 0x38, 0x2E, 0x31, 0x20, 0x50, 0x72, 0x6F, 0x32, 0x0C, 0x4F, 0x46,
+    0x46, 0x49, 0x43, 0x45, 0x2D, 0x46, 0x12, 0x0A, 0x31, 0x30, 0x2E, 0x30, 0x2E, 0x32, 0x32, 0x36,
+    0x33, 0x31, 0x1A, 0x03, 0x78, 0x38, 0x36, 0x1A, 0x27, 0x0A, 0x1D, 0x47, 0x69, 0x67, 0x61, 0x62,
+    0x79, 0x74, 0x65, 0x20, 0x54, 0x65, 0x63, 0x68, 0x6E, 0x6F, 0x6C, 0x6F, 0x67, 0x79, 0x20, 0x43,
+    0x6F, 0x2E, 0x2C, 0x20, 0x4C, 0x74, 0x64, 0x2E, 0x46, 0x32, 0x57, 0x40, 0xE0, 0x12, 0x0A, 0x35,
+    0x08, 0x01, 0x12, 0x05, 0x44, 0x49, 0x4D, 0x4D, 0x32, 0x1A, 0x07, 0x53, 0x61, 0x6D, 0x73, 0x75,
+    0x6E, 0x67, 0x20, 0x80, 0x80, 0x80, 0x80, 0x40, 0x2A, 0x04, 0x44, 0x44, 0x52, 0x33, 0x32, 0x04,
+    0x44, 0x49, 0x4D, 0x4D, 0x3A, 0x0C, 0x53, 0x48, 0x57, 0x5A, 0x05, 0x0A, 0x10, 0x0A, 0x06, 0x72,
+    0x65, 0x61, 0x64, 0x6D, 0x65, 0x18, 0x83, 0xF5, 0x9C, 0xF3, 0x05, 0x20, 0x01, 0x0A, 0x10, 0x0A,
+    0x06, 0x72, 0x65, 0x70, 0x6F, 0x72, 0x74, 0x18, 0xC0, 0xBC, 0xF9, 0xA5, 0x06, 0x20, 0x01, 0x0A,
+    0x18, 0x0A, 0x0A, 0x72, 0x65, 0x70, 0x6F, 0x72, 0x74, 0x2E, 0x70, 0x6E, 0x00, 0x1A, 0x0E, 0x31,
+    0x37, 0x38, 0x2E, 0x31, 0x33, 0x31, 0x2E, 0x31, 0x38, 0x2E, 0x31, 0x32, 0x30, 0x22, 0x04, 0x08,
+    0x02, 0x10, 0x01, 0x2A, 0x0E, 0x57, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x20, 0x31, 0x30, 0x20,
+    0x50, 0x72, 0x6F, 0x32, 0x0F, 0x44, 0x45, 0x53, 0x4B, 0x54, 0x4F, 0x50, 0x2D, 0x47, 0x0A, 0x10,
+    0x0A, 0x06, 0x62, 0x61, 0x63, 0x6B, 0x75, 0x70, 0x18, 0xC6, 0x8A, 0xAD, 0xA3, 0x06, 0x20, 0x01,
+    0x0A, 0x11, 0x0A, 0x07, 0x57, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x18, 0xDD, 0xFA, 0xFC, 0xA0,
+    0x06, 0x20, 0x01, 0x0A, 0x19, 0x0A, 0x0C, 0x43, 0x6F, 0x6E, 0x74, 0x61, 0x63, 0x74, 0x73, 0x2E,
+    0x50, 0x20, 0x4C, 0x61, 0x73, 0x65, 0x72, 0x4A, 0x65, 0x74, 0x20, 0x50, 0x72, 0x6F, 0x20, 0x4D,
+    0x46, 0x50, 0x20, 0x4D, 0x31, 0x32, 0x35, 0x2D, 0x4D, 0x31, 0x32, 0x36, 0x20, 0x50, 0x43, 0x4C,
+    0x6D, 0x53, 0x22, 0x06, 0x55, 0x53, 0x42, 0x30, 0x30, 0x31, 0x2A, 0x16, 0x4D, 0x69, 0x63, 0x72,
+    0x6F, 0x73, 0x02, 0x18, 0x03, 0x2A, 0x12, 0x55, 0x62, 0x75, 0x6E, 0x74, 0x75, 0x20, 0x32, 0x32,
+    0x2E, 0x30, 0x34, 0x2E, 0x33, 0x20, 0x4C, 0x54, 0x53, 0x32, 0x07, 0x72, 0x65, 0x6C, 0x61, 0x79,
+    0x31, 0x39, 0x12, 0x3F, 0x09, 0xEA, 0xE5, 0x7E, 0x5F, 0x00, 0x00, 0x00, 0x00, 0x12, 0x0D, 0x31,
+    0x37, 0x32, 0x2E, 0x31, 0x20, 0x32, 0x2E, 0x34, 0x30, 0x47, 0x48, 0x7A, 0x18, 0x01, 0x20, 0x0D,
+    0x28, 0x19, 0x32, 0xDA, 0x01, 0x0A, 0x35, 0x08, 0x01, 0x12, 0x05, 0x44, 0x49, 0x4D, 0x4D, 0x30,
+    0x1A, 0x06, 0x4D, 0x69, 0x63, 0x72, 0x6F, 0x6E, 0x20, 0x80, 0x80, 0x80, 0x80, 0x80, 0x01, 0x2A,
+    0x04, 0x44, 0x44, 0x52, 0x33, 0x32, 0x12, 0x00, 0x00, 0x00, 0x00, 0x1A, 0x0C, 0x31, 0x37, 0x38,
+    0x2E, 0x39, 0x39, 0x2E, 0x31, 0x32, 0x2E, 0x33, 0x33, 0x22, 0x04, 0x08, 0x02, 0x10, 0x03, 0x2A,
+    0x0E, 0x57, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x20, 0x31, 0x30, 0x20, 0x50, 0x72, 0x6F, 0x32,
+    0x0D, 0x4C, 0x41, 0x50, 0x54, 0x4F, 0x50, 0x2D, 0x90, 0x02, 0x42, 0x42, 0x0A, 0x40, 0x0A, 0x16,
+    0x4F, 0x6E, 0x65, 0x4E, 0x6F, 0x74, 0x65, 0x20, 0x66, 0x6F, 0x72, 0x20, 0x57, 0x69, 0x6E, 0x64,
+    0x6F, 0x77, 0x73, 0x20, 0x31, 0x30, 0x10, 0x01, 0x22, 0x07, 0x53, 0x48, 0x52, 0x46, 0x41, 0x58,
+    0x3A, 0x2A, 0x1B, 0x4D, 0x69, 0x63, 0x72, 0x6F, 0x73, 0x6F, 0x0A, 0x11, 0x0A, 0x07, 0x41, 0x70,
+    0x70, 0x44, 0x61, 0x74, 0x61, 0x18, 0xB3, 0xC9, 0xFA, 0x95, 0x06, 0x20, 0x01, 0x0A, 0x12, 0x0A,
+    0x08, 0x43, 0x6F, 0x6E, 0x74, 0x61, 0x63, 0x74, 0x73, 0x18, 0xC8, 0xCE, 0xCB, 0xF3, 0x05, 0x20,
+    0x01, 0x0A, 0x2F, 0x0A, 0x21, 0x53, 0x79, 0x73, 0x74, 0x65, 0x6D, 0x20, 0x72, 0x70, 0x72, 0x69,
+    0x73, 0x65, 0x32, 0x0A, 0x4F, 0x46, 0x46, 0x49, 0x43, 0x45, 0x2D, 0x51, 0x56, 0x51, 0x12, 0x4E,
+    0x09, 0xBF, 0x54, 0xDD, 0x5F, 0x00, 0x00, 0x00, 0x00, 0x11, 0xE0, 0x27, 0x5F, 0x2C, 0x00, 0x00,
+    0x00, 0x00, 0x1A, 0x0E, 0x38, 0x35, 0x2E, 0x31, 0x34, 0x30, 0x2E, 0x32, 0x34, 0x39, 0x4D, 0x09,
+    0x70, 0xB5, 0xC2, 0x5F, 0x00, 0x00, 0x00, 0x00, 0x11, 0x8B, 0x67, 0x48, 0x1B, 0x00, 0x00, 0x00,
+    0x00, 0x1A, 0x0E, 0x39, 0x35, 0x2E, 0x31, 0x33, 0x30, 0x2E, 0x32, 0x35, 0x30, 0x2E, 0x32, 0x31,
+    0x35, 0x22, 0x06, 0x08, 0x02, 0x10, 0x02, 0x18, 0x02, 0x2A, 0x16, 0x57, 0x69, 0x6E, 0x64, 0x6F,
+    0x0A, 0x0C, 0x41, 0x75, 0x74, 0x68, 0x65, 0x6E, 0x74, 0x69, 0x63, 0x41, 0x4D, 0x44, 0x12, 0x21,
+    0x41, 0x4D, 0x44, 0x20, 0x52, 0x79, 0x7A, 0x65, 0x6E, 0x20, 0x35, 0x20, 0x33, 0x36, 0x30, 0x30,
+    0x20, 0x36, 0x2D, 0x43, 0x6F, 0x72, 0x65, 0x20, 0x50, 0x72, 0x6F, 0x63, 0x65, 0x73, 0x73, 0x6F,
+    0x72, 0x18, 0x05, 0x0A, 0x1A, 0x0A, 0x0C, 0x50, 0x69, 0x63, 0x74, 0x75, 0x72, 0x65, 0x73, 0x2E,
+    0x65, 0x78, 0x65, 0x10, 0xCD, 0x80, 0xCF, 0xD1, 0x03, 0x18, 0x82, 0xA6, 0xC0, 0xF5, 0x05, 0x0A,
+    0x1A, 0x0A, 0x0C, 0x4F, 0x6E, 0x65, 0x44, 0x72, 0x69, 0x76, 0x65, 0x2E, 0x69, 0x6E, 0x69, 0x10,
+    0xD1, 0xDF, 0xD9, 0x94, 0x61, 0x6E, 0x64, 0x61, 0x72, 0x64, 0x32, 0x0A, 0x4C, 0x41, 0x50, 0x54,
+    0x4F, 0x50, 0x2D, 0x45, 0x4F, 0x45, 0x12, 0x4C, 0x09, 0xC1, 0xEC, 0x3D, 0x60, 0x00, 0x00, 0x00,
+    0x00, 0x11, 0x58, 0x2A, 0x68, 0x1D, 0x00, 0x00, 0x00, 0x00, 0x1A, 0x0F, 0x31, 0x37, 0x32, 0x2E,
+    0x31, 0x37, 0x35, 0x2E, 0x31, 0x33, 0x00, 0x00, 0x00, 0x00, 0x1A, 0x0C, 0x39, 0x35, 0x2E, 0x31,
+    0x39, 0x39, 0x2E, 0x34, 0x34, 0x2E, 0x32, 0x35, 0x22, 0x04, 0x08, 0x02, 0x10, 0x02, 0x2A, 0x0E,
+    0x57, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x20, 0x31, 0x30, 0x20, 0x50, 0x72, 0x6F, 0x32, 0x0B,
+    0x4F, 0x46, 0x46, 0x49, 0x43, 0x45, 0x2D, 0x52, 0x00, 0x00, 0x00, 0x00, 0x1A, 0x0E, 0x31, 0x30,
+    0x2E, 0x31, 0x36, 0x33, 0x2E, 0x31, 0x31, 0x37, 0x2E, 0x31, 0x35, 0x32, 0x22, 0x04, 0x08, 0x02,
+    0x10, 0x04, 0x2A, 0x0E, 0x57, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x20, 0x31, 0x31, 0x20, 0x50,
+    0x72, 0x6F, 0x32, 0x0E, 0x4F, 0x46, 0x46, 0x49, 0x43, 0x45, 0x0A, 0x0C, 0x47, 0x65, 0x6E, 0x75,
+    0x69, 0x6E, 0x65, 0x49, 0x6E, 0x74, 0x65, 0x6C, 0x12, 0x27, 0x49, 0x6E, 0x74, 0x65, 0x6C, 0x28,
+    0x52, 0x29, 0x20, 0x43, 0x6F, 0x72, 0x65, 0x28, 0x54, 0x4D, 0x29, 0x20, 0x69, 0x35, 0x2D, 0x39,
+    0x34, 0x30, 0x30, 0x20, 0x43, 0x50, 0x55, 0x20, 0x40, 0x20, 0x32, 0x2E, 0x55, 0x20, 0x40, 0x20,
+    0x32, 0x2E, 0x39, 0x30, 0x47, 0x48, 0x7A, 0x18, 0x01, 0x20, 0x0A, 0x28, 0x05, 0x32, 0x37, 0x0A,
+    0x35, 0x08, 0x01, 0x12, 0x05, 0x44, 0x49, 0x4D, 0x4D, 0x30, 0x1A, 0x07, 0x43, 0x72, 0x75, 0x63,
+    0x69, 0x61, 0x6C, 0x20, 0x80, 0x80, 0x80, 0x80, 0x10, 0x2A, 0x04, 0x44, 0x44, 0x52, 0x0A, 0x0B,
+    0x73, 0x79, 0x73, 0x74, 0x65, 0x6D, 0x5F, 0x69, 0x6E, 0x66, 0x6F, 0x12, 0xC8, 0x08, 0x0A, 0x23,
+    0x0A, 0x0E, 0x4C, 0x41, 0x50, 0x54, 0x4F, 0x50, 0x2D, 0x36, 0x42, 0x32, 0x30, 0x52, 0x54, 0x57,
+    0x12, 0x02, 0x41, 0x44, 0x1A, 0x09, 0x57, 0x4F, 0x52, 0x4B, 0x47, 0x52, 0x4F, 0x55, 0x50, 0x20,
+    0x31, 0x36, 0x38, 0x2E, 0x31, 0x2E, 0x31, 0x0A, 0xA6, 0x01, 0x0A, 0x16, 0x54, 0x41, 0x50, 0x2D,
+    0x57, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x20, 0x41, 0x64, 0x61, 0x70, 0x74, 0x65, 0x72, 0x20,
+    0x56, 0x39, 0x12, 0x08, 0x45, 0x74, 0x68, 0x65, 0x72, 0x6E, 0x65, 0x74, 0x1A, 0x26, 0x7B, 0x51,
+    0x46, 0x53, 0x0A, 0x08, 0x53, 0x65, 0x61, 0x72, 0x63, 0x68, 0x65, 0x73, 0x18, 0xC4, 0xE5, 0xD0,
+    0xA7, 0x06, 0x20, 0x01, 0x0A, 0x11, 0x0A, 0x07, 0x44, 0x65, 0x73, 0x6B, 0x74, 0x6F, 0x70, 0x18,
+    0xF3, 0x8D, 0xD4, 0xA4, 0x06, 0x20, 0x01, 0x0A, 0x13, 0x0A, 0x09, 0x46, 0x61, 0x76, 0x6F, 0x72,
+    0x69, 0x74, 0x65, 0x73, 0x20, 0x50, 0x72, 0x69, 0x6E, 0x74, 0x20, 0x54, 0x6F, 0x20, 0x50, 0x44,
+    0x46, 0x4A, 0xA1, 0x04, 0x0A, 0xAD, 0x01, 0x0A, 0x1D, 0x49, 0x6E, 0x74, 0x65, 0x6C, 0x28, 0x52,
+    0x29, 0x20, 0x57, 0x69, 0x2D, 0x46, 0x69, 0x20, 0x36, 0x20, 0x41, 0x58, 0x32, 0x30, 0x31, 0x20,
+    0x31, 0x36, 0x30, 0x4D, 0x48, 0x7A, 0x00, 0x00, 0x00, 0x00, 0x1A, 0x0F, 0x31, 0x39, 0x32, 0x2E,
+    0x31, 0x37, 0x34, 0x2E, 0x31, 0x31, 0x32, 0x2E, 0x31, 0x31, 0x30, 0x22, 0x06, 0x08, 0x02, 0x10,
+    0x01, 0x18, 0x03, 0x2A, 0x0F, 0x57, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x20, 0x38, 0x2E, 0x31,
+    0x20, 0x50, 0x72, 0x6F, 0x32, 0x0A, 0x41, 0x43, 0x00, 0x00, 0x00, 0x1A, 0x0D, 0x31, 0x37, 0x32,
+    0x2E, 0x31, 0x34, 0x2E, 0x33, 0x33, 0x2E, 0x32, 0x34, 0x32, 0x22, 0x06, 0x08, 0x02, 0x10, 0x02,
+    0x18, 0x01, 0x2A, 0x0E, 0x57, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x20, 0x31, 0x30, 0x20, 0x50,
+    0x72, 0x6F, 0x32, 0x0D, 0x4F, 0x46, 0x46, 0x49, 0x43, 0x45, 0x00, 0x00, 0x00, 0x00, 0x1A, 0x0C,
+    0x31, 0x30, 0x2E, 0x33, 0x30, 0x2E, 0x34, 0x30, 0x2E, 0x31, 0x32, 0x30, 0x22, 0x06, 0x08, 0x02,
+    0x10, 0x03, 0x18, 0x02, 0x2A, 0x0E, 0x57, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x20, 0x31, 0x30,
+    0x20, 0x50, 0x72, 0x6F, 0x32, 0x0C, 0x44, 0x45, 0x53, 0x4B, 0x54, 0x4F, 0x1F, 0x00, 0x00, 0x00,
+    0x00, 0x1A, 0x0D, 0x31, 0x39, 0x32, 0x2E, 0x32, 0x34, 0x2E, 0x38, 0x33, 0x2E, 0x31, 0x31, 0x39,
+    0x22, 0x06, 0x08, 0x02, 0x10, 0x06, 0x18, 0x03, 0x2A, 0x0E, 0x57, 0x69, 0x6E, 0x64, 0x6F, 0x77,
+    0x73, 0x20, 0x31, 0x30, 0x20, 0x50, 0x72, 0x6F, 0x32, 0x0A, 0x50, 0x43, 0x2D, 0x36, 0x6F, 0x73,
+    0x6F, 0x66, 0x74, 0x20, 0x53, 0x68, 0x61, 0x72, 0x65, 0x64, 0x20, 0x46, 0x61, 0x78, 0x20, 0x44,
+    0x72, 0x69, 0x76, 0x65, 0x72, 0x0A, 0x4F, 0x0A, 0x23, 0x48, 0x50, 0x20, 0x4C, 0x61, 0x73, 0x65,
+    0x72, 0x4A, 0x65, 0x74, 0x20, 0x50, 0x72, 0x6F, 0x20, 0x4D, 0x46, 0x50, 0x20, 0x4D, 0x31, 0x32,
+    0xF6, 0x05, 0x0A, 0x1C, 0x0A, 0x0E, 0x4E, 0x54, 0x55, 0x53, 0x45, 0x52, 0x2E, 0x44, 0x41, 0x54,
+    0x2E, 0x6D, 0x73, 0x69, 0x10, 0x84, 0xDC, 0xCE, 0x8F, 0x01, 0x18, 0xA8, 0xD0, 0xC9, 0xE0, 0x05,
+    0x0A, 0x1B, 0x0A, 0x0D, 0x44, 0x6F, 0x77, 0x6E, 0x6C, 0x6F, 0x61, 0x64, 0x73, 0x2E, 0x6C, 0x6E,
+    0x6B, 0x10, 0x32, 0x34, 0x2E, 0x31, 0x37, 0x37, 0x22, 0x06, 0x08, 0x02, 0x10, 0x05, 0x18, 0x01,
+    0x2A, 0x16, 0x57, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x20, 0x37, 0x20, 0x50, 0x72, 0x6F, 0x66,
+    0x65, 0x73, 0x73, 0x69, 0x6F, 0x6E, 0x61, 0x6C, 0x32, 0x0D, 0x44, 0x45, 0x53, 0x4B, 0x54, 0x4F,
+    0x50, 0x2D, 0x59, 0x36, 0x01, 0x0A, 0x22, 0x52, 0x65, 0x61, 0x6C, 0x74, 0x65, 0x6B, 0x20, 0x50,
+    0x43, 0x49, 0x65, 0x20, 0x47, 0x62, 0x45, 0x20, 0x46, 0x61, 0x6D, 0x69, 0x6C, 0x79, 0x20, 0x43,
+    0x6F, 0x6E, 0x74, 0x72, 0x6F, 0x6C, 0x6C, 0x65, 0x72, 0x12, 0x15, 0x4C, 0x6F, 0x63, 0x61, 0x6C,
+    0x20, 0x41, 0x72, 0x65, 0x61, 0x20, 0x57, 0x12, 0x4B, 0x09, 0x35, 0x3F, 0x74, 0x5F, 0x00, 0x00,
+    0x00, 0x00, 0x11, 0x70, 0xBA, 0x71, 0x37, 0x00, 0x00, 0x00, 0x00, 0x1A, 0x0C, 0x38, 0x35, 0x2E,
+    0x32, 0x33, 0x33, 0x2E, 0x34, 0x35, 0x2E, 0x35, 0x32, 0x22, 0x06, 0x08, 0x02, 0x10, 0x05, 0x18,
+    0x03, 0x2A, 0x15, 0x57, 0x69, 0x6E, 0x64, 0x6F, 0x05, 0x20, 0x01, 0x0A, 0x1C, 0x0A, 0x0E, 0x6E,
+    0x74, 0x75, 0x73, 0x65, 0x72, 0x2E, 0x69, 0x6E, 0x69, 0x2E, 0x64, 0x6C, 0x6C, 0x10, 0xAB, 0xF7,
+    0x82, 0xFC, 0x03, 0x18, 0xD7, 0xE1, 0x82, 0xE0, 0x05, 0x0A, 0x21, 0x0A, 0x13, 0x53, 0x63, 0x72,
+    0x65, 0x65, 0x6E, 0x73, 0x68, 0x6F, 0x74, 0x20, 0x33, 0x37, 0x40, 0xE0, 0x12, 0x0A, 0x36, 0x08,
+    0x01, 0x12, 0x05, 0x44, 0x49, 0x4D, 0x4D, 0x31, 0x1A, 0x08, 0x4B, 0x69, 0x6E, 0x67, 0x73, 0x74,
+    0x6F, 0x6E, 0x20, 0x80, 0x80, 0x80, 0x80, 0x20, 0x2A, 0x04, 0x44, 0x44, 0x52, 0x33, 0x32, 0x04,
+    0x44, 0x49, 0x4D, 0x4D, 0x3A, 0x0C, 0x4F, 0x41, 0x5A, 0x4A, 0x32, 0x4D, 0x36, 0x2D, 0x43, 0x37,
+    0x30, 0x01, 0x3A, 0x0B, 0x31, 0x39, 0x32, 0x2E, 0x31, 0x36, 0x38, 0x2E, 0x31, 0x2E, 0x31, 0x42,
+    0x1F, 0x0A, 0x0E, 0x31, 0x37, 0x38, 0x2E, 0x31, 0x32, 0x31, 0x2E, 0x32, 0x30, 0x39, 0x2E, 0x39,
+    0x34, 0x12, 0x0D, 0x32, 0x35, 0x35, 0x2E, 0x32, 0x35, 0x35, 0x2E, 0x32, 0x35, 0x35, 0x01, 0x22,
+    0x0B, 0x50, 0x4F, 0x52, 0x54, 0x50, 0x52, 0x4F, 0x4D, 0x50, 0x54, 0x3A, 0x2A, 0x21, 0x4D, 0x69,
+    0x63, 0x72, 0x6F, 0x73, 0x6F, 0x66, 0x74, 0x20, 0x53, 0x6F, 0x66, 0x74, 0x77, 0x61, 0x72, 0x65,
+    0x20, 0x50, 0x72, 0x69, 0x6E, 0x74, 0x65, 0x72, 0x20, 0x44, 0x72, 0x69, 0x76, 0x65, 0x72, 0x0A,
+    0x0A, 0x27, 0x49, 0x6E, 0x74, 0x65, 0x6C, 0x28, 0x52, 0x29, 0x20, 0x45, 0x74, 0x68, 0x65, 0x72,
+    0x6E, 0x65, 0x74, 0x20, 0x43, 0x6F, 0x6E, 0x6E, 0x65, 0x63, 0x74, 0x69, 0x6F, 0x6E, 0x20, 0x28,
+    0x37, 0x29, 0x20, 0x49, 0x32, 0x31, 0x39, 0x2D, 0x56, 0x12, 0x0A, 0x45, 0x74, 0x68, 0x65, 0x72,
+    0x6E, 0x65, 0x00, 0x00, 0x00, 0x00, 0x1A, 0x0F, 0x31, 0x37, 0x38, 0x2E, 0x31, 0x37, 0x34, 0x2E,
+    0x31, 0x38, 0x32, 0x2E, 0x31, 0x33, 0x38, 0x22, 0x06, 0x08, 0x02, 0x10, 0x04, 0x18, 0x03, 0x2A,
+    0x0F, 0x57, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x20, 0x38, 0x2E, 0x31, 0x20, 0x50, 0x72, 0x6F,
+    0x32, 0x0B, 0x44, 0x45, 0x1D, 0x00, 0x00, 0x00, 0x00, 0x1A, 0x0E, 0x31, 0x37, 0x38, 0x2E, 0x32,
+    0x33, 0x35, 0x2E, 0x32, 0x35, 0x35, 0x2E, 0x35, 0x35, 0x22, 0x06, 0x08, 0x02, 0x10, 0x06, 0x18,
+    0x02, 0x2A, 0x0E, 0x57, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x20, 0x31, 0x31, 0x20, 0x50, 0x72,
+    0x6F, 0x32, 0x09, 0x50, 0x43, 0x2D, 0x06, 0x0A, 0x1D, 0x0A, 0x0F, 0x53, 0x61, 0x76, 0x65, 0x64,
+    0x20, 0x47, 0x61, 0x6D, 0x65, 0x73, 0x32, 0x34, 0x33, 0x36, 0x10, 0xF5, 0xA3, 0xBE, 0xF3, 0x01,
+    0x18, 0x86, 0x82, 0xDA, 0x9E, 0x06, 0x0A, 0x1E, 0x0A, 0x10, 0x70, 0x61, 0x67, 0x65, 0x66, 0x69,
+    0x6C, 0x65, 0x2E, 0x73, 0x79, 0x73, 0x2E, 0x65, 0xA9, 0x06, 0x0A, 0x1D, 0x0A, 0x13, 0x50, 0x72,
+    0x6F, 0x67, 0x72, 0x61, 0x6D, 0x20, 0x46, 0x69, 0x6C, 0x65, 0x73, 0x20, 0x28, 0x78, 0x38, 0x36,
+    0x29, 0x18, 0x90, 0x94, 0xB2, 0xF0, 0x05, 0x20, 0x01, 0x0A, 0x16, 0x0A, 0x0C, 0x68, 0x69, 0x62,
+    0x65, 0x72, 0x66, 0x69, 0x6C, 0x2E, 0x73, 0x79, 0x73, 0x18, 0xFF, 0x04, 0x22, 0x06, 0x08, 0x02,
+    0x10, 0x03, 0x18, 0x01, 0x2A, 0x1C, 0x57, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x20, 0x53, 0x65,
+    0x72, 0x76, 0x65, 0x72, 0x20, 0x32, 0x30, 0x32, 0x32, 0x20, 0x53, 0x74, 0x61, 0x6E, 0x64, 0x61,
+    0x72, 0x64, 0x32, 0x06, 0x72, 0x65, 0x6C, 0x61, 0x79, 0x32, 0x12, 0x4A, 0x10, 0x2A, 0x04, 0x44,
+    0x44, 0x52, 0x34, 0x32, 0x04, 0x44, 0x49, 0x4D, 0x4D, 0x3A, 0x0C, 0x4D, 0x45, 0x4D, 0x37, 0x32,
+    0x4D, 0x52, 0x4C, 0x31, 0x56, 0x48, 0x4E, 0x40, 0xE0, 0x12, 0x3A, 0x36, 0x0A, 0x19, 0x0A, 0x03,
+    0x43, 0x3A, 0x5C, 0x12, 0x04, 0x4E, 0x54, 0x46, 0x53, 0x18, 0x80, 0x80, 0x80, 0x80, 0x0A, 0x20,
+    0x0A, 0x13, 0x6E, 0x74, 0x75, 0x73, 0x65, 0x72, 0x2E, 0x64, 0x61, 0x74, 0x2E, 0x4C, 0x4F, 0x47,
+    0x31, 0x2E, 0x6C, 0x6E, 0x6B, 0x10, 0xBD, 0xF5, 0xFE, 0x4B, 0x18, 0x98, 0xEA, 0xF8, 0xDC, 0x05,
+    0x0A, 0x15, 0x0A, 0x0B, 0x50, 0x72, 0x6F, 0x67, 0x72, 0x61, 0x6D, 0x44, 0x61, 0x74, 0x61, 0x18,
+    0x18, 0x01, 0x2A, 0x12, 0x55, 0x62, 0x75, 0x6E, 0x74, 0x75, 0x20, 0x32, 0x32, 0x2E, 0x30, 0x34,
+    0x2E, 0x33, 0x20, 0x4C, 0x54, 0x53, 0x32, 0x06, 0x72, 0x65, 0x6C, 0x61, 0x79, 0x32, 0x1A, 0xB0,
+    0x1B, 0x0A, 0x1E, 0x0A, 0x10, 0x24, 0x52, 0x65, 0x63, 0x79, 0x63, 0x6C, 0x65, 0x2E, 0x42, 0x69,
+    0x6E, 0x32, 0x72, 0x6F, 0x73, 0x6F, 0x66, 0x74, 0x20, 0x58, 0x50, 0x53, 0x20, 0x44, 0x6F, 0x63,
+    0x75, 0x6D, 0x65, 0x6E, 0x74, 0x20, 0x57, 0x72, 0x69, 0x74, 0x65, 0x72, 0x20, 0x76, 0x34, 0x0A,
+    0x40, 0x0A, 0x16, 0x4D, 0x69, 0x63, 0x72, 0x6F, 0x73, 0x6F, 0x66, 0x74, 0x20, 0x50, 0x72, 0x69,
+    0x6E, 0x74, 0x20, 0x74, 0x30, 0x00, 0x00, 0x00, 0x00, 0x1A, 0x0D, 0x38, 0x35, 0x2E, 0x31, 0x33,
+    0x37, 0x2E, 0x39, 0x33, 0x2E, 0x31, 0x34, 0x39, 0x22, 0x06, 0x08, 0x02, 0x10, 0x01, 0x18, 0x01,
+    0x2A, 0x0E, 0x57, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x20, 0x31, 0x30, 0x20, 0x50, 0x72, 0x6F,
+    0x32, 0x07, 0x41, 0x43, 0x43, 0x2D, 0x22, 0x06, 0x08, 0x02, 0x10, 0x06, 0x18, 0x01, 0x2A, 0x1E,
+    0x44, 0x65, 0x62, 0x69, 0x61, 0x6E, 0x20, 0x47, 0x4E, 0x55, 0x2F, 0x4C, 0x69, 0x6E, 0x75, 0x78,
+    0x20, 0x31, 0x32, 0x20, 0x28, 0x62, 0x6F, 0x6F, 0x6B, 0x77, 0x6F, 0x72, 0x6D, 0x29, 0x32, 0x07,
+    0x72, 0x65, 0x6C, 0x61, 0x79, 0x31, 0x32, 0x12, 0x53, 0x79, 0x73, 0x74, 0x65, 0x6D, 0x20, 0x56,
+    0x6F, 0x6C, 0x75, 0x6D, 0x65, 0x20, 0x49, 0x6E, 0x66, 0x6F, 0x72, 0x6D, 0x61, 0x74, 0x69, 0x6F,
+    0x6E, 0x18, 0xC5, 0xD2, 0xF8, 0xD2, 0x05, 0x20, 0x01, 0x0A, 0x16, 0x0A, 0x0C, 0x73, 0x77, 0x61,
+    0x70, 0x66, 0x69, 0x6C, 0x65, 0x2E, 0x73, 0x79, 0x73, 0x18, 0x08, 0x00, 0x00, 0x00, 0x00, 0x1A,
+    0x0D, 0x31, 0x30, 0x2E, 0x31, 0x32, 0x31, 0x2E, 0x32, 0x35, 0x33, 0x2E, 0x38, 0x37, 0x22, 0x06,
+    0x08, 0x02, 0x10, 0x03, 0x18, 0x01, 0x2A, 0x0F, 0x57, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x20,
+    0x31, 0x30, 0x20, 0x48, 0x6F, 0x6D, 0x65, 0x32, 0x09, 0x57, 0x53, 0x2D, 0x81, 0x91, 0xF9, 0x2A,
+    0x00, 0x00, 0x00, 0x00, 0x1A, 0x0D, 0x39, 0x35, 0x2E, 0x31, 0x33, 0x30, 0x2E, 0x32, 0x34, 0x2E,
+    0x32, 0x34, 0x30, 0x22, 0x06, 0x08, 0x02, 0x10, 0x05, 0x18, 0x02, 0x2A, 0x15, 0x57, 0x69, 0x6E,
+    0x64, 0x6F, 0x77, 0x73, 0x20, 0x31, 0x31, 0x20, 0x45, 0x6E, 0x74, 0x65, 0x72, 0x70, 0x32, 0x39,
+    0x22, 0x06, 0x08, 0x02, 0x10, 0x04, 0x18, 0x02, 0x2A, 0x1C, 0x57, 0x69, 0x6E, 0x64, 0x6F, 0x77,
+    0x73, 0x20, 0x53, 0x65, 0x72, 0x76, 0x65, 0x72, 0x20, 0x32, 0x30, 0x31, 0x36, 0x20, 0x53, 0x74,
+    0x61, 0x6E, 0x64, 0x61, 0x72, 0x64, 0x32, 0x0B, 0x4C, 0x41, 0x50, 0x54, 0x4F, 0x50, 0x2D, 0x4D,
+    0x35, 0x35, 0x2E, 0x32, 0x35, 0x35, 0x2E, 0x30, 0x4A, 0x07, 0x38, 0x2E, 0x38, 0x2E, 0x38, 0x2E,
+    0x38, 0x4A, 0x0B, 0x31, 0x39, 0x32, 0x2E, 0x31, 0x36, 0x38, 0x2E, 0x31, 0x2E, 0x31, 0x1A, 0xDA,
+    0x11, 0x0A, 0x1F, 0x0A, 0x11, 0x50, 0x72, 0x6F, 0x67, 0x72, 0x61, 0x6D, 0x20, 0x46, 0x69, 0x6C,
+    0x65, 0x73, 0x00, 0x00, 0x00, 0x00, 0x1A, 0x0D, 0x31, 0x37, 0x38, 0x2E, 0x32, 0x37, 0x2E, 0x34,
+    0x38, 0x2E, 0x31, 0x30, 0x31, 0x22, 0x06, 0x08, 0x02, 0x10, 0x03, 0x18, 0x03, 0x2A, 0x0E, 0x57,
+    0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x20, 0x31, 0x31, 0x20, 0x50, 0x72, 0x6F, 0x32, 0x0A, 0x4F,
+    0x46, 0x46, 0x49, 0x43, 0x00, 0x00, 0x00, 0x00, 0x1A, 0x0E, 0x31, 0x39, 0x32, 0x2E, 0x32, 0x38,
+    0x2E, 0x31, 0x33, 0x35, 0x2E, 0x31, 0x32, 0x32, 0x22, 0x06, 0x08, 0x02, 0x10, 0x02, 0x18, 0x02,
+    0x2A, 0x0F, 0x57, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x20, 0x38, 0x2E, 0x31, 0x20, 0x50, 0x72,
+    0x6F, 0x32, 0x07, 0x50, 0x43, 0x2D, 0x35, 0x22, 0x06, 0x08, 0x02, 0x10, 0x01, 0x18, 0x02, 0x2A,
+    0x1E, 0x57, 0x69, 0x6E, 0x64, 0x6F, 0x77, 0x73, 0x20, 0x53, 0x65, 0x72, 0x76, 0x65, 0x72, 0x20,
+    0x32, 0x30, 0x32, 0x32, 0x20, 0x44, 0x61, 0x74, 0x61, 0x63, 0x65, 0x6E, 0x74, 0x65, 0x72, 0x32
+};
+
+} // namespace
+
+MessageCompressor::MessageCompressor(ScopedZstdCStream cctx,
+                                     ScopedZstdDStream dctx,
+                                     ScopedZstdCDict cdict,
+                                     ScopedZstdDDict ddict)
+    : cctx_(std::move(cctx)),
+      dctx_(std::move(dctx)),
+      cdict_(std::move(cdict)),
+      ddict_(std::move(ddict))
+{
+    // Nothing
+}
+
+MessageCompressor::~MessageCompressor() = default;
+
+// static
+std::unique_ptr<MessageCompressor> MessageCompressor::create(uint32_t dictionary_id)
+{
+    if (dictionary_id && dictionary_id != dictionaryId())
+    {
+        LOG(LS_WARNING) << "Unknown dictionary: " << dictionary_id;
+        return nullptr;
+    }
+
+    ScopedZstdCStream cctx(ZSTD_createCCtx());
+    ScopedZstdDStream dctx(ZSTD_createDCtx());
+    if (!cctx || !dctx)
+    {
+        LOG(LS_WARNING) << "Unable to create compression context";
+        return nullptr;
+    }
+
+    ScopedZstdCDict cdict;
+    ScopedZstdDDict ddict;
+
+    if (dictionary_id)
+    {
+        cdict.reset(ZSTD_createCDict(kDictionary, sizeof(kDictionary), kCompressionLevel));
+        ddict.reset(ZSTD_createDDict(kDictionary, sizeof(kDictionary)));
+        if (!cdict || !ddict)
+        {
+            LOG(LS_WARNING) << "Unable to load dictionary";
+            return nullptr;
+        }
+    }
+
+    return std::unique_ptr<MessageCompressor>(new MessageCompressor(
+        std::move(cctx), std::move(dctx), std::move(cdict), std::move(ddict)));
+}
+
+// static
+uint32_t MessageCompressor::dictionaryId()
+{
+    return ZSTD_getDictID_fromDict(kDictionary, sizeof(kDictionary));
+}
+
+bool MessageCompressor::compress(const uint8_t* data, size_t size, ByteArray* out)
+{
+    DCHECK(out);
+
+    if (size < kMinMessageSize)
+        return false;
+
+    // There is no point in a result that is not smaller than the message.
+    out->resize(size - 1);
+
+    size_t ret;
+    if (cdict_)
+    {
+        ret = ZSTD_compress_usingCDict(
+            cctx_.get(), out->data(), out->size(), data, size, cdict_.get());
+    }
+    else
+    {
+        ret = ZSTD_compressCCtx(
+            cctx_.get(), out->data(), out->size(), data, size, kCompressionLevel);
+    }
+
+    // The error is also returned if the result does not fit into the buffer.
+    if (ZSTD_isError(ret))
+        return false;
+
+    out->resize(ret);
+    return true;
+}
+
+bool MessageCompressor::decompress(
+    const uint8_t* data, size_t size, size_t max_size, ByteArray* out)
+{
+    DCHECK(out);
+
+    const unsigned long long content_size = ZSTD_getFrameContentSize(data, size);
+    if (content_size == ZSTD_CONTENTSIZE_ERROR || content_size == ZSTD_CONTENTSIZE_UNKNOWN ||
+        content_size > max_size)
+    {
+        LOG(LS_ERROR) << "Invalid content size: " << content_size;
+        return false;
+    }
+
+    out->resize(static_cast<size_t>(content_size));
+
+    size_t ret;
+    if (ddict_)
+    {
+        ret = ZSTD_decompress_usingDDict(
+            dctx_.get(), out->data(), out->size(), data, size, ddict_.get());
+    }
+    else
+    {
+        ret = ZSTD_decompressDCtx(dctx_.get(), out->data(), out->size(), data, size);
+    }
+
+    if (ZSTD_isError(ret) || ret != out->size())
+    {
+        LOG(LS_ERROR) << "Decompression failed: "
+                      << (ZSTD_isError(ret) ? ZSTD_getErrorName(ret) : "size mismatch");
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace base
@@ -0,0 +1,73 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+
+#ifndef BASE__NET__MESSAGE_COMPRESSOR_H
+#define BASE__NET__MESSAGE_COMPRESSOR_H
+
+#include "base/macros_magic.h"
+#include "base/codec/scoped_zstd_stream.h"
+#include "base/memory/byte_array.h"
+
+namespace base {
+
+// Compresses separate messages with zstd. Each message is compressed independently, so the
+// messages can be decompressed in any order and a lost message does not affect the others.
+// Messages of the control protocols are small and have much in common, so a dictionary trained on
+// typical messages (host and relay lists, system information, file lists) is used. Both sides
+// must use the same dictionary, its ID is agreed during the key exchange.
+class MessageCompressor
+{
+public:
+    // Creates a compressor. If |dictionary_id| is equal to dictionaryId(), then the built-in
+    // dictionary is used. If it is zero, then messages are compressed without a dictionary.
+    // Returns nullptr for an unknown dictionary.
+    static std::unique_ptr<MessageCompressor> create(uint32_t dictionary_id);
+    ~MessageCompressor();
+
+    // Returns the ID of the built-in dictionary.
+    static uint32_t dictionaryId();
+
+    // Messages smaller than this size are not compressed: the gain does not pay for the time.
+    static constexpr size_t kMinMessageSize = 256;
+
+    // Compresses |size| bytes from |data| to |out|. Returns false if the message is too small or
+    // does not become smaller. The message must then be sent as is.
+    bool compress(const uint8_t* data, size_t size, ByteArray* out);
+
+    // Decompresses |size| bytes from |data| to |out|. Returns false if the data is corrupted or if
+    // the decompressed message is larger than |max_size|.
+    bool decompress(const uint8_t* data, size_t size, size_t max_size, ByteArray* out);
+
+private:
+    MessageCompressor(ScopedZstdCStream cctx,
+                      ScopedZstdDStream dctx,
+                      ScopedZstdCDict cdict,
+                      ScopedZstdDDict ddict);
+
+    ScopedZstdCStream cctx_;
+    ScopedZstdDStream dctx_;
+    ScopedZstdCDict cdict_;
+    ScopedZstdDDict ddict_;
+
+    DISALLOW_COPY_AND_ASSIGN(MessageCompressor);
+};
+
+} // namespace base
+
+#endif // BASE__NET__MESSAGE_COMPRESSOR_H
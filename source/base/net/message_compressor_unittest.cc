@@ -0,0 +1,128 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+
+#include "base/net/message_compressor.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+
+namespace base {
+
+namespace {
+
+// Looks like a list of hosts: the records have the same structure and similar strings.
+ByteArray hostList(int count)
+{
+    std::string text;
+
+    for (int i = 0; i < count; ++i)
+    {
+        text += "DESKTOP-" + std::to_string(1000 + i * 7) + " Windows 10 Pro 10.0.19045 x64 ";
+        text += "192.168.1." + std::to_string(i % 255) + " ";
+    }
+
+    return ByteArray(text.begin(), text.end());
+}
+
+ByteArray randomData(size_t size)
+{
+    std::mt19937 engine(size);
+    std::uniform_int_distribution<int> distribution(0, 255);
+
+    ByteArray data(size);
+    for (auto& byte : data)
+        byte = static_cast<uint8_t>(distribution(engine));
+
+    return data;
+}
+
+} // namespace
+
+TEST(MessageCompressorTest, RoundTrip)
+{
+    for (uint32_t dictionary_id : { 0U, MessageCompressor::dictionaryId() })
+    {
+        std::unique_ptr<MessageCompressor> compressor = MessageCompressor::create(dictionary_id);
+        ASSERT_TRUE(compressor);
+
+        ByteArray message = hostList(50);
+        ByteArray compressed;
+        ASSERT_TRUE(compressor->compress(message.data(), message.size(), &compressed));
+        EXPECT_LT(compressed.size(), message.size() / 2);
+
+        ByteArray decompressed;
+        ASSERT_TRUE(compressor->decompress(
+            compressed.data(), compressed.size(), message.size(), &decompressed));
+        EXPECT_EQ(decompressed, message);
+    }
+}
+
+TEST(MessageCompressorTest, NotCompressed)
+{
+    std::unique_ptr<MessageCompressor> compressor =
+        MessageCompressor::create(MessageCompressor::dictionaryId());
+    ASSERT_TRUE(compressor);
+
+    ByteArray compressed;
+
+    // The message is too small.
+    ByteArray message = hostList(1);
+    ASSERT_LT(message.size(), MessageCompressor::kMinMessageSize);
+    EXPECT_FALSE(compressor->compress(message.data(), message.size(), &compressed));
+
+    // The message does not become smaller.
+    message = randomData(4096);
+    EXPECT_FALSE(compressor->compress(message.data(), message.size(), &compressed));
+}
+
+TEST(MessageCompressorTest, InvalidData)
+{
+    EXPECT_FALSE(MessageCompressor::create(MessageCompressor::dictionaryId() + 1));
+
+    std::unique_ptr<MessageCompressor> compressor =
+        MessageCompressor::create(MessageCompressor::dictionaryId());
+    ASSERT_TRUE(compressor);
+
+    ByteArray message = hostList(50);
+    ByteArray compressed;
+    ASSERT_TRUE(compressor->compress(message.data(), message.size(), &compressed));
+
+    // The decompressed message is larger than allowed.
+    ByteArray decompressed;
+    EXPECT_FALSE(compressor->decompress(
+        compressed.data(), compressed.size(), message.size() - 1, &decompressed));
+
+    // The data is truncated.
+    EXPECT_FALSE(compressor->decompress(
+        compressed.data(), compressed.size() / 2, message.size(), &decompressed));
+
+    // The data is not compressed at all.
+    ByteArray garbage = randomData(256);
+    EXPECT_FALSE(compressor->decompress(
+        garbage.data(), garbage.size(), message.size(), &decompressed));
+
+    // The messages compressed with the dictionary cannot be decompressed without it.
+    std::unique_ptr<MessageCompressor> other = MessageCompressor::create(0);
+    ASSERT_TRUE(other);
+    EXPECT_FALSE(other->decompress(
+        compressed.data(), compressed.size(), message.size(), &decompressed));
+}
+
+} // namespace base
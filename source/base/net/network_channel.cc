@@ -22,26 +22,49 @@
 #include "base/logging.h"
 #include "base/crypto/message_encryptor_fake.h"
 #include "base/crypto/message_decryptor_fake.h"
+#include "base/net/message_compressor.h"
 #include "base/message_loop/message_loop.h"
 #include "base/message_loop/message_pump_asio.h"
 #include "base/net/network_channel_proxy.h"
 #include "base/strings/string_printf.h"
 #include "base/strings/unicode.h"
+#include "build/build_config.h"
 
 #include <asio/connect.hpp>
+#include <asio/post.hpp>
 #include <asio/read.hpp>
 #include <asio/write.hpp>
 
+#include <algorithm>
+
 #if defined(OS_WIN)
 #include <winsock2.h>
 #include <mstcpip.h>
 #endif // defined(OS_WIN)
 
+#if defined(OS_LINUX)
+#include <netinet/tcp.h>
+
+#include <cstddef>
+#endif // defined(OS_LINUX)
+
 namespace base {
 
 namespace {
 
 static const size_t kMaxMessageSize = 16 * 1024 * 1024; // 16 MB
+static const size_t kReadBufferSize = 64 * 1024; // 64 kB
+
+// Maximum size of the receive buffer that is kept after the messages in it are processed. A buffer
+// enlarged for a bigger message is replaced with a smaller one.
+static const size_t kMaxKeptReadBufferSize = 1024 * 1024; // 1 MB
+
+// The last byte of each message when the compressor is set.
+static const uint8_t kMessageStored = 0;
+static const uint8_t kMessageCompressed = 1;
+
+// Maximum total size of the buffers of the sent messages that are kept for reuse.
+static const size_t kMaxFreeBuffersSize = 2 * 1024 * 1024; // 2 MB
 
 int calculateSpeed(int last_speed, const std::chrono::milliseconds& duration, int64_t bytes)
 {
@@ -51,12 +74,28 @@ int calculateSpeed(int last_speed, const std::chrono::milliseconds& duration, in
         ((1.0 - kAlpha) * static_cast<double>(last_speed)));
 }
 
+#if defined(OS_LINUX)
+// The structure from the headers of the C library ends at tcpi_total_retrans. The following fields
+// are filled by the kernel since version 4.6.
+struct TcpInfo
+{
+    struct tcp_info base;
+    uint64_t pacing_rate;
+    uint64_t max_pacing_rate;
+    uint64_t bytes_acked;
+    uint64_t bytes_received;
+    uint32_t segs_out;
+    uint32_t segs_in;
+    uint32_t notsent_bytes;
+    uint32_t min_rtt;
+};
+#endif // defined(OS_LINUX)
+
 } // namespace
 
 NetworkChannel::NetworkChannel()
-    : io_context_(MessageLoop::current()->pumpAsio()->ioContext()),
-      socket_(io_context_),
-      resolver_(std::make_unique<asio::ip::tcp::resolver>(io_context_)),
+    : socket_(MessageLoop::current()->pumpAsio()->ioContext()),
+      resolver_(std::make_unique<asio::ip::tcp::resolver>(socket_.get_executor())),
       proxy_(new NetworkChannelProxy(MessageLoop::current()->taskRunner(), this)),
       encryptor_(std::make_unique<MessageEncryptorFake>()),
       decryptor_(std::make_unique<MessageDecryptorFake>())
@@ -65,8 +104,7 @@ NetworkChannel::NetworkChannel()
 }
 
 NetworkChannel::NetworkChannel(asio::ip::tcp::socket&& socket)
-    : io_context_(MessageLoop::current()->pumpAsio()->ioContext()),
-      socket_(std::move(socket)),
+    : socket_(std::move(socket)),
       proxy_(new NetworkChannelProxy(MessageLoop::current()->taskRunner(), this)),
       encryptor_(std::make_unique<MessageEncryptorFake>()),
       decryptor_(std::make_unique<MessageDecryptorFake>()),
@@ -105,6 +143,11 @@ void NetworkChannel::setDecryptor(std::unique_ptr<MessageDecryptor> decryptor)
     decryptor_ = std::move(decryptor);
 }
 
+void NetworkChannel::setCompressor(std::unique_ptr<MessageCompressor> compressor)
+{
+    compressor_ = std::move(compressor);
+}
+
 std::u16string NetworkChannel::peerAddress() const
 {
     if (!socket_.is_open())
@@ -169,25 +212,144 @@ void NetworkChannel::resume()
     paused_ = false;
 
     // We already have an incomplete read operation.
-    if (state_ == ReadState::READ_SIZE || state_ == ReadState::READ_CONTENT)
+    if (state_ == ReadState::READ)
         return;
 
-    // If we have a message that was received before the pause command.
-    if (state_ == ReadState::PENDING)
-        onMessageReceived();
-
-    doReadSize();
+    // Notify about the messages that were received before the pause command and continue reading.
+    onReadBuffer();
 }
 
-void NetworkChannel::send(ByteArray&& buffer)
+void NetworkChannel::send(ByteArray&& buffer, Priority priority)
 {
-    const bool schedule_write = write_queue_.empty();
+    pending_bytes_ += buffer.size();
 
     // Add the buffer to the queue for sending.
-    write_queue_.emplace(std::move(buffer));
+    write_queue_.push(std::move(buffer), priority);
 
-    if (schedule_write)
+    // If the write is in progress, then the message is sent after it is completed.
+    if (write_batch_.empty())
         doWrite();
+
+    if (write_high_watermark_ && pending_bytes_ >= write_high_watermark_)
+        setWritable(false);
+}
+
+void NetworkChannel::send(const google::protobuf::MessageLite& message, Priority priority)
+{
+    const size_t size = message.ByteSizeLong();
+    ByteArray buffer;
+
+    auto capacity_less = [](const ByteArray& first, const ByteArray& second)
+    {
+        return first.capacity() < second.capacity();
+    };
+
+    // Take the smallest of the free buffers that can hold the message and the byte of the flag
+    // added when the message is sent. If there is no such buffer, then the largest one is taken and
+    // grows.
+    auto best = free_buffers_.end();
+    for (auto it = free_buffers_.begin(); it != free_buffers_.end(); ++it)
+    {
+        if (it->capacity() > size && (best == free_buffers_.end() || capacity_less(*it, *best)))
+            best = it;
+    }
+
+    if (best == free_buffers_.end())
+        best = std::max_element(free_buffers_.begin(), free_buffers_.end(), capacity_less);
+
+    if (best != free_buffers_.end())
+    {
+        free_buffers_size_ -= best->capacity();
+        buffer = std::move(*best);
+        std::swap(*best, free_buffers_.back());
+        free_buffers_.pop_back();
+    }
+
+    serialize(message, &buffer);
+    send(std::move(buffer), priority);
+}
+
+void NetworkChannel::setWriteWatermarks(size_t low, size_t high)
+{
+    DCHECK_LE(low, high);
+
+    write_low_watermark_ = low;
+    write_high_watermark_ = high;
+
+    if (!write_high_watermark_ || pending_bytes_ <= write_low_watermark_)
+        setWritable(true);
+    else if (pending_bytes_ >= write_high_watermark_)
+        setWritable(false);
+}
+
+bool NetworkChannel::detach(std::function<void()> callback)
+{
+    if (!paused_ || !write_batch_.empty() || !write_queue_.empty())
+    {
+        LOG(LS_ERROR) << "Channel cannot be detached (paused: " << paused_
+                      << ", messages to send: " << write_batch_.size() + write_queue_.size() << ")";
+        return false;
+    }
+
+    if (state_ == ReadState::READ)
+    {
+        // The channel is paused, so the read operation is waiting for data from the socket. The
+        // cancelled operation completes without touching the channel. If the data has already
+        // been received, then its handler is queued before the callback and the data stays in the
+        // buffer until the channel is resumed on the new thread.
+        std::error_code ignored_code;
+        socket_.cancel(ignored_code);
+        state_ = ReadState::IDLE;
+    }
+
+    asio::post(socket_.get_executor(), std::move(callback));
+    return true;
+}
+
+bool NetworkChannel::attach()
+{
+    if (!paused_ || !write_batch_.empty() || !write_queue_.empty() || state_ != ReadState::IDLE)
+    {
+        LOG(LS_ERROR) << "Channel cannot be attached (paused: " << paused_
+                      << ", messages to send: " << write_batch_.size() + write_queue_.size()
+                      << ", reading: " << (state_ != ReadState::IDLE) << ")";
+        return false;
+    }
+
+    std::error_code error_code;
+
+    asio::ip::tcp::endpoint endpoint = socket_.local_endpoint(error_code);
+    if (error_code)
+    {
+        LOG(LS_WARNING) << "Unable to get local endpoint: "
+                        << utf16FromLocal8Bit(error_code.message());
+        return false;
+    }
+
+    asio::ip::tcp::socket::native_handle_type native_handle = socket_.release(error_code);
+    if (error_code)
+    {
+        LOG(LS_WARNING) << "Unable to release socket: " << utf16FromLocal8Bit(error_code.message());
+        return false;
+    }
+
+    asio::ip::tcp::socket socket(MessageLoop::current()->pumpAsio()->ioContext());
+    socket.assign(endpoint.protocol(), native_handle, error_code);
+    if (error_code)
+    {
+        LOG(LS_WARNING) << "Unable to assign socket: " << utf16FromLocal8Bit(error_code.message());
+
+        // Return the handle to the original socket so that it is closed correctly.
+        socket_.assign(endpoint.protocol(), native_handle, error_code);
+        return false;
+    }
+
+    socket_ = std::move(socket);
+
+    // Messages sent through the proxy are now delivered to the current thread.
+    proxy_->willDestroyCurrentChannel();
+    proxy_.reset(new NetworkChannelProxy(MessageLoop::current()->taskRunner(), this));
+    return true;
 }
 
 bool NetworkChannel::setNoDelay(bool enable)
@@ -211,27 +373,7 @@ bool NetworkChannel::setKeepAlive(bool enable,
                                   const std::chrono::milliseconds& time,
                                   const std::chrono::milliseconds& interval)
 {
-#if defined(OS_WIN)
-    struct tcp_keepalive alive;
-
-    alive.onoff = enable ? TRUE : FALSE;
-    alive.keepalivetime = static_cast<ULONG>(time.count());
-    alive.keepaliveinterval = static_cast<ULONG>(interval.count());
-
-    DWORD bytes_returned;
-
-    if (WSAIoctl(socket_.native_handle(), SIO_KEEPALIVE_VALS,
-                 &alive, sizeof(alive), nullptr, 0, &bytes_returned,
-                 nullptr, nullptr) == SOCKET_ERROR)
-    {
-        PLOG(LS_WARNING) << "WSAIoctl failed";
-        return false;
-    }
-#else
-    #warning Not implemented
-#endif
-
-    return true;
+    return setSocketKeepAlive(&socket_, enable, time, interval);
 }
 
 bool NetworkChannel::setReadBufferSize(size_t size)
@@ -268,6 +410,17 @@ bool NetworkChannel::setWriteBufferSize(size_t size)
     return true;
 }
 
+bool NetworkChannel::setSocketProfile(const SocketProfile& profile)
+{
+    quick_ack_ = profile.quick_ack;
+    return applySocketProfile(&socket_, profile);
+}
+
+void NetworkChannel::setWriteBatchSize(size_t size)
+{
+    write_batch_size_ = size;
+}
+
 int NetworkChannel::speedRx()
 {
     TimePoint current_time = Clock::now();
@@ -405,65 +558,215 @@ void NetworkChannel::onMessageWritten()
         listener_->onMessageWritten(write_queue_.size());
 }
 
-void NetworkChannel::onMessageReceived()
+void NetworkChannel::setWritable(bool writable)
+{
+    if (writable_ == writable)
+        return;
+
+    writable_ = writable;
+
+    if (listener_)
+        listener_->onWritableChanged(writable);
+}
+
+void NetworkChannel::releaseBuffer(ByteArray&& buffer)
+{
+    if (free_buffers_size_ + buffer.capacity() > kMaxFreeBuffersSize)
+        return;
+
+    free_buffers_size_ += buffer.capacity();
+    free_buffers_.emplace_back(std::move(buffer));
+}
+
+void NetworkChannel::sampleLink()
+{
+    LinkEstimator::Sample sample;
+    sample.time = LinkEstimator::Clock::now();
+
+    if (sample.time - link_sample_time_ < kLinkSampleInterval)
+        return;
+
+    link_sample_time_ = sample.time;
+    sample.bytes_queued = static_cast<int64_t>(pending_bytes_);
+
+#if defined(OS_LINUX)
+    TcpInfo info;
+    memset(&info, 0, sizeof(info));
+    socklen_t length = sizeof(info);
+
+    if (getsockopt(socket_.native_handle(), IPPROTO_TCP, TCP_INFO, &info, &length) != 0)
+        return;
+
+    // Older kernels do not report the number of acknowledged and not sent bytes.
+    if (length < offsetof(TcpInfo, notsent_bytes) + sizeof(info.notsent_bytes))
+        return;
+
+    sample.rtt = std::chrono::microseconds(info.base.tcpi_rtt);
+    sample.bytes_acked = static_cast<int64_t>(info.bytes_acked);
+    sample.bytes_queued += info.notsent_bytes;
+#elif defined(OS_WIN) && defined(SIO_TCP_INFO)
+    TCP_INFO_v0 info;
+    DWORD version = 0;
+    DWORD bytes_returned;
+
+    // Supported since Windows 10 1703.
+    if (WSAIoctl(socket_.native_handle(), SIO_TCP_INFO,
+                 &version, sizeof(version), &info, sizeof(info), &bytes_returned,
+                 nullptr, nullptr) == SOCKET_ERROR)
+    {
+        return;
+    }
+
+    sample.rtt = std::chrono::microseconds(info.RttUs);
+    sample.bytes_acked = static_cast<int64_t>(info.BytesOut) - info.BytesInFlight;
+#else
+    // The statistics of the TCP stack are not available. The data passed to the socket is
+    // considered delivered.
+    sample.bytes_acked = total_tx_;
+#endif
+
+    link_estimator_.addSample(sample);
+
+    if (listener_)
+        listener_->onLinkEstimateUpdated(link_estimator_);
+}
+
+void NetworkChannel::onMessageReceived(const uint8_t* data, size_t size)
 {
-    const size_t decrypt_buffer_size = decryptor_->decryptedDataSize(read_buffer_.size());
+    const size_t decrypt_buffer_size = decryptor_->decryptedDataSize(size);
 
     if (decrypt_buffer_.capacity() < decrypt_buffer_size)
         decrypt_buffer_.reserve(decrypt_buffer_size);
 
     decrypt_buffer_.resize(decrypt_buffer_size);
 
-    if (!decryptor_->decrypt(read_buffer_.data(), read_buffer_.size(), decrypt_buffer_.data()))
+    if (!decryptor_->decrypt(data, size, decrypt_buffer_.data()))
     {
         onErrorOccurred(FROM_HERE, asio::error::access_denied);
         return;
     }
 
+    if (compressor_)
+    {
+        if (decrypt_buffer_.empty())
+        {
+            onErrorOccurred(FROM_HERE, asio::error::message_size);
+            return;
+        }
+
+        const uint8_t flag = decrypt_buffer_.back();
+        decrypt_buffer_.pop_back();
+
+        if (flag == kMessageCompressed)
+        {
+            if (!compressor_->decompress(decrypt_buffer_.data(), decrypt_buffer_.size(),
+                                         kMaxMessageSize, &decompress_buffer_))
+            {
+                onErrorOccurred(FROM_HERE, asio::error::message_size);
+                return;
+            }
+
+            if (listener_)
+                listener_->onMessageReceived(decompress_buffer_);
+            return;
+        }
+
+        if (flag != kMessageStored)
+        {
+            onErrorOccurred(FROM_HERE, asio::error::message_size);
+            return;
+        }
+    }
+
     if (listener_)
         listener_->onMessageReceived(decrypt_buffer_);
 }
 
 void NetworkChannel::doWrite()
 {
-    const ByteArray& source_buffer = write_queue_.front();
-    if (source_buffer.empty())
-    {
-        onErrorOccurred(FROM_HERE, asio::error::message_size);
-        return;
-    }
+    DCHECK(!write_queue_.empty());
+    DCHECK(write_batch_.empty());
 
-    // Calculate the size of the encrypted message.
-    const size_t target_data_size = encryptor_->encryptedDataSize(source_buffer.size());
+    write_buffer_.clear();
 
-    if (target_data_size > kMaxMessageSize)
+    // Encrypt the messages from the front of the queue into one buffer. The first message is
+    // always added, the following ones only while the buffer fits into the batch size.
+    while (!write_queue_.empty())
     {
-        onErrorOccurred(FROM_HERE, asio::error::message_size);
-        return;
-    }
+        ByteArray& source_buffer = write_queue_.front();
+        if (source_buffer.empty())
+        {
+            onErrorOccurred(FROM_HERE, asio::error::message_size);
+            return;
+        }
+
+        // Calculate the size of the encrypted message. If the message is compressed, then the
+        // size is smaller, so the checks below are also valid for it.
+        const size_t source_size = source_buffer.size() + (compressor_ ? 1 : 0);
+        size_t target_data_size = encryptor_->encryptedDataSize(source_size);
 
-    asio::const_buffer variable_size = variable_size_writer_.variableSize(target_data_size);
+        if (target_data_size > kMaxMessageSize)
+        {
+            onErrorOccurred(FROM_HERE, asio::error::message_size);
+            return;
+        }
 
-    // Now we can calculate the full size.
-    const size_t total_size = variable_size.size() + target_data_size;
+        asio::const_buffer variable_size = variable_size_writer_.variableSize(target_data_size);
 
-    // If the reserved buffer size is less, then increase it.
-    if (write_buffer_.capacity() < total_size)
-        write_buffer_.reserve(total_size);
+        // Now we can calculate the full size.
+        size_t total_size = variable_size.size() + target_data_size;
+        const size_t offset = write_buffer_.size();
 
-    // Change the size of the buffer.
-    write_buffer_.resize(total_size);
+        if (!write_batch_.empty() && offset + total_size > write_batch_size_)
+            break;
 
-    // Copy the size of the message to the buffer.
-    memcpy(write_buffer_.data(), variable_size.data(), variable_size.size());
+        const ByteArray* message = &source_buffer;
 
-    // Encrypt the message.
-    if (!encryptor_->encrypt(source_buffer.data(),
-                             source_buffer.size(),
-                             write_buffer_.data() + variable_size.size()))
-    {
-        onErrorOccurred(FROM_HERE, asio::error::access_denied);
-        return;
+        if (compressor_)
+        {
+            if (write_queue_.frontPriority() == Priority::CONTROL &&
+                compressor_->compress(source_buffer.data(), source_buffer.size(),
+                                      &compress_buffer_))
+            {
+                compress_buffer_.push_back(kMessageCompressed);
+                message = &compress_buffer_;
+
+                target_data_size = encryptor_->encryptedDataSize(compress_buffer_.size());
+                variable_size = variable_size_writer_.variableSize(target_data_size);
+                total_size = variable_size.size() + target_data_size;
+            }
+            else
+            {
+                // The byte is removed after encryption. Serialized messages have a spare byte of
+                // capacity (see base::serialize()), so the message is not copied.
+                source_buffer.push_back(kMessageStored);
+            }
+        }
+
+        // If the reserved buffer size is less, then increase it.
+        if (write_buffer_.capacity() < offset + total_size)
+            write_buffer_.reserve(std::max(offset + total_size, write_buffer_.capacity() * 2));
+
+        // Change the size of the buffer.
+        write_buffer_.resize(offset + total_size);
+
+        // Copy the size of the message to the buffer.
+        memcpy(write_buffer_.data() + offset, variable_size.data(), variable_size.size());
+
+        // Encrypt the message.
+        const bool encrypted = encryptor_->encrypt(
+            message->data(), message->size(), write_buffer_.data() + offset + variable_size.size());
+
+        if (message == &source_buffer && compressor_)
+            source_buffer.pop_back();
+
+        if (!encrypted)
+        {
+            onErrorOccurred(FROM_HERE, asio::error::access_denied);
+            return;
+        }
+
+        write_batch_.emplace_back(write_queue_.pop());
     }
 
     // Send the buffer to the recipient.
@@ -483,36 +786,55 @@ void NetworkChannel::onWrite(const std::error_code& error_code, size_t bytes_tra
         return;
     }
 
-    DCHECK(!write_queue_.empty());
+    DCHECK(!write_batch_.empty());
 
     // Update TX statistics.
     bytes_tx_ += bytes_transferred;
     total_tx_ += bytes_transferred;
 
-    // Delete the sent message from the queue.
-    write_queue_.pop();
+    // The listener is notified about each message. Messages sent from the notifications are only
+    // added to the queue, because the write is not completed yet. This way they are encrypted
+    // after the listener has processed the notification (e.g. changed the encryptor).
+    const size_t written_count = write_batch_.size();
+    for (size_t i = 0; i < written_count; ++i)
+        onMessageWritten();
 
-    // If the queue is not empty, then we send the following message.
-    bool schedule_write = !write_queue_.empty() || proxy_->reloadWriteQueue(&write_queue_);
+    // The buffers of the sent messages are kept for the next messages.
+    for (ByteArray& buffer : write_batch_)
+    {
+        DCHECK_GE(pending_bytes_, buffer.size());
+        pending_bytes_ -= buffer.size();
 
-    onMessageWritten();
+        releaseBuffer(std::move(buffer));
+    }
+    write_batch_.clear();
 
-    if (schedule_write)
+    // If the queue is not empty, then we send the following messages.
+    if (!write_queue_.empty())
         doWrite();
+
+    if (pending_bytes_ <= write_low_watermark_)
+        setWritable(true);
+
+    sampleLink();
 }
 
-void NetworkChannel::doReadSize()
+void NetworkChannel::doRead()
 {
-    state_ = ReadState::READ_SIZE;
-    asio::async_read(socket_,
-                     variable_size_reader_.buffer(),
-                     std::bind(&NetworkChannel::onReadSize,
-                               this,
-                               std::placeholders::_1,
-                               std::placeholders::_2));
+    DCHECK_LT(read_end_, read_buffer_.size());
+
+    state_ = ReadState::READ;
+
+    // Read as much as is available, so that several small messages are received at once.
+    socket_.async_read_some(asio::buffer(read_buffer_.data() + read_end_,
+                                         read_buffer_.size() - read_end_),
+                            std::bind(&NetworkChannel::onRead,
+                                      this,
+                                      std::placeholders::_1,
+                                      std::placeholders::_2));
 }
 
-void NetworkChannel::onReadSize(const std::error_code& error_code, size_t bytes_transferred)
+void NetworkChannel::onRead(const std::error_code& error_code, size_t bytes_transferred)
 {
     if (error_code)
     {
@@ -520,67 +842,90 @@ void NetworkChannel::onReadSize(const std::error_code& error_code, size_t bytes_
         return;
     }
 
+    // Update RX statistics.
     bytes_rx_ += bytes_transferred;
+    total_rx_ += bytes_transferred;
+
+    read_end_ += bytes_transferred;
+    DCHECK_LE(read_end_, read_buffer_.size());
+
+    if (quick_ack_)
+        enableSocketQuickAck(&socket_);
 
-    std::optional<size_t> size = variable_size_reader_.messageSize();
-    if (size.has_value())
+    onReadBuffer();
+}
+
+void NetworkChannel::onReadBuffer()
+{
+    state_ = ReadState::READ;
+
+    // The number of bytes the buffer must hold to receive the incomplete message.
+    size_t required_size = 0;
+
+    // Notify about all complete messages in the buffer.
+    while (connected_ && !paused_)
     {
-        size_t message_size = size.value();
+        const uint8_t* data = read_buffer_.data() + read_begin_;
+        const size_t size = read_end_ - read_begin_;
 
-        if (!message_size || message_size > kMaxMessageSize)
+        size_t length = 0;
+        std::optional<size_t> message_size = VariableSizeReader::messageSize(data, size, &length);
+        if (!message_size.has_value())
+        {
+            required_size = size + 1;
+            break;
+        }
+
+        if (!message_size.value() || message_size.value() > kMaxMessageSize)
         {
             onErrorOccurred(FROM_HERE, asio::error::message_size);
             return;
         }
 
-        if (read_buffer_.capacity() < message_size)
-            read_buffer_.reserve(message_size);
-
-        read_buffer_.resize(message_size);
+        if (size < length + message_size.value())
+        {
+            required_size = length + message_size.value();
+            break;
+        }
 
-        state_ = ReadState::READ_CONTENT;
-        asio::async_read(socket_,
-                         asio::buffer(read_buffer_.data(), read_buffer_.size()),
-                         std::bind(&NetworkChannel::onReadContent,
-                                   this,
-                                   std::placeholders::_1,
-                                   std::placeholders::_2));
-    }
-    else
-    {
-        doReadSize();
+        read_begin_ += length + message_size.value();
+        onMessageReceived(data + length, message_size.value());
     }
-}
 
-void NetworkChannel::onReadContent(const std::error_code& error_code, size_t bytes_transferred)
-{
-    if (error_code)
-    {
-        onErrorOccurred(FROM_HERE, error_code);
+    if (!connected_)
         return;
-    }
-
-    // Update RX statistics.
-    bytes_rx_ += bytes_transferred;
-    total_rx_ += bytes_transferred;
-
-    DCHECK_EQ(bytes_transferred, read_buffer_.size());
 
     if (paused_)
     {
-        state_ = ReadState::PENDING;
+        // The remaining messages are delivered after calling resume().
+        state_ = ReadState::IDLE;
         return;
     }
 
-    onMessageReceived();
+    const size_t pending_size = read_end_ - read_begin_;
+    const size_t buffer_size = std::max(required_size, kReadBufferSize);
 
-    if (paused_)
+    if (read_buffer_.size() > kMaxKeptReadBufferSize && read_buffer_.size() > buffer_size)
     {
-        state_ = ReadState::IDLE;
-        return;
+        // The buffer was enlarged for a big message. It is not held until the channel is closed.
+        ByteArray buffer(buffer_size);
+        memcpy(buffer.data(), read_buffer_.data() + read_begin_, pending_size);
+        read_buffer_ = std::move(buffer);
     }
+    else if (read_begin_ && pending_size)
+    {
+        // Move the incomplete message to the beginning of the buffer. Each byte is moved at most
+        // once, because new data is always appended after it.
+        memmove(read_buffer_.data(), read_buffer_.data() + read_begin_, pending_size);
+    }
+
+    read_begin_ = 0;
+    read_end_ = pending_size;
+
+    if (read_buffer_.size() < buffer_size)
+        read_buffer_.resize(buffer_size);
 
-    doReadSize();
+    doRead();
 }
 
 } // namespace base
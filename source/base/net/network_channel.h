@@ -20,16 +20,21 @@
 #define BASE__NET__NETWORK_CHANNEL_H
 
 #include "base/memory/byte_array.h"
+#include "base/net/link_estimator.h"
+#include "base/net/socket_profile.h"
 #include "base/net/variable_size.h"
+#include "base/net/write_queue.h"
 
 #include <asio/ip/tcp.hpp>
 
-#include <queue>
+#include <functional>
+#include <vector>
 
 namespace base {
 
 class NetworkChannelProxy;
 class Location;
+class MessageCompressor;
 class MessageEncryptor;
 class MessageDecryptor;
 class NetworkServer;
@@ -83,8 +88,19 @@ public:
         virtual void onDisconnected(ErrorCode error_code) = 0;
         virtual void onMessageReceived(const ByteArray& buffer) = 0;
         virtual void onMessageWritten(size_t pending) = 0;
+
+        // Called when the number of bytes waiting to be sent reaches the high watermark
+        // (|writable| is false) and when it drops to the low watermark (|writable| is true).
+        // See setWriteWatermarks().
+        virtual void onWritableChanged(bool /* writable */) {}
+
+        // Called when the estimate of the network path is updated. This happens periodically
+        // while messages are being sent. See linkEstimator().
+        virtual void onLinkEstimateUpdated(const LinkEstimator& /* estimator */) {}
     };
 
+    using Priority = WriteQueue::Priority;
+
     std::shared_ptr<NetworkChannelProxy> channelProxy();
 
     // Sets an instance of the class to receive connection status notifications or new messages.
@@ -97,6 +113,13 @@ public:
     void setEncryptor(std::unique_ptr<MessageEncryptor> encryptor);
     void setDecryptor(std::unique_ptr<MessageDecryptor> decryptor);
 
+    // Sets an instance of a class to compress messages before encryption. After that, a byte that
+    // tells whether the message is compressed is added to each message, so both sides must set it
+    // at the same point of the protocol (e.g. together with the encryptor). Only the messages with
+    // the CONTROL priority are compressed: the other ones are either compressed already (video,
+    // cursor) or large (files). By default, messages are not compressed.
+    void setCompressor(std::unique_ptr<MessageCompressor> compressor);
+
     // Gets the address of the remote host as a string.
     std::u16string peerAddress() const;
 
@@ -119,8 +142,41 @@ public:
     void resume();
 
     // Sending a message. The method call is thread safe. After the call, the message will be added
-    // to the queue to be sent.
-    void send(ByteArray&& buffer);
+    // to the queue to be sent. Messages waiting in the queue are sent in the order of |priority|.
+    // The message being written at the moment is not interrupted.
+    void send(ByteArray&& buffer, Priority priority = Priority::CONTROL);
+
+    // Serializes the message and adds it to the queue to be sent. Unlike the previous method, it
+    // must be called on the thread of the channel. The message is serialized into one of the
+    // buffers left after sending the previous messages, so in a steady state sending does not
+    // allocate memory.
+    void send(const google::protobuf::MessageLite& message,
+              Priority priority = Priority::CONTROL);
+
+    // Sets the limits for the number of bytes waiting to be sent. When it reaches |high|, the
+    // channel becomes not writable until it drops to |low|. The channel does not refuse messages
+    // when it is not writable, the senders are expected to slow down themselves. If |high| is 0
+    // (by default), then the channel is always writable.
+    void setWriteWatermarks(size_t low, size_t high);
+
+    // Returns false if the number of bytes waiting to be sent has reached the high watermark.
+    bool isWritable() const { return writable_; }
+
+    // Returns the number of bytes of the messages in the queue and of the messages being written.
+    size_t pendingBytes() const { return pending_bytes_; }
+
+    // Prepares the channel to be moved to another thread. The channel must be paused and must not
+    // have messages waiting to be sent. The read operation in progress is cancelled and |callback|
+    // is called later on the current thread. After that, the channel can be passed to another
+    // thread, which must call attach() before using it. The data received before the cancellation
+    // is not lost. Returns false (and |callback| is not called) if the channel is not paused or
+    // has messages to send. In this case the channel cannot be moved and must be deleted.
+    bool detach(std::function<void()> callback);
+
+    // Binds the channel to the message loop of the current thread. The channel must be paused and
+    // must not have reads or writes in progress. Returns false if the channel is not in this state
+    // or the socket cannot be moved (on Windows it is supported since Windows 8.1).
+    bool attach();
 
     // Disable or enable the algorithm of Nagle.
     bool setNoDelay(bool enable);
@@ -139,15 +195,33 @@ public:
     bool setReadBufferSize(size_t size);
     bool setWriteBufferSize(size_t size);
 
+    // Applies the socket options of |profile| (see SocketProfile). If TCP_QUICKACK is enabled in
+    // the profile, then it is enabled again after each read.
+    bool setSocketProfile(const SocketProfile& profile);
+
+    // Sets the maximum number of bytes sent by one write operation. Messages waiting in the queue
+    // are encrypted one after another into a single buffer until the limit is reached, so a burst
+    // of small messages is sent with one system call. A message larger than the limit is always
+    // sent on its own. If |size| is 0, then each message is sent separately.
+    void setWriteBatchSize(size_t size);
+
     int64_t totalRx() const { return total_rx_; }
     int64_t totalTx() const { return total_tx_; }
     int speedRx();
     int speedTx();
 
+    // Returns the estimate of the round-trip time, the delivery rate and the queue delay. The
+    // estimate is based on the statistics of the TCP stack, which are sampled after writes, at most
+    // once in kLinkSampleInterval.
+    const LinkEstimator& linkEstimator() const { return link_estimator_; }
+
     // Converts an error code to a human readable string.
     // Does not support localization. Used for logs.
     static std::string errorToString(ErrorCode error_code);
 
+    static constexpr size_t kDefaultWriteBatchSize = 64 * 1024;
+    static constexpr std::chrono::milliseconds kLinkSampleInterval { 100 };
+
 protected:
     friend class NetworkServer;
 
@@ -163,17 +237,19 @@ private:
 
     void onErrorOccurred(const Location& location, const std::error_code& error_code);
     void onMessageWritten();
-    void onMessageReceived();
+    void setWritable(bool writable);
+    void releaseBuffer(ByteArray&& buffer);
+    void sampleLink();
+    void onMessageReceived(const uint8_t* data, size_t size);
 
     void doWrite();
     void onWrite(const std::error_code& error_code, size_t bytes_transferred);
 
-    void doReadSize();
-    void onReadSize(const std::error_code& error_code, size_t bytes_transferred);
-    void onReadContent(const std::error_code& error_code, size_t bytes_transferred);
+    void doRead();
+    void onRead(const std::error_code& error_code, size_t bytes_transferred);
+    void onReadBuffer();
 
     std::shared_ptr<NetworkChannelProxy> proxy_;
-    asio::io_context& io_context_;
     asio::ip::tcp::socket socket_;
     std::unique_ptr<asio::ip::tcp::resolver> resolver_;
 
@@ -181,24 +257,46 @@ private:
     bool connected_ = false;
     bool paused_ = true;
 
+    std::unique_ptr<MessageCompressor> compressor_;
+    ByteArray compress_buffer_;
+    ByteArray decompress_buffer_;
+
     std::unique_ptr<MessageEncryptor> encryptor_;
     std::unique_ptr<MessageDecryptor> decryptor_;
 
-    std::queue<ByteArray> write_queue_;
+    WriteQueue write_queue_;
     VariableSizeWriter variable_size_writer_;
     ByteArray write_buffer_;
 
+    // Messages that are being written. If the list is not empty, then the write is in progress.
+    std::vector<ByteArray> write_batch_;
+    size_t write_batch_size_ = kDefaultWriteBatchSize;
+
+    size_t pending_bytes_ = 0;
+    size_t write_low_watermark_ = 0;
+    size_t write_high_watermark_ = 0;
+    bool writable_ = true;
+
+    // Buffers of the sent messages that are reused by send().
+    std::vector<ByteArray> free_buffers_;
+    size_t free_buffers_size_ = 0;
+
     enum class ReadState
     {
-        IDLE,         // No reads are in progress right now.
-        READ_SIZE,    // Reading the message size.
-        READ_CONTENT, // Reading the contents of the message.
-        PENDING       // There is a message about which we did not notify.
+        IDLE, // No reads are in progress right now.
+        READ  // Reading from the socket or notifying about the received messages.
     };
 
     ReadState state_ = ReadState::IDLE;
-    VariableSizeReader variable_size_reader_;
+    bool quick_ack_ = false;
+
+    // Data received from the socket. Bytes from |read_begin_| to |read_end_| are not processed
+    // yet: these are complete messages about which we did not notify because of a pause, and the
+    // beginning of a message that is not fully received.
     ByteArray read_buffer_;
+    size_t read_begin_ = 0;
+    size_t read_end_ = 0;
+
     ByteArray decrypt_buffer_;
 
     using Clock = std::chrono::high_resolution_clock;
@@ -215,6 +313,9 @@ private:
     int64_t bytes_rx_ = 0;
     int speed_rx_ = 0;
 
+    LinkEstimator link_estimator_;
+    LinkEstimator::TimePoint link_sample_time_;
+
     DISALLOW_COPY_AND_ASSIGN(NetworkChannel);
 };
 
@@ -0,0 +1,530 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+
+// Benchmark of the full path of a message through NetworkChannel: serialization, framing,
+// encryption, writing to a loopback socket, reading, decryption and notification of the listener.
+// Both channels work on the same thread, so the result does not depend on the scheduler and shows
+// the total cost of sending and receiving a message.
+//
+// Switches (all are optional, lists are separated by commas):
+//   --cipher=none,aes256gcm,chacha20poly1305  Encryption of messages.
+//   --size=64,1024,16384,262144                Size of a message in bytes.
+//   --depth=1,16                               Number of messages sent but not yet received.
+//   --batch=0                                  Write batch size (see setWriteBatchSize()).
+//   --compression                              Compress messages (see setCompressor()).
+//   --text                                     Send compressible text instead of random data.
+//   --time=1000                                Duration of each run in milliseconds.
+
+#include "base/logging.h"
+#include "base/command_line.h"
+#include "base/crypto/message_decryptor_openssl.h"
+#include "base/crypto/message_encryptor_openssl.h"
+#include "base/crypto/random.h"
+#include "base/crypto/scoped_crypto_initializer.h"
+#include "base/message_loop/message_loop.h"
+#include "base/net/message_compressor.h"
+#include "base/net/network_channel.h"
+#include "base/net/network_server.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_printf.h"
+#include "base/strings/string_split.h"
+#include "base/strings/unicode.h"
+#include "proto/file_transfer.pb.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <new>
+
+namespace {
+
+// The number of memory allocations in the process.
+std::atomic<int64_t> g_allocations { 0 };
+
+} // namespace
+
+void* operator new(size_t size)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+
+    void* ptr = malloc(size ? size : 1);
+    if (!ptr)
+        throw std::bad_alloc();
+
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t /* size */) noexcept
+{
+    free(ptr);
+}
+
+namespace base {
+
+namespace {
+
+enum class Cipher
+{
+    NONE,
+    AES256_GCM,
+    CHACHA20_POLY1305
+};
+
+const char* cipherToString(Cipher cipher)
+{
+    switch (cipher)
+    {
+        case Cipher::AES256_GCM:
+            return "aes256gcm";
+
+        case Cipher::CHACHA20_POLY1305:
+            return "chacha20poly1305";
+
+        default:
+            return "none";
+    }
+}
+
+struct Config
+{
+    Cipher cipher = Cipher::NONE;
+    size_t message_size = 0;
+    size_t depth = 1;
+    size_t batch_size = 0;
+    bool compression = false;
+    bool text = false;
+    std::chrono::milliseconds duration { 1000 };
+};
+
+struct Result
+{
+    double messages_per_second = 0;
+    double megabytes_per_second = 0;
+    std::chrono::microseconds p50 { 0 };
+    std::chrono::microseconds p99 { 0 };
+    double allocations_per_message = 0;
+};
+
+const size_t kKeySize = 32;
+const size_t kIvSize = 12;
+
+// Messages sent before the measurement starts. Buffers of the channels and the socket grow during
+// this time.
+const std::chrono::milliseconds kWarmUpTime { 200 };
+
+// Maximum number of latency samples. The memory is allocated before the measurement.
+const size_t kMaxSamples = 4 * 1024 * 1024;
+
+class Benchmark
+    : public NetworkServer::Delegate,
+      public NetworkChannel::Listener
+{
+public:
+    explicit Benchmark(const Config& config);
+    ~Benchmark() override;
+
+    bool start();
+    const Result& result() const { return result_; }
+
+protected:
+    // NetworkServer::Delegate implementation.
+    void onNewConnection(std::unique_ptr<NetworkChannel> channel) override;
+
+    // NetworkChannel::Listener implementation.
+    void onConnected() override;
+    void onDisconnected(NetworkChannel::ErrorCode error_code) override;
+    void onMessageReceived(const ByteArray& buffer) override;
+    void onMessageWritten(size_t pending) override;
+
+private:
+    bool setCipher(NetworkChannel* encrypt_channel, NetworkChannel* decrypt_channel);
+    void sendMessage();
+    void startMeasurement();
+    void finish();
+
+    using Clock = std::chrono::steady_clock;
+
+    const Config config_;
+
+    ByteArray key_;
+    ByteArray client_iv_;
+    ByteArray server_iv_;
+
+    NetworkServer server_;
+    std::unique_ptr<NetworkChannel> client_;
+    std::unique_ptr<NetworkChannel> server_channel_;
+    bool client_connected_ = false;
+
+    proto::FilePacket message_;
+
+    // Time of sending of the messages that are not received yet. Messages are received in the
+    // order in which they are sent.
+    std::deque<Clock::time_point> send_time_;
+    std::vector<int64_t> latency_;
+
+    bool measuring_ = false;
+    bool stopping_ = false;
+    Clock::time_point start_time_;
+    Clock::time_point measure_time_;
+    int64_t measure_allocations_ = 0;
+    int64_t received_ = 0;
+
+    Result result_;
+
+    DISALLOW_COPY_AND_ASSIGN(Benchmark);
+};
+
+Benchmark::Benchmark(const Config& config)
+    : config_(config),
+      key_(Random::byteArray(kKeySize)),
+      client_iv_(Random::byteArray(kIvSize)),
+      server_iv_(Random::byteArray(kIvSize))
+{
+    std::string data;
+
+    if (config_.text)
+    {
+        // Looks like a list of hosts.
+        for (int i = 0; data.size() < config_.message_size; ++i)
+            data += stringPrintf("DESKTOP-%04d Windows 10 Pro 192.168.1.%d ", i, i % 255);
+        data.resize(config_.message_size);
+    }
+    else
+    {
+        ByteArray random = Random::byteArray(config_.message_size);
+        data.assign(random.begin(), random.end());
+    }
+
+    message_.set_data(std::move(data));
+    latency_.reserve(kMaxSamples);
+}
+
+Benchmark::~Benchmark() = default;
+
+bool Benchmark::start()
+{
+    server_.start(0, this);
+
+    client_ = std::make_unique<NetworkChannel>();
+    client_->setListener(this);
+    client_->setWriteBatchSize(config_.batch_size);
+
+    client_->connect(u"127.0.0.1", server_.port());
+    return true;
+}
+
+void Benchmark::onNewConnection(std::unique_ptr<NetworkChannel> channel)
+{
+    server_channel_ = std::move(channel);
+    server_channel_->setListener(this);
+    server_channel_->setNoDelay(true);
+
+    if (!setCipher(client_.get(), server_channel_.get()))
+    {
+        MessageLoop::current()->taskRunner()->postQuit();
+        return;
+    }
+
+    server_channel_->resume();
+
+    if (client_connected_)
+        startMeasurement();
+}
+
+void Benchmark::onConnected()
+{
+    client_connected_ = true;
+    client_->setNoDelay(true);
+
+    if (server_channel_)
+        startMeasurement();
+}
+
+void Benchmark::onDisconnected(NetworkChannel::ErrorCode error_code)
+{
+    LOG(LS_ERROR) << "Disconnected: " << NetworkChannel::errorToString(error_code);
+    MessageLoop::current()->taskRunner()->postQuit();
+}
+
+void Benchmark::onMessageReceived(const ByteArray& /* buffer */)
+{
+    DCHECK(!send_time_.empty());
+
+    const Clock::time_point now = Clock::now();
+
+    if (measuring_)
+    {
+        ++received_;
+
+        if (latency_.size() < latency_.capacity())
+        {
+            latency_.push_back(std::chrono::duration_cast<std::chrono::microseconds>(
+                now - send_time_.front()).count());
+        }
+    }
+
+    send_time_.pop_front();
+
+    if (!measuring_ && now - start_time_ >= kWarmUpTime)
+    {
+        // The messages that are already sent are not counted.
+        measuring_ = true;
+        measure_time_ = now;
+        measure_allocations_ = g_allocations.load(std::memory_order_relaxed);
+    }
+
+    if (measuring_ && now - measure_time_ >= config_.duration)
+        stopping_ = true;
+
+    if (!stopping_)
+    {
+        sendMessage();
+    }
+    else if (send_time_.empty())
+    {
+        finish();
+    }
+}
+
+void Benchmark::onMessageWritten(size_t /* pending */)
+{
+    // Nothing
+}
+
+bool Benchmark::setCipher(NetworkChannel* encrypt_channel, NetworkChannel* decrypt_channel)
+{
+    if (config_.cipher != Cipher::NONE)
+    {
+        std::unique_ptr<MessageEncryptor> encryptor;
+        std::unique_ptr<MessageDecryptor> decryptor;
+
+        if (config_.cipher == Cipher::AES256_GCM)
+        {
+            encryptor = MessageEncryptorOpenssl::createForAes256Gcm(key_, client_iv_);
+            decryptor = MessageDecryptorOpenssl::createForAes256Gcm(key_, client_iv_);
+        }
+        else
+        {
+            encryptor = MessageEncryptorOpenssl::createForChaCha20Poly1305(key_, client_iv_);
+            decryptor = MessageDecryptorOpenssl::createForChaCha20Poly1305(key_, client_iv_);
+        }
+
+        if (!encryptor || !decryptor)
+        {
+            LOG(LS_ERROR) << "Unable to create cryptographer";
+            return false;
+        }
+
+        encrypt_channel->setEncryptor(std::move(encryptor));
+        decrypt_channel->setDecryptor(std::move(decryptor));
+    }
+
+    if (config_.compression)
+    {
+        std::unique_ptr<MessageCompressor> compressor =
+            MessageCompressor::create(MessageCompressor::dictionaryId());
+        std::unique_ptr<MessageCompressor> decompressor =
+            MessageCompressor::create(MessageCompressor::dictionaryId());
+
+        if (!compressor || !decompressor)
+            return false;
+
+        encrypt_channel->setCompressor(std::move(compressor));
+        decrypt_channel->setCompressor(std::move(decompressor));
+    }
+
+    return true;
+}
+
+void Benchmark::sendMessage()
+{
+    send_time_.push_back(Clock::now());
+    client_->send(message_);
+}
+
+void Benchmark::startMeasurement()
+{
+    start_time_ = Clock::now();
+
+    for (size_t i = 0; i < config_.depth; ++i)
+        sendMessage();
+}
+
+void Benchmark::finish()
+{
+    const double seconds = std::chrono::duration<double>(Clock::now() - measure_time_).count();
+    const int64_t allocations =
+        g_allocations.load(std::memory_order_relaxed) - measure_allocations_;
+
+    result_.messages_per_second = static_cast<double>(received_) / seconds;
+    result_.megabytes_per_second =
+        result_.messages_per_second * static_cast<double>(config_.message_size) / 1e6;
+    result_.allocations_per_message =
+        received_ ? static_cast<double>(allocations) / static_cast<double>(received_) : 0;
+
+    if (!latency_.empty())
+    {
+        auto percentile = [this](size_t percent)
+        {
+            auto nth = latency_.begin() + static_cast<ptrdiff_t>(
+                (latency_.size() - 1) * percent / 100);
+            std::nth_element(latency_.begin(), nth, latency_.end());
+            return std::chrono::microseconds(*nth);
+        };
+
+        result_.p50 = percentile(50);
+        result_.p99 = percentile(99);
+    }
+
+    MessageLoop::current()->taskRunner()->postQuit();
+}
+
+template <typename T>
+std::vector<T> parseList(const CommandLine& command_line,
+                         std::u16string_view name,
+                         const std::vector<T>& default_value)
+{
+    if (!command_line.hasSwitch(name))
+        return default_value;
+
+    std::vector<T> result;
+
+    for (const auto& item : splitString(command_line.switchValue(name), u",",
+                                        TRIM_WHITESPACE, SPLIT_WANT_NONEMPTY))
+    {
+        int64_t value;
+        if (!stringToInt64(item, &value) || value < 0)
+        {
+            std::cout << "Invalid value of --" << utf8FromUtf16(name) << ": "
+                      << utf8FromUtf16(item) << std::endl;
+            exit(1);
+        }
+
+        result.push_back(static_cast<T>(value));
+    }
+
+    return result;
+}
+
+std::vector<Cipher> parseCiphers(const CommandLine& command_line)
+{
+    if (!command_line.hasSwitch(u"cipher"))
+        return { Cipher::NONE, Cipher::AES256_GCM, Cipher::CHACHA20_POLY1305 };
+
+    std::vector<Cipher> result;
+
+    for (const auto& item : splitString(command_line.switchValue(u"cipher"), u",",
+                                        TRIM_WHITESPACE, SPLIT_WANT_NONEMPTY))
+    {
+        if (item == u"none")
+            result.push_back(Cipher::NONE);
+        else if (item == u"aes256gcm")
+            result.push_back(Cipher::AES256_GCM);
+        else if (item == u"chacha20poly1305")
+            result.push_back(Cipher::CHACHA20_POLY1305);
+        else
+        {
+            std::cout << "Unknown cipher: " << utf8FromUtf16(item) << std::endl;
+            exit(1);
+        }
+    }
+
+    return result;
+}
+
+Result runBenchmark(const Config& config)
+{
+    MessageLoop message_loop(MessageLoop::Type::ASIO);
+
+    Benchmark benchmark(config);
+    benchmark.start();
+
+    message_loop.run();
+    return benchmark.result();
+}
+
+} // namespace
+
+} // namespace base
+
+int main(int argc, const char* const* argv)
+{
+    base::CommandLine::init(argc, argv);
+    const base::CommandLine& command_line = *base::CommandLine::forCurrentProcess();
+
+    base::ScopedCryptoInitializer crypto_initializer;
+    if (!crypto_initializer.isSucceeded())
+        return 1;
+
+    const std::vector<base::Cipher> ciphers = base::parseCiphers(command_line);
+    const std::vector<size_t> sizes =
+        base::parseList<size_t>(command_line, u"size", { 64, 1024, 16384, 262144 });
+    const std::vector<size_t> depths = base::parseList<size_t>(command_line, u"depth", { 1, 16 });
+    const std::vector<size_t> batch_sizes =
+        base::parseList<size_t>(command_line, u"batch", { 0 });
+    const std::vector<int64_t> time = base::parseList<int64_t>(command_line, u"time", { 1000 });
+
+    std::cout << base::stringPrintf("%-44s %12s %10s %9s %9s %11s",
+                                    "Benchmark", "Messages/s", "MB/s", "p50 us", "p99 us",
+                                    "Allocs/msg") << std::endl;
+
+    for (base::Cipher cipher : ciphers)
+    {
+        for (size_t size : sizes)
+        {
+            for (size_t depth : depths)
+            {
+                for (size_t batch_size : batch_sizes)
+                {
+                    base::Config config;
+                    config.cipher = cipher;
+                    config.message_size = std::max(size, size_t(1));
+                    config.depth = std::max(depth, size_t(1));
+                    config.batch_size = batch_size;
+                    config.compression = command_line.hasSwitch(u"compression");
+                    config.text = command_line.hasSwitch(u"text");
+                    config.duration = std::chrono::milliseconds(time.empty() ? 1000 : time[0]);
+
+                    const base::Result result = base::runBenchmark(config);
+
+                    std::string name = base::stringPrintf(
+                        "%s/size:%zu/depth:%zu/batch:%zu%s", base::cipherToString(cipher),
+                        config.message_size, config.depth, config.batch_size,
+                        config.compression ? "/zstd" : "");
+
+                    std::cout << base::stringPrintf(
+                        "%-44s %12.0f %10.1f %9lld %9lld %11.2f", name.c_str(),
+                        result.messages_per_second, result.megabytes_per_second,
+                        static_cast<long long>(result.p50.count()),
+                        static_cast<long long>(result.p99.count()),
+                        result.allocations_per_message) << std::endl;
+                }
+            }
+        }
+    }
+
+    return 0;
+}
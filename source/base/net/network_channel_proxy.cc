@@ -31,13 +31,13 @@ NetworkChannelProxy::NetworkChannelProxy(
     // Nothing
 }
 
-void NetworkChannelProxy::send(ByteArray&& buffer)
+void NetworkChannelProxy::send(ByteArray&& buffer, NetworkChannel::Priority priority)
 {
     std::scoped_lock lock(incoming_queue_lock_);
 
     bool schedule_write = incoming_queue_.empty();
 
-    incoming_queue_.emplace(std::move(buffer));
+    incoming_queue_.emplace_back(std::move(buffer), priority);
 
     if (!schedule_write)
         return;
@@ -52,29 +52,24 @@ void NetworkChannelProxy::willDestroyCurrentChannel()
 
 void NetworkChannelProxy::scheduleWrite()
 {
-    if (!channel_)
-        return;
-
-    if (!reloadWriteQueue(&channel_->write_queue_))
-        return;
-
-    channel_->doWrite();
-}
-
-bool NetworkChannelProxy::reloadWriteQueue(std::queue<ByteArray>* work_queue)
-{
-    if (!work_queue->empty())
-        return false;
-
-    std::scoped_lock lock(incoming_queue_lock_);
-
-    if (incoming_queue_.empty())
-        return false;
-
-    incoming_queue_.swap(*work_queue);
-    DCHECK(incoming_queue_.empty());
-
-    return true;
+    {
+        std::scoped_lock lock(incoming_queue_lock_);
+        incoming_queue_.swap(work_queue_);
+    }
+
+    // Pass the messages to the channel. It puts them into its queue according to their priority.
+    while (!work_queue_.empty())
+    {
+        if (!channel_)
+        {
+            work_queue_.clear();
+            return;
+        }
+
+        auto& [buffer, priority] = work_queue_.front();
+        channel_->send(std::move(buffer), priority);
+        work_queue_.pop_front();
+    }
 }
 
 } // namespace base
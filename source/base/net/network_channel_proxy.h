@@ -21,6 +21,7 @@
 
 #include "base/net/network_channel.h"
 
+#include <deque>
 #include <shared_mutex>
 
 namespace base {
@@ -30,7 +31,8 @@ class TaskRunner;
 class NetworkChannelProxy : public std::enable_shared_from_this<NetworkChannelProxy>
 {
 public:
-    void send(ByteArray&& buffer);
+    void send(ByteArray&& buffer,
+              NetworkChannel::Priority priority = NetworkChannel::Priority::CONTROL);
 
 private:
     friend class NetworkChannel;
@@ -40,15 +42,19 @@ private:
     void willDestroyCurrentChannel();
 
     void scheduleWrite();
-    bool reloadWriteQueue(std::queue<ByteArray>* work_queue);
 
     std::shared_ptr<TaskRunner> task_runner_;
 
     NetworkChannel* channel_;
 
-    std::queue<ByteArray> incoming_queue_;
+    using Queue = std::deque<std::pair<ByteArray, NetworkChannel::Priority>>;
+
+    Queue incoming_queue_;
     std::mutex incoming_queue_lock_;
 
+    // Used only on the thread of the channel.
+    Queue work_queue_;
+
     DISALLOW_COPY_AND_ASSIGN(NetworkChannelProxy);
 };
 
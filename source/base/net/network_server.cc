@@ -23,31 +23,60 @@
 #include "base/message_loop/message_pump_asio.h"
 #include "base/net/network_channel.h"
 #include "base/strings/unicode.h"
+#include "base/threading/thread.h"
+#include "build/build_config.h"
+
+#include <algorithm>
+#include <thread>
 
 namespace base {
 
+namespace {
+
+#if defined(OS_LINUX)
+using ReusePort = asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+#endif // defined(OS_LINUX)
+
+} // namespace
+
 class NetworkServer::Impl : public std::enable_shared_from_this<Impl>
 {
 public:
+    using AcceptCallback = std::function<void(asio::ip::tcp::socket&& socket)>;
+
     explicit Impl(asio::io_context& io_context);
     ~Impl();
 
-    void start(uint16_t port, Delegate* delegate);
+    // Starts listening on the port. If |reuse_port| is true, then other acceptors can listen on the
+    // same port (supported only on Linux). |callback| is called for each accepted connection.
+    void start(uint16_t port, bool reuse_port, AcceptCallback callback);
     void stop();
     uint16_t port() const;
 
+    static std::unique_ptr<NetworkChannel> createChannel(asio::ip::tcp::socket&& socket);
+
 private:
     void doAccept();
     void onAccept(const std::error_code& error_code, asio::ip::tcp::socket socket);
 
     asio::io_context& io_context_;
     std::unique_ptr<asio::ip::tcp::acceptor> acceptor_;
-    Delegate* delegate_ = nullptr;
+    AcceptCallback callback_;
     uint16_t port_ = 0;
 
     DISALLOW_COPY_AND_ASSIGN(Impl);
 };
 
+// Thread with its own I/O context and delegate.
+struct NetworkServer::AcceptThread
+{
+    std::unique_ptr<Thread> thread;
+    std::unique_ptr<Delegate> delegate;
+
+    // Acceptor of the thread. Used only if the threads listen on the port with SO_REUSEPORT.
+    std::shared_ptr<Impl> impl;
+};
+
 NetworkServer::Impl::Impl(asio::io_context& io_context)
     : io_context_(io_context)
 {
@@ -59,22 +88,39 @@ NetworkServer::Impl::~Impl()
     DCHECK(!acceptor_);
 }
 
-void NetworkServer::Impl::start(uint16_t port, Delegate* delegate)
+void NetworkServer::Impl::start(uint16_t port, bool reuse_port, AcceptCallback callback)
 {
-    delegate_ = delegate;
-    port_ = port;
-
-    DCHECK(delegate_);
+    callback_ = std::move(callback);
+    DCHECK(callback_);
 
     asio::ip::tcp::endpoint endpoint(asio::ip::tcp::v4(), port);
-    acceptor_ = std::make_unique<asio::ip::tcp::acceptor>(io_context_, endpoint);
+
+    if (!reuse_port)
+    {
+        acceptor_ = std::make_unique<asio::ip::tcp::acceptor>(io_context_, endpoint);
+    }
+    else
+    {
+#if defined(OS_LINUX)
+        acceptor_ = std::make_unique<asio::ip::tcp::acceptor>(io_context_);
+        acceptor_->open(endpoint.protocol());
+        acceptor_->set_option(asio::ip::tcp::acceptor::reuse_address(true));
+        acceptor_->set_option(ReusePort(true));
+        acceptor_->bind(endpoint);
+        acceptor_->listen();
+#else
+        NOTREACHED();
+#endif // defined(OS_LINUX)
+    }
+
+    port_ = acceptor_->local_endpoint().port();
 
     doAccept();
 }
 
 void NetworkServer::Impl::stop()
 {
-    delegate_ = nullptr;
+    callback_ = nullptr;
     acceptor_.reset();
 }
 
@@ -83,6 +129,12 @@ uint16_t NetworkServer::Impl::port() const
     return port_;
 }
 
+// static
+std::unique_ptr<NetworkChannel> NetworkServer::Impl::createChannel(asio::ip::tcp::socket&& socket)
+{
+    return std::unique_ptr<NetworkChannel>(new NetworkChannel(std::move(socket)));
+}
+
 void NetworkServer::Impl::doAccept()
 {
     acceptor_->async_accept(
@@ -91,7 +143,7 @@ void NetworkServer::Impl::doAccept()
 
 void NetworkServer::Impl::onAccept(const std::error_code& error_code, asio::ip::tcp::socket socket)
 {
-    if (!delegate_)
+    if (!callback_)
         return;
 
     if (error_code)
@@ -101,11 +153,8 @@ void NetworkServer::Impl::onAccept(const std::error_code& error_code, asio::ip::
     }
     else
     {
-        std::unique_ptr<NetworkChannel> channel =
-            std::unique_ptr<NetworkChannel>(new NetworkChannel(std::move(socket)));
-
         // Connection accepted.
-        delegate_->onNewConnection(std::move(channel));
+        callback_(std::move(socket));
     }
 
     // Accept next connection.
@@ -120,21 +169,131 @@ NetworkServer::NetworkServer()
 
 NetworkServer::~NetworkServer()
 {
-    impl_->stop();
+    stop();
 }
 
 void NetworkServer::start(uint16_t port, Delegate* delegate)
 {
-    impl_->start(port, delegate);
+    DCHECK(delegate);
+
+    impl_->start(port, false, [delegate](asio::ip::tcp::socket&& socket)
+    {
+        delegate->onNewConnection(Impl::createChannel(std::move(socket)));
+    });
+}
+
+void NetworkServer::start(uint16_t port,
+                          size_t thread_count,
+                          const DelegateFactory& delegate_factory)
+{
+    DCHECK(threads_.empty());
+    DCHECK(delegate_factory);
+
+    if (!thread_count)
+        thread_count = std::max(std::thread::hardware_concurrency(), 1U);
+
+    LOG(LS_INFO) << "Accept thread count: " << thread_count;
+
+    for (size_t i = 0; i < thread_count; ++i)
+    {
+        std::unique_ptr<AcceptThread> accept_thread = std::make_unique<AcceptThread>();
+
+        accept_thread->thread = std::make_unique<Thread>();
+        accept_thread->thread->start(MessageLoop::Type::ASIO);
+        accept_thread->delegate = delegate_factory();
+
+        threads_.emplace_back(std::move(accept_thread));
+    }
+
+#if defined(OS_LINUX)
+    for (auto& accept_thread : threads_)
+    {
+        Delegate* delegate = accept_thread->delegate.get();
+
+        accept_thread->impl = std::make_shared<Impl>(
+            accept_thread->thread->messageLoop()->pumpAsio()->ioContext());
+
+        // The callback is called on the thread of the acceptor.
+        accept_thread->impl->start(port, true, [delegate](asio::ip::tcp::socket&& socket)
+        {
+            delegate->onNewConnection(Impl::createChannel(std::move(socket)));
+        });
+
+        // If the port is not specified, then it is chosen by the first acceptor.
+        port = accept_thread->impl->port();
+    }
+#else
+    impl_->start(port, false, [this](asio::ip::tcp::socket&& socket)
+    {
+        std::error_code error_code;
+
+        asio::ip::tcp::endpoint endpoint = socket.local_endpoint(error_code);
+        if (error_code)
+            return;
+
+        // On Windows the operation is supported since Windows 8.1.
+        asio::ip::tcp::socket::native_handle_type native_handle = socket.release(error_code);
+        if (error_code)
+        {
+            LOG(LS_ERROR) << "Unable to release socket: "
+                          << base::utf16FromLocal8Bit(error_code.message());
+            return;
+        }
+
+        // Threads are selected in turn.
+        AcceptThread* accept_thread = threads_[next_thread_].get();
+        next_thread_ = (next_thread_ + 1) % threads_.size();
+
+        Delegate* delegate = accept_thread->delegate.get();
+        asio::ip::tcp protocol = endpoint.protocol();
+
+        accept_thread->thread->taskRunner()->postTask([delegate, protocol, native_handle]()
+        {
+            asio::ip::tcp::socket socket(MessageLoop::current()->pumpAsio()->ioContext());
+
+            std::error_code error_code;
+            socket.assign(protocol, native_handle, error_code);
+            if (error_code)
+            {
+                LOG(LS_ERROR) << "Unable to assign socket: "
+                              << base::utf16FromLocal8Bit(error_code.message());
+                return;
+            }
+
+            delegate->onNewConnection(Impl::createChannel(std::move(socket)));
+        });
+    });
+#endif // defined(OS_LINUX)
 }
 
 void NetworkServer::stop()
 {
     impl_->stop();
+
+    for (auto& accept_thread : threads_)
+    {
+        std::shared_ptr<TaskRunner> task_runner = accept_thread->thread->taskRunner();
+
+        // The acceptor and the delegate are destroyed on their thread. The tasks are executed
+        // before the thread stops.
+        std::shared_ptr<Impl> impl = std::move(accept_thread->impl);
+        if (impl)
+            task_runner->postTask(std::bind(&Impl::stop, impl));
+
+        task_runner->deleteSoon(std::move(accept_thread->delegate));
+
+        accept_thread->thread->stop();
+    }
+
+    threads_.clear();
+    next_thread_ = 0;
 }
 
 uint16_t NetworkServer::port() const
 {
+    if (!threads_.empty() && threads_.front()->impl)
+        return threads_.front()->impl->port();
+
     return impl_->port();
 }
 
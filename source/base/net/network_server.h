@@ -22,11 +22,14 @@
 #include "base/macros_magic.h"
 
 #include <cstdint>
+#include <functional>
 #include <memory>
+#include <vector>
 
 namespace base {
 
 class NetworkChannel;
+class Thread;
 
 class NetworkServer
 {
@@ -42,13 +45,29 @@ public:
         virtual void onNewConnection(std::unique_ptr<NetworkChannel> channel) = 0;
     };
 
+    using DelegateFactory = std::function<std::unique_ptr<Delegate>()>;
+
     void start(uint16_t port, Delegate* delegate);
+
+    // Starts the server with |thread_count| threads that accept connections. Each thread runs its
+    // own I/O context and has its own delegate created by |delegate_factory| on the current thread.
+    // Connections are passed to the delegate of the thread that accepted them on this thread, so
+    // channels are created and processed there. The delegates are destroyed on their threads by
+    // stop(). On Linux, each thread listens on the port with SO_REUSEPORT and the kernel distributes
+    // the connections between them. On other platforms, connections are accepted on the current
+    // thread and passed to the threads in turn.
+    void start(uint16_t port, size_t thread_count, const DelegateFactory& delegate_factory);
+
     void stop();
     uint16_t port() const;
 
 private:
     class Impl;
+    struct AcceptThread;
+
     std::shared_ptr<Impl> impl_;
+    std::vector<std::unique_ptr<AcceptThread>> threads_;
+    size_t next_thread_ = 0;
 
     DISALLOW_COPY_AND_ASSIGN(NetworkServer);
 };
@@ -0,0 +1,257 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+
+#include "base/net/socket_profile.h"
+
+#include "base/logging.h"
+#include "base/strings/unicode.h"
+#include "build/build_config.h"
+
+#include <algorithm>
+
+#if defined(OS_WIN)
+#include <winsock2.h>
+#include <mstcpip.h>
+#endif // defined(OS_WIN)
+
+#if defined(OS_POSIX)
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#endif // defined(OS_POSIX)
+
+namespace base {
+
+namespace {
+
+template <int Level, int Name>
+bool setIntegerOption(asio::ip::tcp::socket* socket, int value, const char* name)
+{
+    asio::detail::socket_option::integer<Level, Name> option(value);
+
+    std::error_code error_code;
+    socket->set_option(option, error_code);
+
+    if (error_code)
+    {
+        LOG(LS_WARNING) << "Failed to set " << name << ": "
+                        << utf16FromLocal8Bit(error_code.message());
+        return false;
+    }
+
+    return true;
+}
+
+#if defined(OS_POSIX)
+// The keep-alive options are set in seconds. Zero is not allowed.
+int toSeconds(const std::chrono::milliseconds& time)
+{
+    return std::max(static_cast<int>(
+        std::chrono::duration_cast<std::chrono::seconds>(time).count()), 1);
+}
+#endif // defined(OS_POSIX)
+
+} // namespace
+
+// static
+SocketProfile SocketProfile::forRole(Role role)
+{
+    SocketProfile profile;
+
+    switch (role)
+    {
+        case Role::ROUTER_CONTROL:
+        {
+            // A peer that does not answer for about 45 seconds is considered lost.
+            profile.keep_alive_time = std::chrono::seconds(30);
+            profile.keep_alive_interval = std::chrono::seconds(3);
+            profile.keep_alive_count = 5;
+            profile.user_timeout = std::chrono::seconds(45);
+        }
+        break;
+
+        case Role::RELAY_DATA:
+        {
+            profile.keep_alive_time = std::chrono::seconds(30);
+            profile.keep_alive_interval = std::chrono::seconds(3);
+            profile.keep_alive_count = 5;
+            profile.user_timeout = std::chrono::seconds(45);
+            profile.not_sent_low_watermark = 128 * 1024;
+        }
+        break;
+
+        case Role::DESKTOP_STREAM:
+        {
+            profile.keep_alive_time = std::chrono::minutes(1);
+            profile.keep_alive_interval = std::chrono::seconds(3);
+            profile.keep_alive_count = 5;
+            profile.user_timeout = std::chrono::seconds(60);
+            profile.not_sent_low_watermark = 32 * 1024;
+            profile.quick_ack = true;
+        }
+        break;
+    }
+
+    return profile;
+}
+
+bool applySocketProfile(asio::ip::tcp::socket* socket, const SocketProfile& profile)
+{
+    DCHECK(socket);
+
+    bool result = true;
+
+    if (profile.no_delay)
+    {
+        std::error_code error_code;
+        socket->set_option(asio::ip::tcp::no_delay(true), error_code);
+
+        if (error_code)
+        {
+            LOG(LS_WARNING) << "Failed to disable Nagle's algorithm: "
+                            << utf16FromLocal8Bit(error_code.message());
+            result = false;
+        }
+    }
+
+    if (profile.keep_alive_time.count() > 0)
+    {
+        if (!setSocketKeepAlive(socket, true, profile.keep_alive_time,
+                                profile.keep_alive_interval))
+        {
+            result = false;
+        }
+
+#if defined(OS_POSIX)
+        if (profile.keep_alive_count > 0 &&
+            !setIntegerOption<IPPROTO_TCP, TCP_KEEPCNT>(
+                socket, profile.keep_alive_count, "TCP_KEEPCNT"))
+        {
+            result = false;
+        }
+#endif // defined(OS_POSIX)
+    }
+
+#if defined(OS_LINUX)
+    if (profile.user_timeout.count() > 0 &&
+        !setIntegerOption<IPPROTO_TCP, TCP_USER_TIMEOUT>(
+            socket, static_cast<int>(profile.user_timeout.count()), "TCP_USER_TIMEOUT"))
+    {
+        result = false;
+    }
+
+    if (profile.quick_ack)
+        enableSocketQuickAck(socket);
+
+    if (profile.busy_poll.count() > 0 &&
+        !setIntegerOption<SOL_SOCKET, SO_BUSY_POLL>(
+            socket, static_cast<int>(profile.busy_poll.count()), "SO_BUSY_POLL"))
+    {
+        result = false;
+    }
+#endif // defined(OS_LINUX)
+
+#if defined(OS_POSIX)
+    if (profile.not_sent_low_watermark > 0 &&
+        !setIntegerOption<IPPROTO_TCP, TCP_NOTSENT_LOWAT>(
+            socket, profile.not_sent_low_watermark, "TCP_NOTSENT_LOWAT"))
+    {
+        result = false;
+    }
+#endif // defined(OS_POSIX)
+
+    return result;
+}
+
+bool setSocketKeepAlive(asio::ip::tcp::socket* socket,
+                        bool enable,
+                        const std::chrono::milliseconds& time,
+                        const std::chrono::milliseconds& interval)
+{
+    DCHECK(socket);
+
+#if defined(OS_WIN)
+    struct tcp_keepalive alive;
+
+    alive.onoff = enable ? TRUE : FALSE;
+    alive.keepalivetime = static_cast<ULONG>(time.count());
+    alive.keepaliveinterval = static_cast<ULONG>(interval.count());
+
+    DWORD bytes_returned;
+
+    if (WSAIoctl(socket->native_handle(), SIO_KEEPALIVE_VALS,
+                 &alive, sizeof(alive), nullptr, 0, &bytes_returned,
+                 nullptr, nullptr) == SOCKET_ERROR)
+    {
+        PLOG(LS_WARNING) << "WSAIoctl failed";
+        return false;
+    }
+
+    return true;
+#else
+    std::error_code error_code;
+    socket->set_option(asio::socket_base::keep_alive(enable), error_code);
+
+    if (error_code)
+    {
+        LOG(LS_WARNING) << "Failed to set SO_KEEPALIVE: "
+                        << utf16FromLocal8Bit(error_code.message());
+        return false;
+    }
+
+    if (!enable)
+        return true;
+
+#if defined(OS_LINUX)
+    if (time.count() > 0 &&
+        !setIntegerOption<IPPROTO_TCP, TCP_KEEPIDLE>(socket, toSeconds(time), "TCP_KEEPIDLE"))
+    {
+        return false;
+    }
+#elif defined(OS_MACOSX)
+    if (time.count() > 0 &&
+        !setIntegerOption<IPPROTO_TCP, TCP_KEEPALIVE>(socket, toSeconds(time), "TCP_KEEPALIVE"))
+    {
+        return false;
+    }
+#endif
+
+    if (interval.count() > 0 &&
+        !setIntegerOption<IPPROTO_TCP, TCP_KEEPINTVL>(
+            socket, toSeconds(interval), "TCP_KEEPINTVL"))
+    {
+        return false;
+    }
+
+    return true;
+#endif // defined(OS_WIN)
+}
+
+void enableSocketQuickAck(asio::ip::tcp::socket* socket)
+{
+#if defined(OS_LINUX)
+    int value = 1;
+
+    // The mode is not permanent, so errors are not reported.
+    setsockopt(socket->native_handle(), IPPROTO_TCP, TCP_QUICKACK, &value, sizeof(value));
+#else
+    (void)socket; // Unused on platforms other than Linux.
+#endif // defined(OS_LINUX)
+}
+
+} // namespace base
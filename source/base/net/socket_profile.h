@@ -0,0 +1,93 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+
+#ifndef BASE__NET__SOCKET_PROFILE_H
+#define BASE__NET__SOCKET_PROFILE_H
+
+#include <asio/ip/tcp.hpp>
+
+#include <chrono>
+
+namespace base {
+
+// Options of a TCP socket that depend on the purpose of the connection. Options that are not
+// supported by the platform are ignored. A zero value means that the option is not changed.
+struct SocketProfile
+{
+    enum class Role
+    {
+        // Connection between the router and its peers (clients, hosts, relays). Little traffic, but
+        // a dead peer must be detected quickly.
+        ROUTER_CONTROL,
+
+        // Connection of a peer to the relay. The relay forwards large amounts of data between
+        // peers, so the kernel must not hold too much unsent data.
+        RELAY_DATA,
+
+        // Connection that carries the desktop stream. Latency is more important than throughput.
+        DESKTOP_STREAM
+    };
+
+    static SocketProfile forRole(Role role);
+
+    // Disables the algorithm of Nagle.
+    bool no_delay = true;
+
+    // Time with no activity until the first keep-alive packet is sent, the interval between
+    // keep-alive packets and the number of packets without an answer after which the connection is
+    // closed. The number is not supported on Windows.
+    std::chrono::milliseconds keep_alive_time { 0 };
+    std::chrono::milliseconds keep_alive_interval { 0 };
+    int keep_alive_count = 0;
+
+    // Maximum time that the sent data may remain unacknowledged before the connection is closed
+    // (TCP_USER_TIMEOUT). Linux only.
+    std::chrono::milliseconds user_timeout { 0 };
+
+    // The socket becomes writable only when the amount of unsent data in the kernel is below this
+    // limit (TCP_NOTSENT_LOWAT). Keeps the kernel send queue short, so the data waits in the
+    // application, where it can be dropped or replaced. Linux and macOS.
+    int not_sent_low_watermark = 0;
+
+    // Acknowledges the received data immediately instead of delaying the ACK (TCP_QUICKACK). The
+    // kernel resets the mode, so it must be enabled again after each read. Linux only.
+    bool quick_ack = false;
+
+    // Time to busy poll the device queue when there is no data (SO_BUSY_POLL). Reduces the latency
+    // of receiving at the expense of CPU. Values above net.core.busy_read require CAP_NET_ADMIN.
+    // Linux only.
+    std::chrono::microseconds busy_poll { 0 };
+};
+
+// Applies |profile| to |socket|. Returns false if at least one of the options could not be set.
+// The remaining options are applied anyway.
+bool applySocketProfile(asio::ip::tcp::socket* socket, const SocketProfile& profile);
+
+// Enables or disables sending keep alive packets. See NetworkChannel::setKeepAlive().
+bool setSocketKeepAlive(asio::ip::tcp::socket* socket,
+                        bool enable,
+                        const std::chrono::milliseconds& time,
+                        const std::chrono::milliseconds& interval);
+
+// Enables TCP_QUICKACK mode once. Does nothing on platforms other than Linux.
+void enableSocketQuickAck(asio::ip::tcp::socket* socket);
+
+} // namespace base
+
+#endif // BASE__NET__SOCKET_PROFILE_H
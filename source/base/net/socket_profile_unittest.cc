@@ -0,0 +1,116 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+
+#include "base/net/socket_profile.h"
+#include "build/build_config.h"
+
+#include <asio/io_context.hpp>
+
+#include <gtest/gtest.h>
+
+#if defined(OS_POSIX)
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#endif // defined(OS_POSIX)
+
+namespace base {
+
+#if defined(OS_LINUX)
+
+namespace {
+
+int integerOption(asio::ip::tcp::socket* socket, int level, int name)
+{
+    int value = 0;
+    socklen_t length = sizeof(value);
+
+    if (getsockopt(socket->native_handle(), level, name, &value, &length) != 0)
+        return -1;
+
+    return value;
+}
+
+} // namespace
+
+TEST(SocketProfileTest, Apply)
+{
+    asio::io_context io_context;
+    asio::ip::tcp::socket socket(io_context);
+    socket.open(asio::ip::tcp::v4());
+
+    SocketProfile profile = SocketProfile::forRole(SocketProfile::Role::DESKTOP_STREAM);
+    profile.keep_alive_time = std::chrono::seconds(20);
+    profile.keep_alive_interval = std::chrono::milliseconds(1500);
+    profile.keep_alive_count = 4;
+    profile.user_timeout = std::chrono::seconds(10);
+    profile.not_sent_low_watermark = 16384;
+
+    EXPECT_TRUE(applySocketProfile(&socket, profile));
+
+    EXPECT_EQ(integerOption(&socket, IPPROTO_TCP, TCP_NODELAY), 1);
+    EXPECT_EQ(integerOption(&socket, SOL_SOCKET, SO_KEEPALIVE), 1);
+    EXPECT_EQ(integerOption(&socket, IPPROTO_TCP, TCP_KEEPIDLE), 20);
+
+    // The interval is rounded down to whole seconds.
+    EXPECT_EQ(integerOption(&socket, IPPROTO_TCP, TCP_KEEPINTVL), 1);
+    EXPECT_EQ(integerOption(&socket, IPPROTO_TCP, TCP_KEEPCNT), 4);
+    EXPECT_EQ(integerOption(&socket, IPPROTO_TCP, TCP_USER_TIMEOUT), 10000);
+    EXPECT_EQ(integerOption(&socket, IPPROTO_TCP, TCP_NOTSENT_LOWAT), 16384);
+}
+
+TEST(SocketProfileTest, ZeroValuesAreNotApplied)
+{
+    asio::io_context io_context;
+    asio::ip::tcp::socket socket(io_context);
+    socket.open(asio::ip::tcp::v4());
+
+    SocketProfile profile;
+    profile.no_delay = false;
+
+    EXPECT_TRUE(applySocketProfile(&socket, profile));
+
+    EXPECT_EQ(integerOption(&socket, IPPROTO_TCP, TCP_NODELAY), 0);
+    EXPECT_EQ(integerOption(&socket, SOL_SOCKET, SO_KEEPALIVE), 0);
+    EXPECT_EQ(integerOption(&socket, IPPROTO_TCP, TCP_USER_TIMEOUT), 0);
+}
+
+#endif // defined(OS_LINUX)
+
+TEST(SocketProfileTest, Roles)
+{
+    SocketProfile control = SocketProfile::forRole(SocketProfile::Role::ROUTER_CONTROL);
+    SocketProfile relay = SocketProfile::forRole(SocketProfile::Role::RELAY_DATA);
+    SocketProfile desktop = SocketProfile::forRole(SocketProfile::Role::DESKTOP_STREAM);
+
+    // All connections detect a dead peer.
+    EXPECT_GT(control.keep_alive_time.count(), 0);
+    EXPECT_GT(relay.keep_alive_time.count(), 0);
+    EXPECT_GT(desktop.keep_alive_time.count(), 0);
+
+    // Only data connections limit the kernel send queue.
+    EXPECT_EQ(control.not_sent_low_watermark, 0);
+    EXPECT_GT(relay.not_sent_low_watermark, 0);
+    EXPECT_GT(desktop.not_sent_low_watermark, 0);
+    EXPECT_LT(desktop.not_sent_low_watermark, relay.not_sent_low_watermark);
+
+    EXPECT_TRUE(desktop.quick_ack);
+    EXPECT_FALSE(relay.quick_ack);
+}
+
+} // namespace base
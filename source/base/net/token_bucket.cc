@@ -0,0 +1,84 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#include "base/net/token_bucket.h"
+
+#include "base/logging.h"
+
+#include <cmath>
+
+namespace base {
+
+TokenBucket::TokenBucket(int64_t rate, int64_t capacity)
+    : rate_(rate),
+      capacity_(capacity),
+      tokens_(static_cast<double>(capacity))
+{
+    DCHECK_GT(rate_, 0);
+    DCHECK_GT(capacity_, 0);
+}
+
+TokenBucket::~TokenBucket() = default;
+
+int64_t TokenBucket::available(const TimePoint& now)
+{
+    std::scoped_lock lock(lock_);
+
+    refill(now);
+
+    if (tokens_ < 1.0)
+        return 0;
+
+    return static_cast<int64_t>(tokens_);
+}
+
+void TokenBucket::consume(int64_t bytes, const TimePoint& now)
+{
+    std::scoped_lock lock(lock_);
+
+    refill(now);
+    tokens_ -= static_cast<double>(bytes);
+}
+
+std::chrono::milliseconds TokenBucket::delay(int64_t bytes, const TimePoint& now)
+{
+    std::scoped_lock lock(lock_);
+
+    refill(now);
+
+    const double required = static_cast<double>(std::min(bytes, capacity_));
+    if (tokens_ >= required)
+        return std::chrono::milliseconds::zero();
+
+    const double seconds = (required - tokens_) / static_cast<double>(rate_);
+    return std::chrono::milliseconds(static_cast<int64_t>(std::ceil(seconds * 1000.0)));
+}
+
+void TokenBucket::refill(const TimePoint& now)
+{
+    if (now <= last_time_)
+        return;
+
+    const double seconds = std::chrono::duration<double>(now - last_time_).count();
+
+    tokens_ = std::min(tokens_ + seconds * static_cast<double>(rate_),
+                       static_cast<double>(capacity_));
+    last_time_ = now;
+}
+
+} // namespace base
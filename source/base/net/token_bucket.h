@@ -0,0 +1,74 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef BASE__NET__TOKEN_BUCKET_H
+#define BASE__NET__TOKEN_BUCKET_H
+
+#include "base/macros_magic.h"
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+namespace base {
+
+// Limits the speed of data transfer. Tokens (bytes) are added to the bucket at a constant rate up
+// to the bucket capacity. The data is transferred only if there are tokens in the bucket. The
+// methods of the class are thread safe, so the bucket can be shared between several threads.
+class TokenBucket
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimePoint = Clock::time_point;
+
+    // |rate| is the number of bytes per second. |capacity| is the maximum number of bytes that can
+    // be transferred at once after a period of inactivity. The bucket is initially full.
+    TokenBucket(int64_t rate, int64_t capacity);
+    ~TokenBucket();
+
+    int64_t rate() const { return rate_; }
+    int64_t capacity() const { return capacity_; }
+
+    // Returns the number of bytes that can be transferred at time |now|. Returns zero if the
+    // bucket is empty or in debt.
+    int64_t available(const TimePoint& now);
+
+    // Takes |bytes| from the bucket. If there are not enough tokens in the bucket, then it goes
+    // into debt, which is repaid before the following transfers.
+    void consume(int64_t bytes, const TimePoint& now);
+
+    // Returns the time after which at least |bytes| bytes can be transferred. |bytes| is limited
+    // by the capacity of the bucket.
+    std::chrono::milliseconds delay(int64_t bytes, const TimePoint& now);
+
+private:
+    void refill(const TimePoint& now);
+
+    const int64_t rate_;
+    const int64_t capacity_;
+
+    std::mutex lock_;
+    double tokens_;
+    TimePoint last_time_;
+
+    DISALLOW_COPY_AND_ASSIGN(TokenBucket);
+};
+
+} // namespace base
+
+#endif // BASE__NET__TOKEN_BUCKET_H
@@ -0,0 +1,107 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#include "base/net/token_bucket.h"
+
+#include <gtest/gtest.h>
+
+namespace base {
+
+TEST(TokenBucketTest, Refill)
+{
+    TokenBucket::TimePoint now = TokenBucket::Clock::now();
+    TokenBucket bucket(1000, 500);
+
+    // The bucket is initially full.
+    EXPECT_EQ(bucket.available(now), 500);
+
+    bucket.consume(500, now);
+    EXPECT_EQ(bucket.available(now), 0);
+    EXPECT_EQ(bucket.delay(100, now), std::chrono::milliseconds(100));
+
+    now += std::chrono::milliseconds(100);
+    EXPECT_EQ(bucket.available(now), 100);
+    EXPECT_EQ(bucket.delay(100, now), std::chrono::milliseconds::zero());
+
+    // The number of tokens does not exceed the capacity.
+    now += std::chrono::seconds(10);
+    EXPECT_EQ(bucket.available(now), 500);
+
+    // The requested number of bytes is limited by the capacity.
+    bucket.consume(500, now);
+    EXPECT_EQ(bucket.delay(100000, now), std::chrono::milliseconds(500));
+}
+
+TEST(TokenBucketTest, Debt)
+{
+    TokenBucket::TimePoint now = TokenBucket::Clock::now();
+    TokenBucket bucket(1000, 100);
+
+    // Consume more than the bucket contains.
+    bucket.consume(300, now);
+    EXPECT_EQ(bucket.available(now), 0);
+
+    // The debt of 200 bytes must be repaid first.
+    now += std::chrono::milliseconds(150);
+    EXPECT_EQ(bucket.available(now), 0);
+    EXPECT_EQ(bucket.delay(1, now), std::chrono::milliseconds(51));
+
+    now += std::chrono::milliseconds(100);
+    EXPECT_EQ(bucket.available(now), 50);
+}
+
+TEST(TokenBucketTest, Fairness)
+{
+    static const int kConsumerCount = 16;
+    static const int64_t kRate = 1024 * 1024;
+
+    TokenBucket::TimePoint now = TokenBucket::Clock::now();
+    TokenBucket bucket(kRate, kRate / 10);
+
+    int64_t consumed[kConsumerCount] = { 0 };
+
+    // Each consumer tries to read up to 64 KB every millisecond during 10 seconds.
+    for (int time = 0; time < 10000; ++time)
+    {
+        now += std::chrono::milliseconds(1);
+
+        for (int i = 0; i < kConsumerCount; ++i)
+        {
+            // Consumers take turns to be the first.
+            int consumer = (i + time) % kConsumerCount;
+
+            int64_t bytes = std::min(bucket.available(now), int64_t(64 * 1024));
+            bucket.consume(bytes, now);
+            consumed[consumer] += bytes;
+        }
+    }
+
+    int64_t total = 0;
+    for (int i = 0; i < kConsumerCount; ++i)
+        total += consumed[i];
+
+    // The total speed does not exceed the limit (plus the initial capacity of the bucket).
+    EXPECT_LE(total, kRate * 10 + kRate / 10);
+    EXPECT_GE(total, kRate * 10 - kRate / 100);
+
+    // Each consumer got its share.
+    for (int i = 0; i < kConsumerCount; ++i)
+        EXPECT_NEAR(static_cast<double>(consumed[i]), total / kConsumerCount, total / 100.0);
+}
+
+} // namespace base
@@ -20,47 +20,41 @@
 
 #include "base/logging.h"
 
+#include <algorithm>
+
 namespace base {
 
 VariableSizeReader::VariableSizeReader() = default;
 
 VariableSizeReader::~VariableSizeReader() = default;
 
-asio::mutable_buffer VariableSizeReader::buffer()
+// static
+std::optional<size_t> VariableSizeReader::messageSize(
+    const uint8_t* data, size_t size, size_t* length)
 {
-    DCHECK_LT(pos_, std::size(buffer_));
-
-    return asio::mutable_buffer(&buffer_[pos_], sizeof(uint8_t));
-}
+    DCHECK(length);
 
-std::optional<size_t> VariableSizeReader::messageSize()
-{
-    DCHECK_LT(pos_, std::size(buffer_));
-
-    if (pos_ == 3 || !(buffer_[pos_] & 0x80))
+    for (size_t pos = 0; pos < std::min(size, kMaxLength); ++pos)
     {
-        size_t result = buffer_[0] & 0x7F;
+        if (pos != kMaxLength - 1 && (data[pos] & 0x80))
+            continue;
 
-        if (pos_ >= 1)
-            result += (buffer_[1] & 0x7F) << 7;
+        size_t result = data[0] & 0x7F;
 
-        if (pos_ >= 2)
-            result += (buffer_[2] & 0x7F) << 14;
+        if (pos >= 1)
+            result += (data[1] & 0x7F) << 7;
 
-        if (pos_ >= 3)
-            result += buffer_[3] << 21;
+        if (pos >= 2)
+            result += (data[2] & 0x7F) << 14;
 
-        memset(buffer_, 0, std::size(buffer_));
-        pos_ = 0;
+        if (pos >= 3)
+            result += data[3] << 21;
 
+        *length = pos + 1;
         return result;
     }
-    else
-    {
-        ++pos_;
 
-        return std::nullopt;
-    }
+    return std::nullopt;
 }
 
 VariableSizeWriter::VariableSizeWriter() = default;
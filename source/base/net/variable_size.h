@@ -34,13 +34,14 @@ public:
     VariableSizeReader();
     ~VariableSizeReader();
 
-    asio::mutable_buffer buffer();
-    std::optional<size_t> messageSize();
+    // Parses the size of a message at the beginning of |data|. On success, returns the size of the
+    // message and stores the number of bytes occupied by the size in |length|. If |size| bytes are
+    // not enough to parse the size, then std::nullopt is returned.
+    static std::optional<size_t> messageSize(const uint8_t* data, size_t size, size_t* length);
 
-private:
-    uint8_t buffer_[4] = { 0 };
-    size_t pos_ = 0;
+    static constexpr size_t kMaxLength = 4;
 
+private:
     DISALLOW_COPY_AND_ASSIGN(VariableSizeReader);
 };
 
@@ -0,0 +1,83 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#include "base/net/variable_size.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+namespace base {
+
+TEST(VariableSizeTest, RoundTrip)
+{
+    const size_t sizes[] = { 1, 127, 128, 16383, 16384, 131071, 131072, 16 * 1024 * 1024 };
+    const size_t lengths[] = { 1, 1, 2, 2, 3, 3, 4, 4 };
+
+    for (size_t i = 0; i < std::size(sizes); ++i)
+    {
+        VariableSizeWriter writer;
+        asio::const_buffer buffer = writer.variableSize(sizes[i]);
+        ASSERT_EQ(buffer.size(), lengths[i]);
+
+        uint8_t data[8];
+        memcpy(data, buffer.data(), buffer.size());
+
+        // The size can not be parsed until all of its bytes are available.
+        size_t length = 0;
+        for (size_t j = 0; j < buffer.size(); ++j)
+            EXPECT_FALSE(VariableSizeReader::messageSize(data, j, &length).has_value());
+
+        std::optional<size_t> size =
+            VariableSizeReader::messageSize(data, sizeof(data), &length);
+        ASSERT_TRUE(size.has_value());
+        EXPECT_EQ(size.value(), sizes[i]);
+        EXPECT_EQ(length, lengths[i]);
+    }
+}
+
+TEST(VariableSizeTest, Stream)
+{
+    // Several sizes followed by each other are parsed one by one.
+    uint8_t data[16];
+    size_t data_size = 0;
+
+    VariableSizeWriter writer;
+    for (size_t size : { 5, 300, 70000 })
+    {
+        asio::const_buffer buffer = writer.variableSize(size);
+        memcpy(data + data_size, buffer.data(), buffer.size());
+        data_size += buffer.size();
+    }
+
+    size_t pos = 0;
+    size_t length = 0;
+
+    for (size_t expected : { 5, 300, 70000 })
+    {
+        std::optional<size_t> size =
+            VariableSizeReader::messageSize(data + pos, data_size - pos, &length);
+        ASSERT_TRUE(size.has_value());
+        EXPECT_EQ(size.value(), expected);
+        pos += length;
+    }
+
+    EXPECT_EQ(pos, data_size);
+}
+
+} // namespace base
@@ -0,0 +1,74 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#include "base/net/write_queue.h"
+
+#include "base/logging.h"
+
+namespace base {
+
+WriteQueue::WriteQueue() = default;
+
+WriteQueue::~WriteQueue() = default;
+
+void WriteQueue::push(ByteArray&& buffer, Priority priority)
+{
+    const int index = static_cast<int>(priority);
+    DCHECK_GE(index, 0);
+    DCHECK_LT(index, kNumberOfPriorities);
+
+    queue_[index].emplace_back(std::move(buffer));
+    ++size_;
+}
+
+const ByteArray& WriteQueue::front() const
+{
+    return queue_[frontIndex()].front();
+}
+
+ByteArray& WriteQueue::front()
+{
+    return queue_[frontIndex()].front();
+}
+
+ByteArray WriteQueue::pop()
+{
+    std::deque<ByteArray>& queue = queue_[frontIndex()];
+
+    ByteArray buffer = std::move(queue.front());
+    queue.pop_front();
+    --size_;
+
+    return buffer;
+}
+
+int WriteQueue::frontIndex() const
+{
+    DCHECK(!empty());
+
+    for (int i = 0; i < kNumberOfPriorities; ++i)
+    {
+        if (!queue_[i].empty())
+            return i;
+    }
+
+    NOTREACHED();
+    return 0;
+}
+
+} // namespace base
@@ -0,0 +1,74 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef BASE__NET__WRITE_QUEUE_H
+#define BASE__NET__WRITE_QUEUE_H
+
+#include "base/macros_magic.h"
+#include "base/memory/byte_array.h"
+
+#include <deque>
+
+namespace base {
+
+// Queue of outgoing messages with several priority classes. Messages of a higher priority are
+// taken before the messages of a lower priority. Messages of the same priority are taken in the
+// order in which they were added.
+class WriteQueue
+{
+public:
+    enum class Priority
+    {
+        CONTROL = 0, // Control messages and input events. Used by default.
+        CURSOR = 1,  // Small updates that must be delivered quickly (e.g. the mouse cursor).
+        VIDEO = 2,   // Large messages of a continuous stream (e.g. video frames).
+        BULK = 3     // Transfer of large amounts of data (e.g. files).
+    };
+
+    WriteQueue();
+    ~WriteQueue();
+
+    void push(ByteArray&& buffer, Priority priority);
+
+    // Returns the next message to be sent. The queue must not be empty.
+    const ByteArray& front() const;
+    ByteArray& front();
+
+    // Returns the priority of the next message. The queue must not be empty.
+    Priority frontPriority() const { return static_cast<Priority>(frontIndex()); }
+
+    // Removes the next message from the queue and returns it. The queue must not be empty.
+    ByteArray pop();
+
+    bool empty() const { return !size_; }
+    size_t size() const { return size_; }
+
+private:
+    static const int kNumberOfPriorities = 4;
+
+    int frontIndex() const;
+
+    std::deque<ByteArray> queue_[kNumberOfPriorities];
+    size_t size_ = 0;
+
+    DISALLOW_COPY_AND_ASSIGN(WriteQueue);
+};
+
+} // namespace base
+
+#endif // BASE__NET__WRITE_QUEUE_H
@@ -0,0 +1,160 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#include "base/net/write_queue.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+namespace base {
+
+namespace {
+
+ByteArray makeMessage(uint32_t value, size_t size)
+{
+    ByteArray buffer(std::max(size, sizeof(value)));
+    memcpy(buffer.data(), &value, sizeof(value));
+    return buffer;
+}
+
+uint32_t messageValue(const ByteArray& buffer)
+{
+    uint32_t value;
+    memcpy(&value, buffer.data(), sizeof(value));
+    return value;
+}
+
+// A file of 200 packets of 16 kB is queued at once and a control message is added 5 ms later. The
+// link sends 1000 bytes per millisecond and the writer takes the next message only when the
+// previous one is sent. Returns the time in milliseconds from adding the control message until it
+// is sent.
+uint32_t controlLatencyBehindFile(WriteQueue::Priority file_priority)
+{
+    static const size_t kLinkSpeed = 1000; // bytes per ms
+    static const size_t kPacketSize = 16 * 1024;
+    static const int kPacketCount = 200;
+    static const uint32_t kControlTime = 5; // ms
+
+    WriteQueue queue;
+    for (int i = 0; i < kPacketCount; ++i)
+        queue.push(makeMessage(0, kPacketSize), file_priority);
+
+    uint32_t busy_until = 0;
+
+    for (uint32_t now = 0; !queue.empty(); ++now)
+    {
+        if (now == kControlTime)
+            queue.push(makeMessage(now, 100), WriteQueue::Priority::CONTROL);
+
+        while (busy_until <= now && !queue.empty())
+        {
+            ByteArray buffer = queue.pop();
+            busy_until = std::max(busy_until, now) +
+                static_cast<uint32_t>((buffer.size() + kLinkSpeed - 1) / kLinkSpeed);
+
+            if (buffer.size() < kPacketSize)
+                return busy_until - messageValue(buffer);
+        }
+    }
+
+    return 0;
+}
+
+} // namespace
+
+TEST(WriteQueueTest, Order)
+{
+    WriteQueue queue;
+    EXPECT_TRUE(queue.empty());
+
+    queue.push(makeMessage(1, 4), WriteQueue::Priority::BULK);
+    queue.push(makeMessage(2, 4), WriteQueue::Priority::VIDEO);
+    queue.push(makeMessage(3, 4), WriteQueue::Priority::VIDEO);
+    queue.push(makeMessage(4, 4), WriteQueue::Priority::CONTROL);
+    queue.push(makeMessage(5, 4), WriteQueue::Priority::CURSOR);
+    queue.push(makeMessage(6, 4), WriteQueue::Priority::CONTROL);
+    EXPECT_EQ(queue.size(), 6U);
+
+    // Higher priorities first, the order of addition within the same priority.
+    const uint32_t expected[] = { 4, 6, 5, 2, 3, 1 };
+    for (uint32_t value : expected)
+    {
+        ASSERT_FALSE(queue.empty());
+        EXPECT_EQ(messageValue(queue.front()), value);
+        EXPECT_EQ(messageValue(queue.pop()), value);
+    }
+
+    EXPECT_TRUE(queue.empty());
+    EXPECT_EQ(queue.size(), 0U);
+}
+
+TEST(WriteQueueTest, Latency)
+{
+    // A link that sends 1000 bytes per millisecond is saturated by video frames of 100 kB every
+    // 50 ms (twice the speed of the link). Every 10 ms a small control message is added. The
+    // writer takes the next message only when the previous one is sent.
+    static const uint32_t kDuration = 2000; // ms
+    static const size_t kLinkSpeed = 1000; // bytes per ms
+    static const size_t kFrameSize = 100 * 1000;
+
+    WriteQueue queue;
+    uint32_t busy_until = 0;
+    uint32_t max_latency = 0;
+    int control_count = 0;
+
+    for (uint32_t now = 0; now < kDuration; ++now)
+    {
+        if (now % 50 == 0)
+            queue.push(makeMessage(now, kFrameSize), WriteQueue::Priority::VIDEO);
+
+        if (now % 10 == 5)
+            queue.push(makeMessage(now, 100), WriteQueue::Priority::CONTROL);
+
+        while (busy_until <= now && !queue.empty())
+        {
+            ByteArray buffer = queue.pop();
+            busy_until = std::max(busy_until, now) +
+                static_cast<uint32_t>((buffer.size() + kLinkSpeed - 1) / kLinkSpeed);
+
+            if (buffer.size() < kFrameSize)
+            {
+                max_latency = std::max(max_latency, busy_until - messageValue(buffer));
+                ++control_count;
+            }
+        }
+    }
+
+    EXPECT_GT(control_count, 150);
+
+    // A control message waits at most for one video frame that is already being sent (100 ms),
+    // although more than a second of video is waiting in the queue.
+    EXPECT_LE(max_latency, 101U);
+    EXPECT_GT(queue.size(), 10U);
+}
+
+TEST(WriteQueueTest, ControlBehindBulk)
+{
+    // A control message waits only for the file packet that is already being sent (17 ms).
+    EXPECT_LE(controlLatencyBehindFile(WriteQueue::Priority::BULK), 17U);
+
+    // In the same class it would wait for the whole file (more than 3 seconds).
+    EXPECT_GT(controlLatencyBehindFile(WriteQueue::Priority::CONTROL), 3000U);
+}
+
+} // namespace base
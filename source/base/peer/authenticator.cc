@@ -22,6 +22,7 @@
 #include "base/logging.h"
 #include "base/crypto/message_decryptor_openssl.h"
 #include "base/crypto/message_encryptor_openssl.h"
+#include "base/net/message_compressor.h"
 #include "base/strings/unicode.h"
 
 namespace base {
@@ -225,6 +226,17 @@ bool Authenticator::onSessionKeyChanged()
 
     channel_->setEncryptor(std::move(encryptor));
     channel_->setDecryptor(std::move(decryptor));
+
+    if (compression_ == proto::COMPRESSION_ZSTD)
+    {
+        std::unique_ptr<MessageCompressor> compressor =
+            MessageCompressor::create(compression_dictionary_);
+        if (!compressor)
+            return false;
+
+        channel_->setCompressor(std::move(compressor));
+    }
+
     return true;
 }
 
@@ -58,6 +58,7 @@ public:
 
     [[nodiscard]] proto::Identify identify() const { return identify_; }
     [[nodiscard]] proto::Encryption encryption() const { return encryption_; }
+    [[nodiscard]] proto::Compression compression() const { return compression_; }
     [[nodiscard]] const Version& peerVersion() const { return peer_version_; }
     [[nodiscard]] const std::u16string& peerOsName() const { return peer_os_name_; }
     [[nodiscard]] const std::u16string& peerComputerName() const { return peer_computer_name_; }
@@ -93,6 +94,8 @@ protected:
     [[nodiscard]] bool onSessionKeyChanged();
 
     proto::Encryption encryption_ = proto::ENCRYPTION_UNKNOWN;
+    proto::Compression compression_ = proto::COMPRESSION_NONE;
+    uint32_t compression_dictionary_ = 0;
     proto::Identify identify_ = proto::IDENTIFY_SRP;
     ByteArray session_key_;
     ByteArray encrypt_iv_;
@@ -27,6 +27,7 @@
 #include "base/crypto/random.h"
 #include "base/crypto/srp_constants.h"
 #include "base/crypto/srp_math.h"
+#include "base/net/message_compressor.h"
 #include "base/strings/unicode.h"
 #include "build/version.h"
 
@@ -220,6 +221,8 @@ void ClientAuthenticator::sendClientHello()
 
     client_hello.set_encryption(encryption);
     client_hello.set_identify(identify_);
+    client_hello.set_compression(proto::COMPRESSION_ZSTD);
+    client_hello.set_compression_dictionary(MessageCompressor::dictionaryId());
 
     if (!peer_public_key_.empty())
     {
@@ -291,6 +294,31 @@ bool ClientAuthenticator::readServerHello(const ByteArray& buffer)
             return false;
     }
 
+    compression_ = server_hello.compression();
+    compression_dictionary_ = server_hello.compression_dictionary();
+
+    switch (compression_)
+    {
+        case proto::COMPRESSION_NONE:
+            break;
+
+        case proto::COMPRESSION_ZSTD:
+        {
+            // The server can only select the dictionary offered by the client.
+            if (compression_dictionary_ &&
+                compression_dictionary_ != MessageCompressor::dictionaryId())
+            {
+                finish(FROM_HERE, ErrorCode::PROTOCOL_ERROR);
+                return false;
+            }
+        }
+        break;
+
+        default:
+            finish(FROM_HERE, ErrorCode::PROTOCOL_ERROR);
+            return false;
+    }
+
     decrypt_iv_ = fromStdString(server_hello.iv());
 
     if (session_key_.empty() != decrypt_iv_.empty())
@@ -27,6 +27,7 @@
 #include "base/crypto/random.h"
 #include "base/crypto/srp_constants.h"
 #include "base/crypto/srp_math.h"
+#include "base/net/message_compressor.h"
 #include "base/peer/user.h"
 #include "base/strings/unicode.h"
 #include "build/version.h"
@@ -335,6 +336,20 @@ void ServerAuthenticator::onClientHello(const ByteArray& buffer)
         server_hello.set_encryption(proto::ENCRYPTION_CHACHA20_POLY1305);
     }
 
+    if (client_hello.compression() & proto::COMPRESSION_ZSTD)
+    {
+        compression_ = proto::COMPRESSION_ZSTD;
+
+        // The dictionary is used only if both sides have the same one.
+        if (client_hello.compression_dictionary() == MessageCompressor::dictionaryId())
+            compression_dictionary_ = client_hello.compression_dictionary();
+
+        LOG(LS_INFO) << "Using zstd compression (dictionary: " << compression_dictionary_ << ")";
+
+        server_hello.set_compression(compression_);
+        server_hello.set_compression_dictionary(compression_dictionary_);
+    }
+
     // Now we are in the authentication phase.
     internal_state_ = InternalState::SEND_SERVER_HELLO;
     encryption_ = server_hello.encryption();
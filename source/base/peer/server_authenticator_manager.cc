@@ -19,19 +19,166 @@
 #include "base/peer/server_authenticator_manager.h"
 
 #include "base/logging.h"
+#include "base/message_loop/message_loop.h"
 #include "base/task_runner.h"
 
+#include <mutex>
+#include <set>
+
 namespace base {
 
+class ServerAuthenticatorManager::ThreadDelegate
+    : public NetworkServer::Delegate,
+      public ServerAuthenticatorManager::Delegate
+{
+public:
+    explicit ThreadDelegate(const ServerAuthenticatorManager& owner)
+        : owner_task_runner_(owner.task_runner_),
+          owner_handle_(owner.handle_),
+          user_list_(owner.user_list_),
+          private_key_(owner.private_key_),
+          anonymous_access_(owner.anonymous_access_),
+          anonymous_session_types_(owner.anonymous_session_types_)
+    {
+        // Nothing
+    }
+
+    ~ThreadDelegate() override
+    {
+        // The delegate is destroyed on its thread before the message loop of the thread. The
+        // channels that have not yet been attached to the thread of the owner use the I/O context
+        // of this thread, so they are deleted here. An attach that is in progress is completed
+        // first.
+        std::scoped_lock lock(transfers_->lock);
+
+        for (const auto& session : transfers_->sessions)
+            session->channel.reset();
+
+        transfers_->sessions.clear();
+    }
+
+    // NetworkServer::Delegate implementation.
+    void onNewConnection(std::unique_ptr<NetworkChannel> channel) override
+    {
+        // The delegate is created on the thread of the owner, so the manager of the thread is
+        // created on the first connection.
+        if (!manager_)
+        {
+            manager_ = std::make_unique<ServerAuthenticatorManager>(
+                MessageLoop::current()->taskRunner(), this);
+
+            if (user_list_)
+                manager_->setUserList(user_list_);
+            manager_->setPrivateKey(private_key_);
+            manager_->setAnonymousAccess(anonymous_access_, anonymous_session_types_);
+        }
+
+        LOG(LS_INFO) << "New connection: " << channel->peerAddress();
+        manager_->addNewChannel(std::move(channel));
+    }
+
+    // ServerAuthenticatorManager::Delegate implementation.
+    void onNewSession(SessionInfo&& session_info) override
+    {
+        std::shared_ptr<SessionInfo> session = std::make_shared<SessionInfo>(
+            std::move(session_info));
+        std::shared_ptr<Transfers> transfers = transfers_;
+        std::shared_ptr<TaskRunner> owner_task_runner = owner_task_runner_;
+        std::shared_ptr<Handle> owner_handle = owner_handle_;
+
+        {
+            std::scoped_lock lock(transfers->lock);
+            transfers->sessions.insert(session);
+        }
+
+        // The notification comes while the channel is completing the last write of the
+        // authenticator. The channel is detached after that.
+        manager_->task_runner_->postTask([session, transfers, owner_task_runner, owner_handle]()
+        {
+            // The channel is deleted if the delegate was destroyed.
+            NetworkChannel* channel = session->channel.get();
+            if (!channel)
+                return;
+
+            bool detached = channel->detach([session, transfers, owner_task_runner, owner_handle]()
+            {
+                if (!session->channel)
+                    return;
+
+                owner_task_runner->postTask([session, transfers, owner_handle]()
+                {
+                    {
+                        std::scoped_lock lock(transfers->lock);
+
+                        // The channel was deleted on its thread.
+                        if (!transfers->sessions.erase(session))
+                            return;
+
+                        if (!session->channel->attach())
+                        {
+                            LOG(LS_WARNING) << "Unable to move the channel to the owner thread";
+
+                            // The I/O context of the channel exists while the lock is held.
+                            session->channel.reset();
+                            return;
+                        }
+                    }
+
+                    ServerAuthenticatorManager* manager = owner_handle->manager;
+                    if (manager)
+                        manager->delegate_->onNewSession(std::move(*session));
+                });
+            });
+
+            if (!detached)
+            {
+                LOG(LS_WARNING) << "Unable to detach the channel from the authentication thread";
+
+                std::scoped_lock lock(transfers->lock);
+                transfers->sessions.erase(session);
+                session->channel.reset();
+            }
+        });
+    }
+
+private:
+    // Sessions whose channels are being moved to the thread of the owner. The channel is attached
+    // by the owner while the lock is held, and before that it can be deleted by the delegate.
+    struct Transfers
+    {
+        std::mutex lock;
+        std::set<std::shared_ptr<SessionInfo>> sessions;
+    };
+
+    std::shared_ptr<Transfers> transfers_ = std::make_shared<Transfers>();
+
+    std::shared_ptr<TaskRunner> owner_task_runner_;
+    std::shared_ptr<Handle> owner_handle_;
+
+    std::shared_ptr<UserList> user_list_;
+    ByteArray private_key_;
+    ServerAuthenticator::AnonymousAccess anonymous_access_;
+    uint32_t anonymous_session_types_;
+
+    std::unique_ptr<ServerAuthenticatorManager> manager_;
+
+    DISALLOW_COPY_AND_ASSIGN(ThreadDelegate);
+};
+
 ServerAuthenticatorManager::ServerAuthenticatorManager(
     std::shared_ptr<TaskRunner> task_runner, Delegate* delegate)
-    : task_runner_(std::move(task_runner)),
+    : handle_(std::make_shared<Handle>()),
+      task_runner_(std::move(task_runner)),
       delegate_(delegate)
 {
     DCHECK(task_runner_ && delegate_);
+    handle_->manager = this;
 }
 
-ServerAuthenticatorManager::~ServerAuthenticatorManager() = default;
+ServerAuthenticatorManager::~ServerAuthenticatorManager()
+{
+    handle_->manager = nullptr;
+}
 
 void ServerAuthenticatorManager::setUserList(std::shared_ptr<UserList> user_list)
 {
@@ -82,6 +229,11 @@ void ServerAuthenticatorManager::addNewChannel(std::unique_ptr<NetworkChannel> c
         std::move(channel), std::bind(&ServerAuthenticatorManager::onComplete, this));
 }
 
+std::unique_ptr<NetworkServer::Delegate> ServerAuthenticatorManager::createThreadDelegate()
+{
+    return std::make_unique<ThreadDelegate>(*this);
+}
+
 void ServerAuthenticatorManager::onComplete()
 {
     for (auto it = pending_.begin(); it != pending_.end();)
@@ -19,6 +19,7 @@
 #ifndef BASE__PEER__SERVER_AUTHENTICATOR_MANAGER_H
 #define BASE__PEER__SERVER_AUTHENTICATOR_MANAGER_H
 
+#include "base/net/network_server.h"
 #include "base/peer/server_authenticator.h"
 
 namespace base {
@@ -68,9 +69,26 @@ public:
     // If authentication fails, the channel will be automatically deleted.
     void addNewChannel(std::unique_ptr<NetworkChannel> channel);
 
+    // Creates a delegate for a thread of NetworkServer (see NetworkServer::start with the number of
+    // threads). The channels received by the delegate are authenticated on its thread with the
+    // current settings of the manager, so authentication of many connections is performed in
+    // parallel. Authenticated channels are moved to the thread of the manager and passed to
+    // Delegate::onNewSession. If the manager is destroyed before that, the channels are deleted.
+    std::unique_ptr<NetworkServer::Delegate> createThreadDelegate();
+
 private:
+    class ThreadDelegate;
+
+    // Points to the manager while it exists. Used only on the thread of the manager.
+    struct Handle
+    {
+        ServerAuthenticatorManager* manager = nullptr;
+    };
+
     void onComplete();
 
+    std::shared_ptr<Handle> handle_;
+
     std::shared_ptr<TaskRunner> task_runner_;
     std::shared_ptr<UserList> user_list_;
     std::vector<std::unique_ptr<ServerAuthenticator>> pending_;
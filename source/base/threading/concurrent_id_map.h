@@ -0,0 +1,225 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef BASE__THREADING__CONCURRENT_ID_MAP_H
+#define BASE__THREADING__CONCURRENT_ID_MAP_H
+
+#include "base/logging.h"
+#include "base/macros_magic.h"
+
+#include <atomic>
+#include <memory>
+
+namespace base {
+
+// Map of objects with integer identifiers that can be used from several threads at the same time
+// without locks. The map is an open addressing table with a fixed number of slots. The state of
+// each slot (identifier, state and number of readers) is stored in one atomic word, so adding,
+// finding and removing an object are done with atomic operations on this word.
+// Objects are returned as shared pointers, so an object found by one thread remains valid even if
+// another thread removes it from the map.
+template <typename T>
+class ConcurrentIdMap
+{
+public:
+    // The number of slots is rounded up to a power of two.
+    explicit ConcurrentIdMap(size_t capacity);
+    ~ConcurrentIdMap() = default;
+
+    size_t capacity() const { return mask_ + 1; }
+
+    // Adds an object with identifier |id|. Returns false if there are no free slots. Identifiers
+    // must be unique.
+    bool add(uint32_t id, std::shared_ptr<const T> object);
+
+    // Returns the object with identifier |id| or nullptr if it is not found.
+    std::shared_ptr<const T> find(uint32_t id) const;
+
+    // Removes the object with identifier |id|. Returns false if it is not found.
+    bool remove(uint32_t id);
+
+    // Removes all objects.
+    void clear();
+
+private:
+    enum State : uint64_t
+    {
+        STATE_EMPTY = 0, // The slot is free.
+        STATE_BUSY  = 1, // The slot is being filled or cleared.
+        STATE_READY = 2  // The slot contains an object.
+    };
+
+    // Layout of the slot word: bits 0-31 contain the identifier, bits 32-33 contain the state and
+    // the remaining bits contain the number of threads that are copying the pointer to the object.
+    static constexpr uint64_t kStateShift = 32;
+    static constexpr uint64_t kReaderShift = 34;
+    static constexpr uint64_t kOneReader = uint64_t(1) << kReaderShift;
+
+    static uint64_t makeWord(uint32_t id, State state)
+    {
+        return static_cast<uint64_t>(id) | (static_cast<uint64_t>(state) << kStateShift);
+    }
+
+    static uint32_t idOf(uint64_t word) { return static_cast<uint32_t>(word); }
+    static uint64_t stateOf(uint64_t word) { return (word >> kStateShift) & 3; }
+    static uint64_t readersOf(uint64_t word) { return word >> kReaderShift; }
+
+    struct Slot
+    {
+        std::atomic<uint64_t> word { 0 };
+
+        // Changed only in the STATE_BUSY state.
+        std::shared_ptr<const T> object;
+    };
+
+    Slot& slot(uint32_t id, size_t probe) const { return slots_[(id + probe) & mask_]; }
+    bool removeFromSlot(Slot* slot, uint32_t id);
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_;
+
+    // The maximum distance between the slot in which the object is stored and the slot that
+    // corresponds to its identifier. Searching does not go further than this distance.
+    // The value only grows: it is not decreased when objects are removed, so a search never misses
+    // an object that was moved further by a collision.
+    std::atomic<size_t> max_probe_ { 0 };
+
+    DISALLOW_COPY_AND_ASSIGN(ConcurrentIdMap);
+};
+
+template <typename T>
+ConcurrentIdMap<T>::ConcurrentIdMap(size_t capacity)
+{
+    DCHECK_GT(capacity, 0);
+
+    size_t size = 1;
+    while (size < capacity)
+        size <<= 1;
+
+    slots_ = std::make_unique<Slot[]>(size);
+    mask_ = size - 1;
+}
+
+template <typename T>
+bool ConcurrentIdMap<T>::add(uint32_t id, std::shared_ptr<const T> object)
+{
+    for (size_t probe = 0; probe <= mask_; ++probe)
+    {
+        Slot& current = slot(id, probe);
+
+        uint64_t expected = makeWord(0, STATE_EMPTY);
+        if (!current.word.compare_exchange_strong(expected, makeWord(id, STATE_BUSY)))
+            continue;
+
+        current.object = std::move(object);
+
+        // The distance must be visible before the object can be found. The release store pairs
+        // with the acquire load in find() and remove().
+        size_t max_probe = max_probe_.load(std::memory_order_relaxed);
+        while (max_probe < probe &&
+               !max_probe_.compare_exchange_weak(max_probe, probe, std::memory_order_release,
+                                                 std::memory_order_relaxed))
+        {
+            // Nothing
+        }
+
+        current.word.store(makeWord(id, STATE_READY), std::memory_order_release);
+        return true;
+    }
+
+    return false;
+}
+
+template <typename T>
+std::shared_ptr<const T> ConcurrentIdMap<T>::find(uint32_t id) const
+{
+    const size_t max_probe = max_probe_.load(std::memory_order_acquire);
+
+    for (size_t probe = 0; probe <= max_probe; ++probe)
+    {
+        Slot& current = slot(id, probe);
+        uint64_t word = current.word.load(std::memory_order_acquire);
+
+        while (stateOf(word) == STATE_READY && idOf(word) == id)
+        {
+            // While the number of readers is not zero, the object cannot be removed from the slot.
+            if (current.word.compare_exchange_weak(word, word + kOneReader))
+            {
+                std::shared_ptr<const T> object = current.object;
+                current.word.fetch_sub(kOneReader);
+                return object;
+            }
+        }
+    }
+
+    return nullptr;
+}
+
+template <typename T>
+bool ConcurrentIdMap<T>::remove(uint32_t id)
+{
+    const size_t max_probe = max_probe_.load(std::memory_order_acquire);
+
+    for (size_t probe = 0; probe <= max_probe; ++probe)
+    {
+        if (removeFromSlot(&slot(id, probe), id))
+            return true;
+    }
+
+    return false;
+}
+
+template <typename T>
+void ConcurrentIdMap<T>::clear()
+{
+    for (size_t i = 0; i <= mask_; ++i)
+    {
+        uint64_t word = slots_[i].word.load(std::memory_order_acquire);
+        if (stateOf(word) == STATE_READY)
+            removeFromSlot(&slots_[i], idOf(word));
+    }
+}
+
+template <typename T>
+bool ConcurrentIdMap<T>::removeFromSlot(Slot* slot, uint32_t id)
+{
+    uint64_t word = slot->word.load(std::memory_order_acquire);
+
+    while (stateOf(word) == STATE_READY && idOf(word) == id)
+    {
+        // Readers only copy the pointer, so the wait is short.
+        if (readersOf(word) != 0)
+        {
+            word = slot->word.load(std::memory_order_acquire);
+            continue;
+        }
+
+        if (slot->word.compare_exchange_weak(word, makeWord(id, STATE_BUSY)))
+        {
+            slot->object.reset();
+            slot->word.store(makeWord(0, STATE_EMPTY), std::memory_order_release);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+} // namespace base
+
+#endif // BASE__THREADING__CONCURRENT_ID_MAP_H
@@ -0,0 +1,150 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#include "base/threading/concurrent_id_map.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+namespace base {
+
+TEST(ConcurrentIdMapTest, Basic)
+{
+    ConcurrentIdMap<int> map(5);
+    EXPECT_EQ(map.capacity(), 8);
+
+    EXPECT_EQ(map.find(0), nullptr);
+    EXPECT_FALSE(map.remove(0));
+
+    for (uint32_t i = 0; i < 8; ++i)
+        EXPECT_TRUE(map.add(i * 8, std::make_shared<int>(i)));
+
+    // All slots are busy.
+    EXPECT_FALSE(map.add(100, std::make_shared<int>(100)));
+
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        std::shared_ptr<const int> value = map.find(i * 8);
+        ASSERT_NE(value, nullptr);
+        EXPECT_EQ(*value, static_cast<int>(i));
+    }
+
+    EXPECT_EQ(map.find(1), nullptr);
+
+    std::shared_ptr<const int> value = map.find(16);
+    EXPECT_TRUE(map.remove(16));
+    EXPECT_FALSE(map.remove(16));
+    EXPECT_EQ(map.find(16), nullptr);
+
+    // The object remains valid after removal.
+    EXPECT_EQ(*value, 2);
+
+    // The freed slot can be reused.
+    EXPECT_TRUE(map.add(100, std::make_shared<int>(100)));
+    EXPECT_EQ(*map.find(100), 100);
+    EXPECT_EQ(*map.find(56), 7);
+
+    map.clear();
+
+    for (uint32_t i = 0; i < 8; ++i)
+        EXPECT_EQ(map.find(i * 8), nullptr);
+    EXPECT_EQ(map.find(100), nullptr);
+}
+
+TEST(ConcurrentIdMapTest, Stress)
+{
+    static const int kWriterCount = 4;
+    static const int kReaderCount = 4;
+    static const uint32_t kIdsPerWriter = 20000;
+
+    ConcurrentIdMap<uint32_t> map(1024);
+
+    std::atomic<uint32_t> added { 0 };
+    std::atomic<uint32_t> removed { 0 };
+    std::atomic<bool> finished { false };
+    std::atomic<bool> failed { false };
+
+    std::vector<std::thread> threads;
+
+    // Each writer adds its own identifiers and removes them with a delay, so the map always
+    // contains objects of all writers.
+    for (int writer = 0; writer < kWriterCount; ++writer)
+    {
+        threads.emplace_back([&, writer]()
+        {
+            const uint32_t first = writer * kIdsPerWriter;
+            const uint32_t kWindow = 64;
+
+            for (uint32_t i = 0; i < kIdsPerWriter + kWindow; ++i)
+            {
+                if (i < kIdsPerWriter)
+                {
+                    if (!map.add(first + i, std::make_shared<uint32_t>(first + i)))
+                        failed = true;
+                    ++added;
+                }
+
+                if (i >= kWindow)
+                {
+                    if (!map.remove(first + i - kWindow))
+                        failed = true;
+                    ++removed;
+                }
+            }
+        });
+    }
+
+    // Readers look for random identifiers. An object that is found must always match its
+    // identifier.
+    for (int reader = 0; reader < kReaderCount; ++reader)
+    {
+        threads.emplace_back([&, reader]()
+        {
+            uint32_t state = 1234567 + reader;
+
+            while (!finished)
+            {
+                state = state * 1103515245 + 12345;
+                const uint32_t id = (state >> 8) % (kWriterCount * kIdsPerWriter);
+
+                std::shared_ptr<const uint32_t> value = map.find(id);
+                if (value && *value != id)
+                    failed = true;
+            }
+        });
+    }
+
+    for (int i = 0; i < kWriterCount; ++i)
+        threads[i].join();
+
+    finished = true;
+
+    for (size_t i = kWriterCount; i < threads.size(); ++i)
+        threads[i].join();
+
+    EXPECT_FALSE(failed);
+    EXPECT_EQ(added, kWriterCount * kIdsPerWriter);
+    EXPECT_EQ(removed, kWriterCount * kIdsPerWriter);
+
+    for (uint32_t id = 0; id < kWriterCount * kIdsPerWriter; ++id)
+        ASSERT_EQ(map.find(id), nullptr);
+}
+
+} // namespace base
@@ -54,6 +54,16 @@
 #define ARCH_CPU_X86           1
 #define ARCH_CPU_32_BITS       1
 #define ARCH_CPU_LITTLE_ENDIAN 1
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#define ARCH_CPU_ARM_FAMILY    1
+#define ARCH_CPU_ARM64         1
+#define ARCH_CPU_64_BITS       1
+#define ARCH_CPU_LITTLE_ENDIAN 1
+#elif defined(_M_ARM) || defined(__ARMEL__)
+#define ARCH_CPU_ARM_FAMILY    1
+#define ARCH_CPU_ARMEL         1
+#define ARCH_CPU_32_BITS       1
+#define ARCH_CPU_LITTLE_ENDIAN 1
 #else
 #error Unknown architecture
 #endif
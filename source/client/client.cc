@@ -88,9 +88,9 @@ proto::SessionType Client::sessionType() const
     return config_.session_type;
 }
 
-void Client::sendMessage(const google::protobuf::MessageLite& message)
+void Client::sendMessage(const google::protobuf::MessageLite& message, Priority priority)
 {
-    channel_->send(base::serialize(message));
+    channel_->send(message, priority);
 }
 
 int64_t Client::totalRx() const
@@ -120,8 +120,19 @@ void Client::onConnected()
     static const std::chrono::seconds kKeepAliveInterval{ 3 };
 
     channel_->setReadBufferSize(kReadBufferSize);
-    channel_->setKeepAlive(true, kKeepAliveTime, kKeepAliveInterval);
-    channel_->setNoDelay(true);
+
+    if (config_.session_type == proto::SESSION_TYPE_DESKTOP_MANAGE ||
+        config_.session_type == proto::SESSION_TYPE_DESKTOP_VIEW)
+    {
+        // The client receives the desktop stream, so ACKs are sent without delay.
+        channel_->setSocketProfile(
+            base::SocketProfile::forRole(base::SocketProfile::Role::DESKTOP_STREAM));
+    }
+    else
+    {
+        channel_->setKeepAlive(true, kKeepAliveTime, kKeepAliveInterval);
+        channel_->setNoDelay(true);
+    }
 
     authenticator_ = std::make_unique<base::ClientAuthenticator>(io_task_runner_);
 
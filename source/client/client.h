@@ -63,7 +63,9 @@ protected:
     virtual void onSessionStarted(const base::Version& peer_version) = 0;
 
     // Sends outgoing message.
-    void sendMessage(const google::protobuf::MessageLite& message);
+    using Priority = base::NetworkChannel::Priority;
+    void sendMessage(const google::protobuf::MessageLite& message,
+                     Priority priority = Priority::CONTROL);
 
     // Methods for obtaining network metrics.
     int64_t totalRx() const;
@@ -155,8 +155,8 @@ void ClientFileTransfer::doNextRemoteTask()
     if (remote_task_queue_.empty())
         return;
 
-    // Send a request to the remote computer.
-    sendMessage(remote_task_queue_.front()->request());
+    // Send a request to the remote computer. File data is sent after all other messages.
+    sendMessage(remote_task_queue_.front()->request(), Priority::BULK);
 }
 
 common::FileTaskFactory* ClientFileTransfer::taskFactory(common::FileTask::Target target)
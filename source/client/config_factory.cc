@@ -85,6 +85,9 @@ void ConfigFactory::fixupDesktopConfig(proto::DesktopConfig* config)
     config->set_scale_factor(100);
     config->set_update_interval(30);
 
+    // The client is always able to apply the moved areas of the screen.
+    config->set_flags(config->flags() | proto::ENABLE_MOVED_RECTS);
+
     if (config->compress_ratio() < kMinCompressRatio || config->compress_ratio() > kMaxCompressRatio)
         config->set_compress_ratio(kDefCompressRatio);
 }
@@ -54,11 +54,8 @@ void RouterController::onConnected()
 {
     LOG(LS_INFO) << "Connection to the router is established";
 
-    static const std::chrono::seconds kKeepAliveTime{ 30 };
-    static const std::chrono::seconds kKeepAliveInterval{ 3 };
-
-    channel_->setKeepAlive(true, kKeepAliveTime, kKeepAliveInterval);
-    channel_->setNoDelay(true);
+    channel_->setSocketProfile(
+        base::SocketProfile::forRole(base::SocketProfile::Role::ROUTER_CONTROL));
 
     authenticator_ = std::make_unique<base::ClientAuthenticator>(task_runner_);
 
@@ -103,9 +103,19 @@ std::shared_ptr<base::NetworkChannelProxy> ClientSession::channelProxy()
     return channel_->channelProxy();
 }
 
-void ClientSession::sendMessage(base::ByteArray&& buffer)
+void ClientSession::sendMessage(const google::protobuf::MessageLite& message, Priority priority)
 {
-    channel_->send(std::move(buffer));
+    channel_->send(message, priority);
+}
+
+void ClientSession::setWriteWatermarks(size_t low, size_t high)
+{
+    channel_->setWriteWatermarks(low, high);
+}
+
+void ClientSession::setSocketProfile(const base::SocketProfile& profile)
+{
+    channel_->setSocketProfile(profile);
 }
 
 void ClientSession::onConnected()
@@ -79,7 +79,11 @@ protected:
 
     virtual void onStarted() = 0;
     std::shared_ptr<base::NetworkChannelProxy> channelProxy();
-    void sendMessage(base::ByteArray&& buffer);
+    using Priority = base::NetworkChannel::Priority;
+    void sendMessage(const google::protobuf::MessageLite& message,
+                     Priority priority = Priority::CONTROL);
+    void setWriteWatermarks(size_t low, size_t high);
+    void setSocketProfile(const base::SocketProfile& profile);
 
     // base::NetworkChannel::Listener implementation.
     void onConnected() override;
@@ -34,6 +34,16 @@
 
 namespace host {
 
+namespace {
+
+// Limits for the number of bytes waiting to be sent. When the queue reaches the high watermark,
+// video frames are no longer encoded until it drops to the low watermark. This way the video does
+// not lag behind when the network is slower than the encoder.
+const size_t kWriteLowWatermark = 64 * 1024; // 64 kB
+const size_t kWriteHighWatermark = 256 * 1024; // 256 kB
+
+} // namespace
+
 ClientSessionDesktop::ClientSessionDesktop(
     proto::SessionType session_type, std::unique_ptr<base::NetworkChannel> channel)
     : ClientSession(session_type, std::move(channel))
@@ -112,8 +122,30 @@ void ClientSessionDesktop::onMessageWritten(size_t /* pending */)
     // Nothing
 }
 
+void ClientSessionDesktop::onWritableChanged(bool writable)
+{
+    video_paused_ = !writable;
+
+    // The skipped areas are sent with the next frame. If the screen does not change anymore, the
+    // next frame does not come, so the last frame is requested again.
+    if (writable && !skipped_region_.isEmpty() && desktop_session_proxy_)
+        desktop_session_proxy_->captureScreen();
+}
+
+void ClientSessionDesktop::onLinkEstimateUpdated(const base::LinkEstimator& estimator)
+{
+    if (!video_encoder_ || !estimator.deliveryRate())
+        return;
+
+    video_encoder_->setBandwidthEstimateKbps(
+        static_cast<int>(estimator.deliveryRate() * 8 / 1000));
+}
+
 void ClientSessionDesktop::onStarted()
 {
+    setWriteWatermarks(kWriteLowWatermark, kWriteHighWatermark);
+    setSocketProfile(base::SocketProfile::forRole(base::SocketProfile::Role::DESKTOP_STREAM));
+
     const char* extensions;
 
     // Supported extensions are different for managing and viewing the desktop.
@@ -135,51 +167,116 @@ void ClientSessionDesktop::onStarted()
     request->set_video_encodings(common::kSupportedVideoEncodings);
 
     // Send the request.
-    sendMessage(base::serialize(outgoing_message_));
+    sendMessage(outgoing_message_);
 }
 
 void ClientSessionDesktop::encode(const base::Frame* frame, const base::MouseCursor* cursor)
+{
+    // The cursor is sent in a separate message, so that it does not wait in the queue behind the
+    // video packets.
+    if (cursor && cursor_encoder_)
+    {
+        outgoing_message_.Clear();
+
+        if (cursor_encoder_->encode(*cursor, outgoing_message_.mutable_cursor_shape()))
+            sendMessage(outgoing_message_, Priority::CURSOR);
+    }
+
+    if (!frame || !video_encoder_ || !scale_reducer_)
+        return;
+
+    // The network does not keep up with the video, so the frame is not encoded.
+    if (video_paused_)
+    {
+        skipped_region_.addRegion(frame->constUpdatedRegion());
+        return;
+    }
+
+    if (skipped_region_.isEmpty())
+    {
+        encodeFrame(frame);
+        return;
+    }
+
+    // The frame is shared with other clients, so the skipped areas are added to its updated region
+    // only while the frame is encoded. The contents of the frame are current, so the skipped areas
+    // are encoded from it.
+    base::Region* frame_region = const_cast<base::Frame*>(frame)->updatedRegion();
+    base::Region original_region(*frame_region);
+
+    skipped_region_.intersectWith(base::Rect::makeSize(frame->size()));
+    frame_region->addRegion(skipped_region_);
+    skipped_region_.clear();
+
+    encodeFrame(frame);
+
+    frame_region->swap(&original_region);
+}
+
+void ClientSessionDesktop::encodeFrame(const base::Frame* frame)
 {
     outgoing_message_.Clear();
 
-    if (frame && video_encoder_ && scale_reducer_)
+    const base::Size& source_size = frame->size();
+
+    if (preferred_size_.width() > source_size.width() ||
+        preferred_size_.height() > source_size.height())
     {
-        const base::Size& source_size = frame->size();
+        preferred_size_ = source_size;
+    }
 
-        if (preferred_size_.width() > source_size.width() ||
-            preferred_size_.height() > source_size.height())
-        {
-            preferred_size_ = source_size;
-        }
+    if (preferred_size_.isEmpty())
+        preferred_size_ = source_size;
 
-        if (preferred_size_.isEmpty())
-            preferred_size_ = source_size;
+    const base::Frame* scaled_frame = scale_reducer_->scaleFrame(frame, preferred_size_);
+    if (!scaled_frame)
+        return;
 
-        const base::Frame* scaled_frame = scale_reducer_->scaleFrame(frame, preferred_size_);
-        if (!scaled_frame)
-            return;
+    proto::VideoPacket* packet = outgoing_message_.mutable_video_packet();
 
-        proto::VideoPacket* packet = outgoing_message_.mutable_video_packet();
+    base::Region updated_region;
+    moved_rects_.clear();
 
-        // Encode the frame into a video packet.
-        video_encoder_->encode(scaled_frame, packet);
+    if (scroll_detector_)
+    {
+        // The client receives a scaled image, the moves are searched only in the original one.
+        if (scaled_frame == frame)
+            scroll_detector_->detect(*frame, &moved_rects_, &updated_region);
+        else
+            scroll_detector_->reset();
+    }
+
+    // The frame is shared with other clients, so the areas that are sent as moves are removed
+    // from its updated region only while the frame is encoded.
+    base::Region* frame_region = const_cast<base::Frame*>(frame)->updatedRegion();
+
+    if (!moved_rects_.empty())
+    {
+        frame_region->swap(&updated_region);
 
-        if (packet->has_format())
+        for (const auto& moved_rect : moved_rects_)
         {
-            proto::Size* screen_size = packet->mutable_format()->mutable_screen_size();
-            screen_size->set_width(frame->size().width());
-            screen_size->set_height(frame->size().height());
+            proto::MovedRect* packet_moved_rect = packet->add_moved_rect();
+            base::serializeRect(moved_rect.dest_rect, packet_moved_rect->mutable_dest_rect());
+            packet_moved_rect->set_source_x(moved_rect.source_pos.x());
+            packet_moved_rect->set_source_y(moved_rect.source_pos.y());
         }
     }
 
-    if (cursor && cursor_encoder_)
+    // Encode the frame into a video packet.
+    video_encoder_->encode(scaled_frame, packet);
+
+    if (!moved_rects_.empty())
+        frame_region->swap(&updated_region);
+
+    if (packet->has_format())
     {
-        if (!cursor_encoder_->encode(*cursor, outgoing_message_.mutable_cursor_shape()))
-            outgoing_message_.clear_cursor_shape();
+        proto::Size* screen_size = packet->mutable_format()->mutable_screen_size();
+        screen_size->set_width(frame->size().width());
+        screen_size->set_height(frame->size().height());
     }
 
-    if (outgoing_message_.has_video_packet() || outgoing_message_.has_cursor_shape())
-        sendMessage(base::serialize(outgoing_message_));
+    sendMessage(outgoing_message_, Priority::VIDEO);
 }
 
 void ClientSessionDesktop::setScreenList(const proto::ScreenList& list)
@@ -190,7 +287,7 @@ void ClientSessionDesktop::setScreenList(const proto::ScreenList& list)
     extension->set_name(common::kSelectScreenExtension);
     extension->set_data(list.SerializeAsString());
 
-    sendMessage(base::serialize(outgoing_message_));
+    sendMessage(outgoing_message_);
 }
 
 void ClientSessionDesktop::injectClipboardEvent(const proto::ClipboardEvent& event)
@@ -200,7 +297,7 @@ void ClientSessionDesktop::injectClipboardEvent(const proto::ClipboardEvent& eve
         outgoing_message_.Clear();
 
         outgoing_message_.mutable_clipboard_event()->CopyFrom(event);
-        sendMessage(base::serialize(outgoing_message_));
+        sendMessage(outgoing_message_);
     }
 }
 
@@ -284,7 +381,7 @@ void ClientSessionDesktop::readExtension(const proto::DesktopExtension& extensio
         desktop_extension->set_name(common::kSystemInfoExtension);
         desktop_extension->set_data(system_info.SerializeAsString());
 
-        sendMessage(base::serialize(outgoing_message_));
+        sendMessage(outgoing_message_);
     }
     else
     {
@@ -326,6 +423,15 @@ void ClientSessionDesktop::readConfig(const proto::DesktopConfig& config)
     cursor_encoder_.reset();
     if (config.flags() & proto::ENABLE_CURSOR_SHAPE)
         cursor_encoder_ = std::make_unique<base::CursorEncoder>();
+
+    // The moves are applied to the image that the client already has, so they are sent only with
+    // the lossless encoding.
+    scroll_detector_.reset();
+    if ((config.flags() & proto::ENABLE_MOVED_RECTS) &&
+        config.video_encoding() == proto::VIDEO_ENCODING_ZSTD)
+    {
+        scroll_detector_ = std::make_unique<base::ScrollDetector>();
+    }
     
     scale_reducer_ = std::make_unique<base::ScaleReducer>();
 
@@ -343,6 +449,7 @@ void ClientSessionDesktop::readConfig(const proto::DesktopConfig& config)
     LOG(LS_INFO) << "NEW CLIENT CONFIGURATION";
     LOG(LS_INFO) << "Video encoding: " << config.video_encoding();
     LOG(LS_INFO) << "Enable cursor shape: " << (cursor_encoder_ != nullptr);
+    LOG(LS_INFO) << "Enable moved rects: " << (scroll_detector_ != nullptr);
     LOG(LS_INFO) << "Disable font smoothing: " << desktop_session_config_.disable_font_smoothing;
     LOG(LS_INFO) << "Disable desktop effects: " << desktop_session_config_.disable_effects;
     LOG(LS_INFO) << "Disable desktop wallpaper: " << desktop_session_config_.disable_wallpaper;
@@ -21,6 +21,8 @@
 
 #include "base/macros_magic.h"
 #include "base/desktop/geometry.h"
+#include "base/desktop/region.h"
+#include "base/desktop/scroll_detector.h"
 #include "host/client_session.h"
 #include "host/desktop_session.h"
 
@@ -55,11 +57,14 @@ protected:
     // net::Listener implementation.
     void onMessageReceived(const base::ByteArray& buffer) override;
     void onMessageWritten(size_t pending) override;
+    void onWritableChanged(bool writable) override;
+    void onLinkEstimateUpdated(const base::LinkEstimator& estimator) override;
 
     // ClientSession implementation.
     void onStarted() override;
 
 private:
+    void encodeFrame(const base::Frame* frame);
     void readExtension(const proto::DesktopExtension& extension);
     void readConfig(const proto::DesktopConfig& config);
 
@@ -67,9 +72,20 @@ private:
     std::unique_ptr<base::ScaleReducer> scale_reducer_;
     std::unique_ptr<base::VideoEncoder> video_encoder_;
     std::unique_ptr<base::CursorEncoder> cursor_encoder_;
+
+    // Searches for the moved areas of the screen if the client supports them. The areas are sent
+    // as moves and are not encoded.
+    std::unique_ptr<base::ScrollDetector> scroll_detector_;
+    std::vector<base::ScrollDetector::MovedRect> moved_rects_;
+
     DesktopSession::Config desktop_session_config_;
     base::Size preferred_size_;
 
+    // True if the video packets are not sent, because the previous ones are still in the queue.
+    // The areas of the skipped frames are added to the next frame to be encoded.
+    bool video_paused_ = false;
+    base::Region skipped_region_;
+
     proto::ClientToHost incoming_message_;
     proto::HostToClient outgoing_message_;
 
@@ -20,11 +20,15 @@
 
 #include "base/logging.h"
 #include "base/task_runner.h"
+#include "base/files/file_util.h"
 #include "base/peer/client_authenticator.h"
 #include "proto/router_common.pb.h"
+#include "relay/key_factory.h"
 #include "relay/session_manager.h"
 #include "relay/settings.h"
 
+#include <sstream>
+
 #if defined(OS_WIN)
 #include "base/files/base_paths.h"
 #include "base/net/firewall_manager.h"
@@ -36,6 +40,113 @@ namespace {
 
 const std::chrono::seconds kReconnectTimeout{ 30 };
 
+// Number of session keys that are generated in advance.
+const size_t kKeyReserveSize = 100;
+
+// Writes a metric in the Prometheus text format.
+void writeMetric(std::ostream& out,
+                 std::string_view name,
+                 std::string_view type,
+                 std::string_view help,
+                 uint64_t value)
+{
+    out << "# HELP " << name << ' ' << help << '\n'
+        << "# TYPE " << name << ' ' << type << '\n'
+        << name << ' ' << value << '\n';
+}
+
+// Writes the statistics to the file in the Prometheus text format. The file is replaced
+// atomically, so it can be read by an external collector at any time.
+bool writeStatFile(const std::filesystem::path& file_path, const proto::RelayStat& stat)
+{
+    std::ostringstream out;
+
+    writeMetric(out, "aspia_relay_pending_sessions", "gauge",
+                "Number of peers that are waiting for the opposite peer.",
+                stat.pending_sessions());
+    writeMetric(out, "aspia_relay_active_sessions", "gauge",
+                "Number of active sessions.", stat.active_sessions());
+    writeMetric(out, "aspia_relay_sessions_total", "counter",
+                "Number of sessions since the relay started.", stat.total_sessions());
+    writeMetric(out, "aspia_relay_bytes_total", "counter",
+                "Number of bytes transferred since the relay started.", stat.bytes_transferred());
+    writeMetric(out, "aspia_relay_speed_bytes", "gauge",
+                "Current speed of all sessions in bytes per second.", stat.speed());
+    writeMetric(out, "aspia_relay_key_reserve", "gauge",
+                "Number of session keys generated in advance.", stat.key_reserve());
+    writeMetric(out, "aspia_relay_key_generation_microseconds", "gauge",
+                "Average time of generating one session key.", stat.key_generation_time());
+    writeMetric(out, "aspia_relay_key_reserve_misses_total", "counter",
+                "Number of keys generated on demand because the reserve was empty.",
+                stat.key_reserve_misses());
+
+    struct SessionMetric
+    {
+        const char* name;
+        const char* type;
+        const char* help;
+        uint64_t (*value)(const proto::RelayStat::Direction& direction);
+    };
+
+    static const SessionMetric kSessionMetrics[] =
+    {
+        { "aspia_relay_session_bytes_total", "counter",
+          "Number of bytes received from the peer.",
+          [](const proto::RelayStat::Direction& direction) { return direction.bytes(); } },
+        { "aspia_relay_session_packets_total", "counter",
+          "Number of read operations from the peer.",
+          [](const proto::RelayStat::Direction& direction) { return direction.packets(); } },
+        { "aspia_relay_session_speed_bytes", "gauge",
+          "Current speed in bytes per second.",
+          [](const proto::RelayStat::Direction& direction) { return direction.speed(); } },
+        { "aspia_relay_session_buffer_size_bytes", "gauge",
+          "Size of the session buffer.",
+          [](const proto::RelayStat::Direction& direction)
+          {
+              return static_cast<uint64_t>(direction.buffer_size());
+          } },
+        { "aspia_relay_session_buffer_usage_bytes", "gauge",
+          "Number of bytes in the session buffer.",
+          [](const proto::RelayStat::Direction& direction)
+          {
+              return static_cast<uint64_t>(direction.buffer_usage());
+          } },
+        { "aspia_relay_session_write_stall_milliseconds_total", "counter",
+          "Time during which reading was paused because the opposite peer did not accept data.",
+          [](const proto::RelayStat::Direction& direction)
+          {
+              return direction.write_stall_time();
+          } }
+    };
+
+    for (const SessionMetric& metric : kSessionMetrics)
+    {
+        out << "# HELP " << metric.name << ' ' << metric.help << '\n'
+            << "# TYPE " << metric.name << ' ' << metric.type << '\n';
+
+        // Sessions are labeled with their identifiers, so the counters of a session are not mixed
+        // with the counters of others when sessions are removed from the list.
+        for (const proto::RelayStat::Session& session : stat.session())
+        {
+            for (int j = 0; j < session.direction_size(); ++j)
+            {
+                out << metric.name << "{session=\"" << session.id() << "\",direction=\"" << j
+                    << "\"} " << metric.value(session.direction(j)) << '\n';
+            }
+        }
+    }
+
+    std::filesystem::path temp_path = file_path;
+    temp_path += ".tmp";
+
+    if (!base::writeFile(temp_path, out.str()))
+        return false;
+
+    std::error_code error_code;
+    std::filesystem::rename(temp_path, file_path, error_code);
+    return !error_code;
+}
+
 #if defined(OS_WIN)
 const wchar_t kFirewallRuleName[] = L"Aspia Relay Service";
 const wchar_t kFirewallRuleDecription[] = L"Allow incoming TCP connections";
@@ -46,6 +157,7 @@ const wchar_t kFirewallRuleDecription[] = L"Allow incoming TCP connections";
 Controller::Controller(std::shared_ptr<base::TaskRunner> task_runner)
     : task_runner_(task_runner),
       reconnect_timer_(task_runner),
+      stat_timer_(task_runner),
       shared_pool_(std::make_unique<SharedPool>())
 {
     Settings settings;
@@ -62,9 +174,25 @@ Controller::Controller(std::shared_ptr<base::TaskRunner> task_runner)
     // Peers settings.
     peer_port_ = settings.peerPort();
     max_peer_count_ = settings.maxPeerCount();
+    worker_thread_count_ = settings.workerThreadCount();
+    max_session_buffer_size_ = settings.maxSessionBufferSize();
+    zero_copy_forwarding_ = settings.zeroCopyForwarding();
+    session_rate_limit_ = settings.sessionRateLimit();
+    total_rate_limit_ = settings.totalRateLimit();
 
     LOG(LS_INFO) << "Peer port: " << peer_port_;
     LOG(LS_INFO) << "Max peer count: " << max_peer_count_;
+    LOG(LS_INFO) << "Max session buffer size: " << max_session_buffer_size_;
+    LOG(LS_INFO) << "Zero-copy forwarding: " << zero_copy_forwarding_;
+    LOG(LS_INFO) << "Session rate limit: " << session_rate_limit_;
+    LOG(LS_INFO) << "Total rate limit: " << total_rate_limit_;
+
+    // Statistics settings.
+    stat_interval_ = std::chrono::seconds(settings.statInterval());
+    stat_file_ = settings.statFile();
+
+    LOG(LS_INFO) << "Stat interval: " << stat_interval_.count();
+    LOG(LS_INFO) << "Stat file: " << stat_file_;
 }
 
 Controller::~Controller()
@@ -106,9 +234,28 @@ bool Controller::start()
     addFirewallRules(peer_port_);
 #endif // defined(OS_WIN)
 
-    session_manager_ = std::make_unique<SessionManager>(task_runner_, peer_port_);
+    session_manager_ = std::make_unique<SessionManager>(
+        task_runner_, peer_port_, worker_thread_count_);
+    session_manager_->setMaxSessionBufferSize(max_session_buffer_size_);
+    session_manager_->setRateLimit(session_rate_limit_, total_rate_limit_);
+
+    if (zero_copy_forwarding_)
+    {
+#if defined(OS_LINUX)
+        session_manager_->setSessionEngine(Session::Engine::SPLICE);
+#else
+        LOG(LS_WARNING) << "Zero-copy forwarding is not supported on this platform";
+#endif // defined(OS_LINUX)
+    }
+
     session_manager_->start(shared_pool_->share());
 
+    // Keys are generated in advance, so that requests from the router are answered immediately.
+    key_factory_ = std::make_unique<KeyFactory>(kKeyReserveSize);
+
+    if (stat_interval_.count() > 0)
+        stat_timer_.start(stat_interval_, std::bind(&Controller::onStatTimer, this));
+
     connectToRouter();
     return true;
 }
@@ -117,11 +264,8 @@ void Controller::onConnected()
 {
     LOG(LS_INFO) << "Connection to the router is established";
 
-    static const std::chrono::seconds kKeepAliveTime{ 30 };
-    static const std::chrono::seconds kKeepAliveInterval{ 3 };
-
-    channel_->setKeepAlive(true, kKeepAliveTime, kKeepAliveInterval);
-    channel_->setNoDelay(true);
+    channel_->setSocketProfile(
+        base::SocketProfile::forRole(base::SocketProfile::Role::ROUTER_CONTROL));
 
     authenticator_ = std::make_unique<base::ClientAuthenticator>(task_runner_);
 
@@ -182,22 +326,34 @@ void Controller::onMessageReceived(const base::ByteArray& buffer)
     outgoing_message_.Clear();
 
     // Add the requested number of keys to the pool.
-    for (uint32_t i = 0; i < incoming_message_.key_pool_request().pool_size(); ++i)
+    std::vector<SessionKey> keys =
+        key_factory_->takeKeys(incoming_message_.key_pool_request().pool_size());
+
+    for (size_t i = 0; i < keys.size(); ++i)
     {
-        SessionKey session_key = SessionKey::create();
-        if (!session_key.isValid())
-            return;
+        SessionKey& session_key = keys[i];
+
+        std::string public_key = base::toStdString(session_key.publicKey());
+        std::string iv = base::toStdString(session_key.iv());
+
+        // Add the key to the pool.
+        uint32_t key_id = shared_pool_->addKey(std::move(session_key));
+        if (key_id == SharedPool::kInvalidKeyId)
+        {
+            LOG(LS_WARNING) << "Key pool is full (capacity: " << SharedPool::kDefaultCapacity
+                            << "). " << keys.size() - i << " of " << keys.size()
+                            << " keys dropped";
+            break;
+        }
 
         // Add the key to the outgoing message.
         proto::RelayKey* key = outgoing_message_.mutable_key_pool()->add_key();
 
         key->set_type(proto::RelayKey::TYPE_X25519);
         key->set_encryption(proto::RelayKey::ENCRYPTION_CHACHA20_POLY1305);
-        key->set_public_key(base::toStdString(session_key.publicKey()));
-        key->set_iv(base::toStdString(session_key.iv()));
-
-        // Add the key to the pool.
-        key->set_key_id(shared_pool_->addKey(std::move(session_key)));
+        key->set_public_key(std::move(public_key));
+        key->set_iv(std::move(iv));
+        key->set_key_id(key_id);
     }
 
     // Send a message to the router.
@@ -227,6 +383,23 @@ void Controller::delayedConnectToRouter()
     reconnect_timer_.start(kReconnectTimeout, std::bind(&Controller::connectToRouter, this));
 }
 
+void Controller::onStatTimer()
+{
+    outgoing_message_.Clear();
+
+    proto::RelayStat* stat = outgoing_message_.mutable_stat();
+    session_manager_->stat(stat);
+    key_factory_->stat(stat);
+
+    if (!stat_file_.empty() && !writeStatFile(stat_file_, *stat))
+        LOG(LS_WARNING) << "Unable to write statistics to file: " << stat_file_;
+
+    // Statistics are sent only if the connection to the router is established.
+    if (channel_ && channel_->isConnected())
+        channel_->send(base::serialize(outgoing_message_));
+
+    stat_timer_.start(stat_interval_, std::bind(&Controller::onStatTimer, this));
+}
 
 #if defined(OS_WIN)
 void Controller::addFirewallRules(uint16_t port)
@@ -25,12 +25,15 @@
 #include "proto/router_relay.pb.h"
 #include "relay/shared_pool.h"
 
+#include <filesystem>
+
 namespace base {
 class ClientAuthenticator;
 } // namespace base
 
 namespace relay {
 
+class KeyFactory;
 class SessionManager;
 
 class Controller : public base::NetworkChannel::Listener
@@ -51,6 +54,7 @@ protected:
 private:
     void connectToRouter();
     void delayedConnectToRouter();
+    void onStatTimer();
 
 #if defined(OS_WIN)
     void addFirewallRules(uint16_t port);
@@ -65,11 +69,22 @@ private:
     // Peers settings.
     uint16_t peer_port_ = 0;
     size_t max_peer_count_ = 0;
+    size_t worker_thread_count_ = 0;
+    size_t max_session_buffer_size_ = 0;
+    bool zero_copy_forwarding_ = false;
+    int64_t session_rate_limit_ = 0;
+    int64_t total_rate_limit_ = 0;
+
+    // Statistics settings.
+    std::chrono::seconds stat_interval_;
+    std::filesystem::path stat_file_;
 
     std::shared_ptr<base::TaskRunner> task_runner_;
     base::WaitableTimer reconnect_timer_;
+    base::WaitableTimer stat_timer_;
     std::unique_ptr<base::NetworkChannel> channel_;
     std::unique_ptr<base::ClientAuthenticator> authenticator_;
+    std::unique_ptr<KeyFactory> key_factory_;
     std::unique_ptr<SharedPool> shared_pool_;
     std::unique_ptr<SessionManager> session_manager_;
 
@@ -0,0 +1,147 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#include "relay/key_factory.h"
+
+#include "base/logging.h"
+#include "base/task_runner.h"
+
+namespace relay {
+
+KeyFactory::KeyFactory(size_t reserve_size)
+    : reserve_size_(reserve_size)
+{
+    thread_.start(base::MessageLoop::Type::DEFAULT);
+
+    refill_posted_ = true;
+    thread_.taskRunner()->postTask(std::bind(&KeyFactory::generateKey, this));
+}
+
+KeyFactory::~KeyFactory()
+{
+    // Unfinished tasks are deleted without execution.
+    thread_.stop();
+}
+
+std::vector<SessionKey> KeyFactory::takeKeys(size_t count)
+{
+    std::vector<SessionKey> keys;
+    keys.reserve(count);
+
+    bool post_refill = false;
+
+    {
+        std::scoped_lock lock(lock_);
+
+        while (keys.size() < count && !reserve_.empty())
+        {
+            keys.emplace_back(std::move(reserve_.front()));
+            reserve_.pop_front();
+        }
+
+        if (keys.size() < count)
+            reserve_misses_ += count - keys.size();
+
+        if (!refill_posted_)
+        {
+            refill_posted_ = true;
+            post_refill = true;
+        }
+    }
+
+    if (post_refill)
+        thread_.taskRunner()->postTask(std::bind(&KeyFactory::generateKey, this));
+
+    if (keys.size() < count)
+    {
+        LOG(LS_WARNING) << "Not enough keys in reserve. Missing keys: " << count - keys.size();
+
+        while (keys.size() < count)
+        {
+            SessionKey key = createKey();
+            if (!key.isValid())
+                break;
+
+            keys.emplace_back(std::move(key));
+        }
+    }
+
+    return keys;
+}
+
+void KeyFactory::stat(proto::RelayStat* stat)
+{
+    std::scoped_lock lock(lock_);
+
+    stat->set_key_reserve(static_cast<uint32_t>(reserve_.size()));
+    stat->set_key_reserve_misses(reserve_misses_);
+
+    if (generated_keys_)
+    {
+        stat->set_key_generation_time(
+            static_cast<uint64_t>(generation_time_.count()) / generated_keys_);
+    }
+
+    generated_keys_ = 0;
+    generation_time_ = std::chrono::microseconds::zero();
+}
+
+void KeyFactory::generateKey()
+{
+    // One key is generated per task, so the thread can be stopped at any time.
+    SessionKey key = createKey();
+    if (!key.isValid())
+    {
+        LOG(LS_ERROR) << "Unable to generate session key";
+
+        std::scoped_lock lock(lock_);
+        refill_posted_ = false;
+        return;
+    }
+
+    {
+        std::scoped_lock lock(lock_);
+
+        reserve_.emplace_back(std::move(key));
+        if (reserve_.size() >= reserve_size_)
+        {
+            refill_posted_ = false;
+            return;
+        }
+    }
+
+    thread_.taskRunner()->postTask(std::bind(&KeyFactory::generateKey, this));
+}
+
+SessionKey KeyFactory::createKey()
+{
+    const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+    SessionKey key = SessionKey::create();
+
+    const std::chrono::microseconds time = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start_time);
+
+    std::scoped_lock lock(lock_);
+    ++generated_keys_;
+    generation_time_ += time;
+
+    return key;
+}
+
+} // namespace relay
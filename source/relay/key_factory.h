@@ -0,0 +1,69 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+#ifndef RELAY__KEY_FACTORY_H
+#define RELAY__KEY_FACTORY_H
+
+#include "base/threading/thread.h"
+#include "proto/router_relay.pb.h"
+#include "relay/session_key.h"
+
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace relay {
+
+// Keeps a reserve of session keys that are generated in advance on a separate thread, so that
+// the keys requested by the router can be sent without delay.
+class KeyFactory
+{
+public:
+    explicit KeyFactory(size_t reserve_size);
+    ~KeyFactory();
+
+    // Takes |count| keys from the reserve and starts refilling it. If there are not enough keys
+    // in the reserve, then the missing keys are generated on the calling thread.
+    std::vector<SessionKey> takeKeys(size_t count);
+
+    // Fills in the statistics of key generation. The average generation time is calculated since
+    // the previous call.
+    void stat(proto::RelayStat* stat);
+
+private:
+    void generateKey();
+    SessionKey createKey();
+
+    const size_t reserve_size_;
+    base::Thread thread_;
+
+    std::mutex lock_;
+    std::deque<SessionKey> reserve_;
+    bool refill_posted_ = false;
+
+    // Statistics. Protected by |lock_|.
+    uint64_t generated_keys_ = 0;
+    std::chrono::microseconds generation_time_ { 0 };
+    uint64_t reserve_misses_ = 0;
+
+    DISALLOW_COPY_AND_ASSIGN(KeyFactory);
+};
+
+} // namespace relay
+
+#endif // RELAY__KEY_FACTORY_H
@@ -0,0 +1,70 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+
+#include "relay/peer_index.h"
+
+#include "base/logging.h"
+#include "relay/pending_session.h"
+
+#include <string_view>
+
+namespace relay {
+
+size_t PeerIndex::PeerKeyHash::operator()(const PeerKey& key) const
+{
+    std::string_view secret(reinterpret_cast<const char*>(key.second.data()), key.second.size());
+    return std::hash<std::string_view>()(secret) ^ std::hash<uint32_t>()(key.first);
+}
+
+PeerIndex::PeerIndex() = default;
+
+PeerIndex::~PeerIndex() = default;
+
+PendingSession* PeerIndex::takePeerOrAdd(PendingSession* session)
+{
+    DCHECK(!session->secret().empty());
+
+    PeerKey peer_key(session->keyId(), session->secret());
+
+    auto other = sessions_.find(peer_key);
+    if (other == sessions_.end())
+    {
+        // The opposite peer is not connected yet.
+        sessions_.emplace(std::move(peer_key), session);
+        return nullptr;
+    }
+
+    PendingSession* other_session = other->second;
+    sessions_.erase(other);
+
+    DCHECK(session->isPeerFor(*other_session));
+    return other_session;
+}
+
+void PeerIndex::remove(PendingSession* session)
+{
+    if (session->secret().empty())
+        return;
+
+    auto it = sessions_.find(PeerKey(session->keyId(), session->secret()));
+    if (it != sessions_.end() && it->second == session)
+        sessions_.erase(it);
+}
+
+} // namespace relay
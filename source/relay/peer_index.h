@@ -0,0 +1,67 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+
+#ifndef RELAY__PEER_INDEX_H
+#define RELAY__PEER_INDEX_H
+
+#include "base/macros_magic.h"
+#include "base/memory/byte_array.h"
+
+#include <unordered_map>
+
+namespace relay {
+
+class PendingSession;
+
+// Authenticated pending sessions that are waiting for the opposite peer. Sessions are indexed by
+// the identifier of the shared key and the decrypted secret, so the opposite peer is found and a
+// session is removed in constant time regardless of the number of waiting sessions.
+class PeerIndex
+{
+public:
+    PeerIndex();
+    ~PeerIndex();
+
+    // If a session with the same key identifier and secret as |session| is waiting, then removes
+    // it from the index and returns it. Otherwise adds |session| to the index and returns nullptr.
+    // The identifier and the secret of |session| must be set.
+    PendingSession* takePeerOrAdd(PendingSession* session);
+
+    // Removes |session| from the index if it is waiting for the opposite peer.
+    void remove(PendingSession* session);
+
+    size_t size() const { return sessions_.size(); }
+
+private:
+    // The identifier of the shared key and the decrypted secret.
+    using PeerKey = std::pair<uint32_t, base::ByteArray>;
+
+    struct PeerKeyHash
+    {
+        size_t operator()(const PeerKey& key) const;
+    };
+
+    std::unordered_map<PeerKey, PendingSession*, PeerKeyHash> sessions_;
+
+    DISALLOW_COPY_AND_ASSIGN(PeerIndex);
+};
+
+} // namespace relay
+
+#endif // RELAY__PEER_INDEX_H
@@ -0,0 +1,169 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+
+#include "relay/peer_index.h"
+
+#include "base/message_loop/message_loop.h"
+#include "base/message_loop/message_pump_asio.h"
+#include "relay/pending_session.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstring>
+
+namespace relay {
+
+namespace {
+
+base::ByteArray makeSecret(uint64_t value)
+{
+    base::ByteArray secret(16);
+    memcpy(secret.data(), &value, sizeof(value));
+    return secret;
+}
+
+class PeerIndexTest : public testing::Test
+{
+protected:
+    std::unique_ptr<PendingSession> createSession(uint32_t key_id, uint64_t secret)
+    {
+        std::unique_ptr<PendingSession> session = std::make_unique<PendingSession>(
+            message_loop_.taskRunner(),
+            asio::ip::tcp::socket(message_loop_.pumpAsio()->ioContext()),
+            nullptr);
+        session->setIdentify(key_id, makeSecret(secret));
+        return session;
+    }
+
+    std::vector<std::unique_ptr<PendingSession>> createSessions(size_t count, uint64_t first_secret)
+    {
+        std::vector<std::unique_ptr<PendingSession>> sessions;
+        sessions.reserve(count);
+
+        for (size_t i = 0; i < count; ++i)
+            sessions.emplace_back(createSession(static_cast<uint32_t>(i % 4096), first_secret + i));
+
+        return sessions;
+    }
+
+    // Returns the average time in nanoseconds of one operation when |waiting_count| sessions are
+    // waiting. The operations are an arrival of a new peer, an arrival of the opposite peer of a
+    // waiting session and a removal of a waiting session. |waiting_count| must be at least 2000.
+    double operationTime(size_t waiting_count);
+
+private:
+    base::MessageLoop message_loop_ { base::MessageLoop::Type::ASIO };
+};
+
+double PeerIndexTest::operationTime(size_t waiting_count)
+{
+    const size_t kOperations = 1000;
+
+    std::vector<std::unique_ptr<PendingSession>> waiting = createSessions(waiting_count, 0);
+    std::vector<std::unique_ptr<PendingSession>> opposite = createSessions(kOperations, 0);
+    std::vector<std::unique_ptr<PendingSession>> arriving =
+        createSessions(kOperations, waiting_count);
+
+    PeerIndex index;
+    for (auto& session : waiting)
+        EXPECT_EQ(index.takePeerOrAdd(session.get()), nullptr);
+
+    const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < kOperations; ++i)
+    {
+        index.takePeerOrAdd(arriving[i].get());
+        index.takePeerOrAdd(opposite[i].get());
+        index.remove(waiting[waiting_count - i - 1].get());
+    }
+
+    const std::chrono::nanoseconds time = std::chrono::steady_clock::now() - start_time;
+
+    EXPECT_EQ(index.size(), waiting_count - kOperations);
+    return static_cast<double>(time.count()) / static_cast<double>(kOperations * 3);
+}
+
+} // namespace
+
+TEST_F(PeerIndexTest, PairsPeers)
+{
+    std::unique_ptr<PendingSession> first = createSession(1, 100);
+    std::unique_ptr<PendingSession> second = createSession(1, 100);
+
+    PeerIndex index;
+    EXPECT_EQ(index.takePeerOrAdd(first.get()), nullptr);
+    EXPECT_EQ(index.size(), 1u);
+
+    EXPECT_EQ(index.takePeerOrAdd(second.get()), first.get());
+    EXPECT_EQ(index.size(), 0u);
+}
+
+TEST_F(PeerIndexTest, DifferentKeyOrSecret)
+{
+    std::unique_ptr<PendingSession> first = createSession(1, 100);
+    std::unique_ptr<PendingSession> other_key = createSession(2, 100);
+    std::unique_ptr<PendingSession> other_secret = createSession(1, 101);
+
+    PeerIndex index;
+    EXPECT_EQ(index.takePeerOrAdd(first.get()), nullptr);
+    EXPECT_EQ(index.takePeerOrAdd(other_key.get()), nullptr);
+    EXPECT_EQ(index.takePeerOrAdd(other_secret.get()), nullptr);
+    EXPECT_EQ(index.size(), 3u);
+}
+
+TEST_F(PeerIndexTest, Remove)
+{
+    std::unique_ptr<PendingSession> first = createSession(1, 100);
+    std::unique_ptr<PendingSession> second = createSession(1, 100);
+    std::unique_ptr<PendingSession> third = createSession(1, 100);
+
+    PeerIndex index;
+    EXPECT_EQ(index.takePeerOrAdd(first.get()), nullptr);
+
+    // A session with the same key that is not in the index does not remove the waiting one.
+    index.remove(second.get());
+    EXPECT_EQ(index.size(), 1u);
+
+    index.remove(first.get());
+    EXPECT_EQ(index.size(), 0u);
+
+    EXPECT_EQ(index.takePeerOrAdd(second.get()), nullptr);
+    EXPECT_EQ(index.takePeerOrAdd(third.get()), second.get());
+}
+
+TEST_F(PeerIndexTest, FlatCostWith50kPeers)
+{
+    // The best of several runs is compared, so a single delay of the thread does not fail the test.
+    double small_time = std::numeric_limits<double>::max();
+    double large_time = std::numeric_limits<double>::max();
+
+    for (int i = 0; i < 3; ++i)
+    {
+        small_time = std::min(small_time, operationTime(2000));
+        large_time = std::min(large_time, operationTime(50000));
+    }
+
+    // A linear scan would be 25 times slower with 50k waiting peers. The margin allows for cache
+    // misses in the larger table.
+    EXPECT_LT(large_time, small_time * 5)
+        << "2k peers: " << small_time << " ns, 50k peers: " << large_time << " ns";
+}
+
+} // namespace relay
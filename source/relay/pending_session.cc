@@ -27,6 +27,7 @@ namespace relay {
 namespace {
 
 constexpr std::chrono::seconds kTimeout{ 30 };
+constexpr uint32_t kMaxMessageSize = 8192;
 
 } // namespace
 
@@ -98,12 +99,14 @@ void PendingSession::doReadMessage(PendingSession* session)
         }
 
         session->buffer_size_ = base::Endian::fromBig(session->buffer_size_);
-        if (!session->buffer_size_ || session->buffer_size_ > session->buffer_.size())
+        if (!session->buffer_size_ || session->buffer_size_ > kMaxMessageSize)
         {
             session->onErrorOccurred();
             return;
         }
 
+        session->buffer_.resize(session->buffer_size_);
+
         asio::async_read(session->socket_,
                          asio::buffer(session->buffer_.data(), session->buffer_size_),
                          [session](const std::error_code& error_code, size_t bytes_transferred)
@@ -131,12 +134,15 @@ void PendingSession::onErrorOccurred()
 void PendingSession::onMessage()
 {
     proto::PeerToRelay message;
-    if (!message.ParseFromArray(buffer_.data(), buffer_.size()))
+    if (!base::parse(buffer_, &message))
     {
         onErrorOccurred();
         return;
     }
 
+    // The message is no longer needed.
+    base::ByteArray().swap(buffer_);
+
     if (delegate_)
         delegate_->onPendingSessionReady(this, message);
 }
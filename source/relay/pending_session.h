@@ -67,6 +67,9 @@ public:
     // Returns true if the other session is a pair and false otherwise.
     bool isPeerFor(const PendingSession& other) const;
 
+    uint32_t keyId() const { return key_id_; }
+    const base::ByteArray& secret() const { return secret_; }
+
     // Releases a socket from a class.
     asio::ip::tcp::socket takeSocket();
 
@@ -80,8 +83,10 @@ private:
     base::WaitableTimer timer_;
     asio::ip::tcp::socket socket_;
 
+    // The buffer is allocated only when the size of the message is received, so a peer that has
+    // not sent anything does not consume memory for it.
     uint32_t buffer_size_ = 0;
-    std::array<uint8_t, 8192> buffer_;
+    base::ByteArray buffer_;
 
     base::ByteArray secret_;
     uint32_t key_id_ = -1;
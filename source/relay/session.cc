@@ -18,29 +18,123 @@
 
 #include "relay/session.h"
 
+#include "base/logging.h"
+#include "base/memory/buffer_pool.h"
+#include "base/net/token_bucket.h"
+
 #include <asio/write.hpp>
 
+#if defined(OS_LINUX)
+#include <fcntl.h>
+#include <unistd.h>
+#endif // defined(OS_LINUX)
+
 namespace relay {
 
-Session::Session(std::pair<asio::ip::tcp::socket, asio::ip::tcp::socket>&& sockets)
-    : socket_{ std::move(sockets.first), std::move(sockets.second) }
+namespace {
+
+// If the number of consecutive reads, each of which filled less than 1/kShrinkRatio of the
+// buffer, reaches kShrinkReadCount, then the buffer is halved.
+const size_t kShrinkRatio = 8;
+const int kShrinkReadCount = 16;
+
+// When the speed is limited, reading is resumed only when at least kMinReadQuota bytes can be read.
+// This prevents many small reads at low speeds.
+const int64_t kMinReadQuota = 4 * 1024;
+
+#if defined(OS_LINUX)
+// Maximum number of bytes moved by one call of splice(2). Equal to the default pipe capacity.
+const size_t kPipeSize = 64 * 1024;
+
+const int kPipeRead = 0;
+const int kPipeWrite = 1;
+#endif // defined(OS_LINUX)
+
+} // namespace
+
+Session::Session(std::shared_ptr<base::TaskRunner> task_runner,
+                 std::pair<asio::ip::tcp::socket, asio::ip::tcp::socket>&& sockets,
+                 Engine engine)
+    : task_runner_(std::move(task_runner)),
+      engine_(engine),
+      start_time_(std::chrono::high_resolution_clock::now()),
+      socket_{ std::move(sockets.first), std::move(sockets.second) },
+      shaping_timer_{ asio::steady_timer(socket_[0].get_executor()),
+                      asio::steady_timer(socket_[1].get_executor()) }
 {
-    for (size_t i = 0; i < kNumberOfSides; ++i)
-        std::fill(buffer_[i].begin(), buffer_[i].end(), 0);
+    if (engine_ == Engine::SPLICE)
+    {
+#if defined(OS_LINUX)
+        if (!initSplice())
+        {
+            LOG(LS_WARNING) << "Unable to initialize splice. Buffered data transfer is used";
+            engine_ = Engine::BUFFER;
+        }
+#else
+        engine_ = Engine::BUFFER;
+#endif // defined(OS_LINUX)
+    }
 }
 
 Session::~Session()
 {
     stop();
+
+#if defined(OS_LINUX)
+    for (int i = 0; i < kNumberOfSides; ++i)
+    {
+        for (int j = 0; j < 2; ++j)
+        {
+            if (pipe_[i][j] != -1)
+                close(pipe_[i][j]);
+        }
+    }
+#endif // defined(OS_LINUX)
+}
+
+void Session::setMaxBufferSize(size_t size)
+{
+    max_buffer_size_ = std::clamp(size, kMinBufferSize, kMaxBufferSize);
+}
+
+void Session::setBufferPool(std::shared_ptr<base::BufferPool> buffer_pool)
+{
+    buffer_pool_ = std::move(buffer_pool);
+}
+
+void Session::setRateLimit(std::unique_ptr<base::TokenBucket> session_bucket,
+                           std::shared_ptr<base::TokenBucket> total_bucket)
+{
+    session_bucket_ = std::move(session_bucket);
+    total_bucket_ = std::move(total_bucket);
 }
 
 void Session::start(Delegate* delegate)
 {
-    start_time_ = std::chrono::high_resolution_clock::now();
     delegate_ = delegate;
 
     for (int i = 0; i < kNumberOfSides; ++i)
+    {
+#if defined(OS_LINUX)
+        if (engine_ == Engine::SPLICE)
+        {
+            Session::doSpliceRead(this, i);
+            continue;
+        }
+#endif // defined(OS_LINUX)
+
+        // Reading is done in non-blocking mode (see doReadSome).
+        std::error_code error_code;
+        socket_[i].non_blocking(true, error_code);
+        if (error_code)
+        {
+            LOG(LS_WARNING) << "Unable to set non-blocking mode: " << error_code.message();
+            onErrorOccurred();
+            return;
+        }
+
         Session::doReadSome(this, i);
+    }
 }
 
 void Session::stop()
@@ -53,6 +147,7 @@ void Session::stop()
     std::error_code ignored_code;
     for (int i = 0; i < kNumberOfSides; ++i)
     {
+        shaping_timer_[i].cancel();
         socket_[i].cancel(ignored_code);
         socket_[i].close(ignored_code);
     }
@@ -68,43 +163,454 @@ std::chrono::seconds Session::duration() const
 
 int64_t Session::bytesTransferred() const
 {
-    return bytes_transferred_;
+    int64_t result = 0;
+
+    for (int i = 0; i < kNumberOfSides; ++i)
+        result += stat_[i].bytes.load(std::memory_order_relaxed);
+
+    return result;
+}
+
+void Session::stat(const std::chrono::milliseconds& interval, proto::RelayStat::Session* stat)
+{
+    stat->set_id(id_);
+    stat->set_duration(duration().count());
+
+    for (int i = 0; i < kNumberOfSides; ++i)
+    {
+        DirectionStat& source = stat_[i];
+        proto::RelayStat::Direction* target = stat->add_direction();
+
+        const int64_t bytes = source.bytes.load(std::memory_order_relaxed);
+
+        target->set_bytes(bytes);
+        target->set_packets(source.packets.load(std::memory_order_relaxed));
+        target->set_buffer_size(source.buffer_size.load(std::memory_order_relaxed));
+        target->set_buffer_usage(source.buffer_usage.load(std::memory_order_relaxed));
+        target->set_write_stall_time(
+            source.write_stall_time.load(std::memory_order_relaxed) / 1000);
+
+        if (interval.count() > 0)
+            target->set_speed((bytes - source.sampled_bytes) * 1000 / interval.count());
+
+        source.sampled_bytes = bytes;
+    }
 }
 
 // static
 void Session::doReadSome(Session* session, int source)
 {
-    session->socket_[source].async_read_some(
-        asio::buffer(session->buffer_[source].data(), session->buffer_[source].size()),
+    base::RingBuffer& buffer = session->buffer_[source];
+
+    for (;;)
+    {
+        if (!buffer.capacity())
+        {
+            // The session is idle and does not hold a buffer. It is taken from the pool only when
+            // the data arrives.
+            doWaitRead(session, source);
+            return;
+        }
+
+        // Reading resumes when the data is written to the opposite socket.
+        if (buffer.isFull())
+        {
+            session->beginWriteStall(source);
+            return;
+        }
+
+        size_t quota;
+        if (waitForQuota(session, source, &quota))
+            return;
+
+        std::array<base::RingBuffer::Region, 2> regions = buffer.freeRegions();
+        regions[0].size = std::min(regions[0].size, quota);
+        regions[1].size = std::min(regions[1].size, quota - regions[0].size);
+
+        std::array<asio::mutable_buffer, 2> buffers =
+        {
+            asio::buffer(regions[0].data, regions[0].size),
+            asio::buffer(regions[1].data, regions[1].size)
+        };
+
+        // The socket is in non-blocking mode, so the read does not block. Reading is done without
+        // an asynchronous operation, so the buffer is not held while the peer is silent.
+        std::error_code error_code;
+        size_t bytes_transferred = session->socket_[source].read_some(buffers, error_code);
+        if (error_code)
+        {
+            if (error_code == asio::error::would_block)
+            {
+                session->releaseBuffer(source);
+                doWaitRead(session, source);
+                return;
+            }
+
+            if (error_code == asio::error::interrupted)
+                continue;
+
+            // If the peer has closed the connection, then we send the remaining data first.
+            if (error_code == asio::error::eof && session->writing_[source])
+                session->eof_[source] = true;
+            else
+                session->onErrorOccurred();
+            return;
+        }
+
+        if (bytes_transferred == buffer.freeSpace())
+        {
+            // All free space is filled. Most likely, the peer has more data to send.
+            session->grow_buffer_[source] = true;
+            session->small_reads_[source] = 0;
+        }
+        else if (bytes_transferred < buffer.capacity() / kShrinkRatio)
+        {
+            ++session->small_reads_[source];
+        }
+        else
+        {
+            session->small_reads_[source] = 0;
+        }
+
+        buffer.commit(bytes_transferred);
+        session->onDataRead(source, bytes_transferred);
+
+        if (!session->writing_[source])
+        {
+            session->adjustBufferSize(source);
+            doWriteSome(session, source);
+        }
+
+        session->updateBufferStat(source, buffer.capacity(), buffer.size());
+    }
+}
+
+// static
+void Session::doWaitRead(Session* session, int source)
+{
+    // Waiting for the data without a buffer (on Windows this is a zero-byte read).
+    session->reading_[source] = true;
+
+    session->socket_[source].async_wait(asio::ip::tcp::socket::wait_read,
+                                        [session, source](const std::error_code& error_code)
+    {
+        if (error_code)
+        {
+            if (error_code != asio::error::operation_aborted)
+                session->onErrorOccurred();
+            return;
+        }
+
+        session->reading_[source] = false;
+        session->acquireBuffer(source);
+
+        doReadSome(session, source);
+    });
+}
+
+// static
+void Session::doWriteSome(Session* session, int source)
+{
+    base::RingBuffer& buffer = session->buffer_[source];
+    if (buffer.isEmpty())
+        return;
+
+    std::array<base::RingBuffer::ConstRegion, 2> regions = buffer.dataRegions();
+    std::array<asio::const_buffer, 2> buffers =
+    {
+        asio::const_buffer(regions[0].data, regions[0].size),
+        asio::const_buffer(regions[1].data, regions[1].size)
+    };
+
+    session->writing_[source] = true;
+
+    session->socket_[(source + kNumberOfSides - 1) % kNumberOfSides].async_write_some(buffers,
         [session, source](const std::error_code& error_code, size_t bytes_transferred)
     {
         if (error_code)
         {
             if (error_code != asio::error::operation_aborted)
                 session->onErrorOccurred();
+            return;
         }
-        else
+
+        session->writing_[source] = false;
+
+        base::RingBuffer& buffer = session->buffer_[source];
+        buffer.consume(bytes_transferred);
+        session->updateBufferStat(source, buffer.capacity(), buffer.size());
+
+        if (session->eof_[source])
+        {
+            if (buffer.isEmpty())
+                session->onErrorOccurred();
+            else
+                doWriteSome(session, source);
+            return;
+        }
+
+        if (!session->reading_[source])
+        {
+            // Reading was stopped because the buffer is full. The write is started first, because
+            // reading can start writing by itself.
+            session->endWriteStall(source);
+            session->grow_buffer_[source] = true;
+            session->adjustBufferSize(source);
+            doWriteSome(session, source);
+            doReadSome(session, source);
+            return;
+        }
+
+        if (buffer.isEmpty())
         {
-            session->bytes_transferred_ += bytes_transferred;
+            // All data is sent and the peer is silent.
+            session->releaseBuffer(source);
+            return;
+        }
+
+        doWriteSome(session, source);
+    });
+}
+
+void Session::adjustBufferSize(int source)
+{
+    // The buffer can be reallocated only when there are no read and write operations in progress.
+    DCHECK(!reading_[source] && !writing_[source]);
+
+    size_t capacity = buffer_capacity_[source];
 
-            asio::async_write(
-                session->socket_[(source + kNumberOfSides - 1) % kNumberOfSides],
-                asio::const_buffer(session->buffer_[source].data(), bytes_transferred),
-                [session, source](const std::error_code& error_code, size_t bytes_transferred)
+    if (grow_buffer_[source])
+    {
+        capacity = std::min(capacity * 2, max_buffer_size_);
+        grow_buffer_[source] = false;
+    }
+    else if (small_reads_[source] >= kShrinkReadCount)
+    {
+        capacity = std::max(capacity / 2, kMinBufferSize);
+        small_reads_[source] = 0;
+    }
+
+    base::RingBuffer& buffer = buffer_[source];
+
+    // If the buffer is not allocated now, then the new size is applied when it is taken from the
+    // pool.
+    if (!buffer.capacity())
+    {
+        buffer_capacity_[source] = capacity;
+        return;
+    }
+
+    if (capacity != buffer.capacity() && capacity >= buffer.size())
+    {
+        buffer_capacity_[source] = capacity;
+        buffer.resize(capacity);
+        updateBufferStat(source, buffer.capacity(), buffer.size());
+    }
+}
+
+void Session::acquireBuffer(int source)
+{
+    base::RingBuffer& buffer = buffer_[source];
+    if (buffer.capacity())
+        return;
+
+    const size_t capacity = buffer_capacity_[source];
+    buffer.assign(buffer_pool_ ? buffer_pool_->acquire(capacity) : base::ByteArray(capacity));
+
+    updateBufferStat(source, buffer.capacity(), buffer.size());
+}
+
+void Session::releaseBuffer(int source)
+{
+    base::RingBuffer& buffer = buffer_[source];
+    if (!buffer.capacity() || !buffer.isEmpty() || writing_[source])
+        return;
+
+    if (buffer_pool_)
+        buffer_pool_->release(buffer.release());
+    else
+        buffer.release();
+
+    updateBufferStat(source, 0, 0);
+}
+
+// static
+bool Session::waitForQuota(Session* session, int source, size_t* quota)
+{
+    *quota = std::numeric_limits<size_t>::max();
+
+    base::TokenBucket* buckets[] = { session->session_bucket_.get(), session->total_bucket_.get() };
+    if (!buckets[0] && !buckets[1])
+        return false;
+
+    const base::TokenBucket::TimePoint now = base::TokenBucket::Clock::now();
+    std::chrono::milliseconds delay = std::chrono::milliseconds::zero();
+
+    for (base::TokenBucket* bucket : buckets)
+    {
+        if (!bucket)
+            continue;
+
+        delay = std::max(delay, bucket->delay(kMinReadQuota, now));
+        *quota = std::min(*quota, static_cast<size_t>(bucket->available(now)));
+    }
+
+    if (delay == std::chrono::milliseconds::zero())
+    {
+        if (*quota > 0)
+            return false;
+
+        // Another session has taken the tokens of the shared bucket in the meantime.
+        delay = std::chrono::milliseconds(1);
+    }
+
+    // The operation is considered to be in progress while waiting, so the completion of writing
+    // does not start reading.
+    session->reading_[source] = true;
+
+    asio::steady_timer& timer = session->shaping_timer_[source];
+    timer.expires_after(delay);
+    timer.async_wait([session, source](const std::error_code& error_code)
+    {
+        if (error_code)
+            return;
+
+        session->reading_[source] = false;
+
+#if defined(OS_LINUX)
+        if (session->engine_ == Engine::SPLICE)
+        {
+            doSpliceRead(session, source);
+            return;
+        }
+#endif // defined(OS_LINUX)
+
+        if (!session->writing_[source])
+            session->adjustBufferSize(source);
+
+        doReadSome(session, source);
+    });
+
+    return true;
+}
+
+#if defined(OS_LINUX)
+bool Session::initSplice()
+{
+    for (int i = 0; i < kNumberOfSides; ++i)
+    {
+        if (pipe2(pipe_[i], O_NONBLOCK | O_CLOEXEC) != 0)
+        {
+            PLOG(LS_WARNING) << "pipe2 failed";
+            return false;
+        }
+
+        // splice(2) does not block only if the socket is in non-blocking mode.
+        std::error_code error_code;
+        socket_[i].native_non_blocking(true, error_code);
+        if (error_code)
+        {
+            LOG(LS_WARNING) << "Unable to set non-blocking mode: " << error_code.message();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// static
+void Session::doSpliceRead(Session* session, int source)
+{
+    size_t quota;
+    if (waitForQuota(session, source, &quota))
+        return;
+
+    session->socket_[source].async_wait(asio::ip::tcp::socket::wait_read,
+                                        [session, source, quota](const std::error_code& error_code)
+    {
+        if (error_code)
+        {
+            if (error_code != asio::error::operation_aborted)
+                session->onErrorOccurred();
+            return;
+        }
+
+        // Move the incoming data from the socket to the pipe.
+        ssize_t result = splice(session->socket_[source].native_handle(), nullptr,
+                                session->pipe_[source][kPipeWrite], nullptr,
+                                std::min(kPipeSize, quota),
+                                SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        if (result < 0)
+        {
+            if (errno == EAGAIN || errno == EINTR)
+                doSpliceRead(session, source);
+            else
+                session->onErrorOccurred();
+            return;
+        }
+
+        if (result == 0)
+        {
+            // The connection is closed by the peer.
+            session->onErrorOccurred();
+            return;
+        }
+
+        session->pipe_size_[source] = static_cast<size_t>(result);
+        session->onDataRead(source, session->pipe_size_[source]);
+        session->updateBufferStat(source, kPipeSize, session->pipe_size_[source]);
+
+        doSpliceWrite(session, source);
+    });
+}
+
+// static
+void Session::doSpliceWrite(Session* session, int source)
+{
+    const int target = (source + kNumberOfSides - 1) % kNumberOfSides;
+
+    // Move all data from the pipe to the opposite socket.
+    while (session->pipe_size_[source])
+    {
+        ssize_t result = splice(session->pipe_[source][kPipeRead], nullptr,
+                                session->socket_[target].native_handle(), nullptr,
+                                session->pipe_size_[source], SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        if (result < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            if (errno != EAGAIN)
+            {
+                session->onErrorOccurred();
+                return;
+            }
+
+            // The send buffer of the socket is full. Wait until it becomes writable.
+            session->beginWriteStall(source);
+            session->socket_[target].async_wait(asio::ip::tcp::socket::wait_write,
+                                                [session, source](const std::error_code& error_code)
             {
                 if (error_code)
                 {
                     if (error_code != asio::error::operation_aborted)
                         session->onErrorOccurred();
+                    return;
                 }
-                else
-                {
-                    doReadSome(session, source);
-                }
+
+                session->endWriteStall(source);
+                doSpliceWrite(session, source);
             });
+            return;
         }
-    });
+
+        session->pipe_size_[source] -= static_cast<size_t>(result);
+        session->updateBufferStat(source, kPipeSize, session->pipe_size_[source]);
+    }
+
+    doSpliceRead(session, source);
 }
+#endif // defined(OS_LINUX)
 
 void Session::onErrorOccurred()
 {
@@ -114,4 +620,50 @@ void Session::onErrorOccurred()
     stop();
 }
 
+void Session::onDataRead(int source, size_t bytes)
+{
+    if (session_bucket_ || total_bucket_)
+    {
+        const base::TokenBucket::TimePoint now = base::TokenBucket::Clock::now();
+
+        if (session_bucket_)
+            session_bucket_->consume(static_cast<int64_t>(bytes), now);
+        if (total_bucket_)
+            total_bucket_->consume(static_cast<int64_t>(bytes), now);
+    }
+
+    // Only the session thread changes the counters, so atomic read-modify-write is not required.
+    DirectionStat& stat = stat_[source];
+
+    stat.bytes.store(stat.bytes.load(std::memory_order_relaxed) + static_cast<int64_t>(bytes),
+                     std::memory_order_relaxed);
+    stat.packets.store(stat.packets.load(std::memory_order_relaxed) + 1,
+                       std::memory_order_relaxed);
+}
+
+void Session::updateBufferStat(int source, size_t buffer_size, size_t buffer_usage)
+{
+    stat_[source].buffer_size.store(buffer_size, std::memory_order_relaxed);
+    stat_[source].buffer_usage.store(buffer_usage, std::memory_order_relaxed);
+}
+
+void Session::beginWriteStall(int source)
+{
+    write_stall_start_[source] = std::chrono::steady_clock::now();
+}
+
+void Session::endWriteStall(int source)
+{
+    if (write_stall_start_[source] == std::chrono::steady_clock::time_point())
+        return;
+
+    const int64_t time = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - write_stall_start_[source]).count();
+    write_stall_start_[source] = std::chrono::steady_clock::time_point();
+
+    DirectionStat& stat = stat_[source];
+    stat.write_stall_time.store(stat.write_stall_time.load(std::memory_order_relaxed) + time,
+                                std::memory_order_relaxed);
+}
+
 } // namespace relay
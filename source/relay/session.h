@@ -20,15 +20,42 @@
 #define RELAY__SESSION_H
 
 #include "base/macros_magic.h"
+#include "base/memory/ring_buffer.h"
+#include "build/build_config.h"
+#include "proto/router_relay.pb.h"
 
+#include <asio/steady_timer.hpp>
 #include <asio/ip/tcp.hpp>
 
+#include <atomic>
+
+namespace base {
+class BufferPool;
+class TaskRunner;
+class TokenBucket;
+} // namespace base
+
 namespace relay {
 
 class Session
 {
 public:
-    explicit Session(std::pair<asio::ip::tcp::socket, asio::ip::tcp::socket>&& sockets);
+    enum class Engine
+    {
+        // Data is copied through a buffer in user space.
+        BUFFER,
+
+        // Data is moved between sockets through a pipe inside the kernel using splice(2).
+        // Supported only on Linux. On other platforms BUFFER is used instead.
+        SPLICE
+    };
+
+    // |task_runner| must belong to the thread that runs the I/O context of |sockets|. All methods
+    // of the session (including the destructor) except duration(), bytesTransferred() and stat()
+    // must be called on this thread.
+    Session(std::shared_ptr<base::TaskRunner> task_runner,
+            std::pair<asio::ip::tcp::socket, asio::ip::tcp::socket>&& sockets,
+            Engine engine);
     ~Session();
 
     class Delegate
@@ -36,27 +63,132 @@ public:
     public:
         virtual ~Delegate() = default;
 
+        // Called on the thread of the session when the data transfer is finished.
         virtual void onSessionFinished(Session* session) = 0;
     };
 
+    // Sets the maximum size of the buffer for each direction of data transfer. The buffer grows
+    // from kMinBufferSize up to this size under sustained load and shrinks back when the load
+    // drops. If the size is equal to kMinBufferSize, then the buffer size is fixed. Must be called
+    // before start().
+    void setMaxBufferSize(size_t size);
+
+    // Sets the pool from which the buffers are taken. A buffer is held only while there is data
+    // to send, so idle sessions do not consume memory for buffers. If the pool is not set, then
+    // the buffers are allocated and freed each time. Must be called before start().
+    void setBufferPool(std::shared_ptr<base::BufferPool> buffer_pool);
+
+    // Limits the speed of data transfer. |session_bucket| limits the session in both directions,
+    // |total_bucket| is shared with other sessions. Any of them can be null. When the limit is
+    // reached, reading from the sockets is paused, so the peers slow down due to TCP flow control.
+    // Must be called before start().
+    void setRateLimit(std::unique_ptr<base::TokenBucket> session_bucket,
+                      std::shared_ptr<base::TokenBucket> total_bucket);
+
+    // Sets the identifier of the session reported in the statistics. Must be called before
+    // start().
+    void setId(uint64_t id) { id_ = id; }
+    uint64_t id() const { return id_; }
+
     void start(Delegate* delegate);
     void stop();
 
+    std::shared_ptr<base::TaskRunner> taskRunner() const { return task_runner_; }
+    Engine engine() const { return engine_; }
+
     std::chrono::seconds duration() const;
     int64_t bytesTransferred() const;
 
+    // Fills in the statistics of the session. |interval| is the time since the previous call and
+    // is used to calculate the current speed. The method can be called from any thread, but
+    // always from the same one.
+    void stat(const std::chrono::milliseconds& interval, proto::RelayStat::Session* stat);
+
+    static constexpr size_t kMinBufferSize = 8 * 1024;
+    static constexpr size_t kMaxBufferSize = 256 * 1024;
+
 private:
     static void doReadSome(Session* session, int source);
+    static void doWaitRead(Session* session, int source);
+    static void doWriteSome(Session* session, int source);
+    void adjustBufferSize(int source);
+    void acquireBuffer(int source);
+    void releaseBuffer(int source);
+    static bool waitForQuota(Session* session, int source, size_t* quota);
+#if defined(OS_LINUX)
+    bool initSplice();
+    static void doSpliceRead(Session* session, int source);
+    static void doSpliceWrite(Session* session, int source);
+#endif // defined(OS_LINUX)
     void onErrorOccurred();
 
+    void onDataRead(int source, size_t bytes);
+    void updateBufferStat(int source, size_t buffer_size, size_t buffer_usage);
+    void beginWriteStall(int source);
+    void endWriteStall(int source);
+
+    std::shared_ptr<base::TaskRunner> task_runner_;
+    Engine engine_;
+    uint64_t id_ = 0;
     std::chrono::time_point<std::chrono::high_resolution_clock> start_time_;
-    int64_t bytes_transferred_ = 0;
 
     static const int kNumberOfSides = 2;
-    static const int kBufferSize = 8192;
+
+    // Statistics of one direction of data transfer. Updated on the session thread and can be read
+    // from any thread.
+    struct DirectionStat
+    {
+        std::atomic<int64_t> bytes { 0 };
+        std::atomic<int64_t> packets { 0 };
+        std::atomic<int64_t> write_stall_time { 0 }; // In microseconds.
+        std::atomic<size_t> buffer_size { 0 };
+        std::atomic<size_t> buffer_usage { 0 };
+
+        // Used only by the thread that collects statistics.
+        int64_t sampled_bytes = 0;
+    };
+
+    DirectionStat stat_[kNumberOfSides];
+
+    // Time when reading from the socket was paused because the opposite socket does not accept
+    // data.
+    std::chrono::steady_clock::time_point write_stall_start_[kNumberOfSides];
 
     asio::ip::tcp::socket socket_[kNumberOfSides];
-    std::array<uint8_t, kBufferSize> buffer_[kNumberOfSides];
+
+    // Data received from the socket of the same index, but not yet sent to the opposite socket.
+    // Reading continues while the previous write is still in progress. When all data is sent, the
+    // buffer is returned to the pool and its capacity becomes zero.
+    base::RingBuffer buffer_[kNumberOfSides];
+    std::shared_ptr<base::BufferPool> buffer_pool_;
+    size_t max_buffer_size_ = kMaxBufferSize;
+
+    // Capacity of the buffer when it is taken from the pool.
+    size_t buffer_capacity_[kNumberOfSides] = { kMinBufferSize, kMinBufferSize };
+
+    bool reading_[kNumberOfSides] = { false, false };
+    bool writing_[kNumberOfSides] = { false, false };
+
+    // True if the peer has closed the connection. The remaining data is sent before the session
+    // is finished.
+    bool eof_[kNumberOfSides] = { false, false };
+
+    // Hints for changing the buffer size. Applied when there are no operations in progress.
+    bool grow_buffer_[kNumberOfSides] = { false, false };
+    int small_reads_[kNumberOfSides] = { 0, 0 };
+
+#if defined(OS_LINUX)
+    // Pipe for each direction of data transfer (read end and write end) and the number of bytes
+    // that are in the pipe.
+    int pipe_[kNumberOfSides][2] = { { -1, -1 }, { -1, -1 } };
+    size_t pipe_size_[kNumberOfSides] = { 0, 0 };
+#endif // defined(OS_LINUX)
+
+    // Speed limits. Reading from the socket waits on the timer of the same index until the
+    // buckets are refilled.
+    std::unique_ptr<base::TokenBucket> session_bucket_;
+    std::shared_ptr<base::TokenBucket> total_bucket_;
+    asio::steady_timer shaping_timer_[kNumberOfSides];
 
     Delegate* delegate_ = nullptr;
 
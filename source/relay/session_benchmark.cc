@@ -0,0 +1,251 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+
+// Benchmark of relay::Session with the buffered engine. One peer sends data through a session over
+// loopback and the opposite peer receives it. The throughput is compared for a fixed buffer of
+// Session::kMinBufferSize bytes and for an adaptive buffer that grows up to --max-buffer.
+//
+// Switches (all are optional, lists are separated by commas):
+//   --chunk=16384,262144   Size of one write of the sending peer in bytes.
+//   --max-buffer=262144    Maximum size of the adaptive buffer in bytes.
+//   --time=3000            Duration of each run in milliseconds.
+
+#include "base/command_line.h"
+#include "base/task_runner.h"
+#include "base/memory/buffer_pool.h"
+#include "base/message_loop/message_loop.h"
+#include "base/message_loop/message_pump_asio.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_printf.h"
+#include "base/strings/string_split.h"
+#include "base/strings/unicode.h"
+#include "relay/session.h"
+
+#include <asio/write.hpp>
+
+#include <iostream>
+#include <thread>
+
+namespace relay {
+
+namespace {
+
+struct Config
+{
+    size_t chunk_size = 16384;
+    size_t max_buffer_size = Session::kMinBufferSize;
+    std::chrono::milliseconds duration { 3000 };
+};
+
+// Data received before the measurement starts is not counted. The adaptive buffer grows during
+// this time.
+const std::chrono::milliseconds kWarmUpTime { 500 };
+
+class Delegate : public Session::Delegate
+{
+public:
+    Delegate() = default;
+    ~Delegate() override = default;
+
+    // Session::Delegate implementation.
+    void onSessionFinished(Session* /* session */) override
+    {
+        // Nothing
+    }
+
+private:
+    DISALLOW_COPY_AND_ASSIGN(Delegate);
+};
+
+// Sends data continuously from |sender| and receives it on |receiver|. |io_context| of the sockets
+// is run on the current thread.
+// Returns the throughput in bytes per second.
+double runPeers(const Config& config,
+                asio::io_context& io_context,
+                asio::ip::tcp::socket* sender,
+                asio::ip::tcp::socket* receiver)
+{
+    std::vector<uint8_t> write_buffer(config.chunk_size);
+    std::vector<uint8_t> read_buffer(std::max(config.chunk_size, Session::kMaxBufferSize));
+    int64_t received = 0;
+
+    std::function<void()> do_write = [&]()
+    {
+        asio::async_write(*sender, asio::buffer(write_buffer),
+                          [&](const std::error_code& error_code, size_t /* bytes_transferred */)
+        {
+            if (!error_code)
+                do_write();
+        });
+    };
+
+    std::function<void()> do_read = [&]()
+    {
+        receiver->async_read_some(asio::buffer(read_buffer),
+            [&](const std::error_code& error_code, size_t bytes_transferred)
+        {
+            if (error_code)
+                return;
+
+            received += static_cast<int64_t>(bytes_transferred);
+            do_read();
+        });
+    };
+
+    do_write();
+    do_read();
+
+    io_context.run_for(kWarmUpTime);
+
+    const int64_t start_received = received;
+    const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+    io_context.run_for(config.duration);
+
+    const double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+    // Handlers that are not completed refer to the local variables.
+    std::error_code ignored_code;
+    sender->close(ignored_code);
+    receiver->close(ignored_code);
+    io_context.run();
+
+    return static_cast<double>(received - start_received) / seconds;
+}
+
+double runBenchmark(const Config& config)
+{
+    base::MessageLoop message_loop(base::MessageLoop::Type::ASIO);
+    std::shared_ptr<base::TaskRunner> task_runner = message_loop.taskRunner();
+    asio::io_context& io_context = message_loop.pumpAsio()->ioContext();
+
+    asio::ip::tcp::acceptor acceptor(
+        io_context, asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+
+    // The peers run their own I/O context on a separate thread.
+    asio::io_context peers_io_context;
+    asio::ip::tcp::socket sender(peers_io_context);
+    asio::ip::tcp::socket receiver(peers_io_context);
+
+    std::error_code error_code;
+
+    sender.connect(acceptor.local_endpoint(), error_code);
+    if (error_code)
+        return 0;
+
+    asio::ip::tcp::socket first = acceptor.accept(error_code);
+    if (error_code)
+        return 0;
+
+    receiver.connect(acceptor.local_endpoint(), error_code);
+    if (error_code)
+        return 0;
+
+    asio::ip::tcp::socket second = acceptor.accept(error_code);
+    if (error_code)
+        return 0;
+
+    Session session(task_runner, std::make_pair(std::move(first), std::move(second)),
+                    Session::Engine::BUFFER);
+    session.setMaxBufferSize(config.max_buffer_size);
+    session.setBufferPool(std::make_shared<base::BufferPool>(Session::kMaxBufferSize * 2));
+
+    Delegate delegate;
+    session.start(&delegate);
+
+    double bytes_per_second = 0;
+
+    std::thread peers_thread([&]()
+    {
+        bytes_per_second = runPeers(config, peers_io_context, &sender, &receiver);
+        task_runner->postQuit();
+    });
+
+    message_loop.run();
+    peers_thread.join();
+
+    return bytes_per_second;
+}
+
+std::vector<size_t> parseList(const base::CommandLine& command_line,
+                              std::u16string_view name,
+                              const std::vector<size_t>& default_value)
+{
+    if (!command_line.hasSwitch(name))
+        return default_value;
+
+    std::vector<size_t> result;
+
+    for (const auto& item : base::splitString(command_line.switchValue(name), u",",
+                                              base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY))
+    {
+        int64_t value;
+        if (!base::stringToInt64(item, &value) || value <= 0)
+        {
+            std::cout << "Invalid value of --" << base::utf8FromUtf16(name) << ": "
+                      << base::utf8FromUtf16(item) << std::endl;
+            exit(1);
+        }
+
+        result.push_back(static_cast<size_t>(value));
+    }
+
+    return result;
+}
+
+} // namespace
+
+} // namespace relay
+
+int main(int argc, const char* const* argv)
+{
+    base::CommandLine::init(argc, argv);
+    const base::CommandLine& command_line = *base::CommandLine::forCurrentProcess();
+
+    const std::vector<size_t> chunk_sizes =
+        relay::parseList(command_line, u"chunk", { 16384, 262144 });
+    const size_t max_buffer_size =
+        relay::parseList(command_line, u"max-buffer", { relay::Session::kMaxBufferSize })[0];
+    const std::chrono::milliseconds duration(relay::parseList(command_line, u"time", { 3000 })[0]);
+
+    std::cout << base::stringPrintf("%-36s %10s", "Benchmark", "MB/s") << std::endl;
+
+    for (size_t chunk_size : chunk_sizes)
+    {
+        for (bool adaptive : { false, true })
+        {
+            relay::Config config;
+            config.chunk_size = chunk_size;
+            config.max_buffer_size = adaptive ? max_buffer_size : relay::Session::kMinBufferSize;
+            config.duration = duration;
+
+            const double megabytes_per_second = relay::runBenchmark(config) / 1e6;
+
+            std::string name = base::stringPrintf(
+                "%s/chunk:%zu/buffer:%zu", adaptive ? "adaptive" : "fixed",
+                config.chunk_size, config.max_buffer_size);
+
+            std::cout << base::stringPrintf("%-36s %10.1f", name.c_str(), megabytes_per_second)
+                      << std::endl;
+        }
+    }
+
+    return 0;
+}
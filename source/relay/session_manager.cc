@@ -21,7 +21,11 @@
 #include "base/logging.h"
 #include "base/task_runner.h"
 #include "base/message_loop/message_loop.h"
+#include "base/memory/buffer_pool.h"
 #include "base/message_loop/message_pump_asio.h"
+#include "base/net/socket_profile.h"
+#include "base/net/token_bucket.h"
+#include "base/threading/thread.h"
 #include "base/crypto/message_decryptor_openssl.h"
 #include "base/peer/host_id.h"
 
@@ -29,6 +33,18 @@ namespace relay {
 
 namespace {
 
+// The bucket holds the amount of data that can be transferred in 100 ms, but not less than
+// kMinBurstSize.
+const int64_t kMinBurstSize = 16 * 1024;
+
+// Maximum total size of unused session buffers kept for reuse.
+const size_t kMaxCachedBufferSize = 16 * 1024 * 1024;
+
+int64_t burstSize(int64_t rate)
+{
+    return std::max(rate / 10, kMinBurstSize);
+}
+
 // Decrypts an encrypted pair of peer identifiers using key |session_key|.
 base::ByteArray decryptSecret(const proto::PeerToRelay& message, const SessionKey& session_key)
 {
@@ -51,93 +67,257 @@ base::ByteArray decryptSecret(const proto::PeerToRelay& message, const SessionKe
     return target;
 }
 
-// Removes a session from the list and returns a pointer to it.
-template<class T>
-std::unique_ptr<T> removeSessionT(std::vector<std::unique_ptr<T>>* session_list, T* session)
+// Moves the socket to the I/O context |io_context|. The socket must not have pending
+// asynchronous operations.
+bool moveSocket(asio::ip::tcp::socket* socket, asio::io_context& io_context)
 {
-    session->stop();
+    std::error_code error_code;
 
-    auto it = session_list->begin();
-    while (it != session_list->end())
-    {
-        if (it->get() == session)
-            break;
+    asio::ip::tcp::endpoint endpoint = socket->local_endpoint(error_code);
+    if (error_code)
+        return false;
 
-        ++it;
-    }
+    // On Windows the operation is supported since Windows 8.1.
+    asio::ip::tcp::socket::native_handle_type native_handle = socket->release(error_code);
+    if (error_code)
+        return false;
 
-    if (it != session_list->end())
+    asio::ip::tcp::socket target(io_context);
+    target.assign(endpoint.protocol(), native_handle, error_code);
+    if (error_code)
     {
-        std::unique_ptr<T> result = std::move(*it);
-        session_list->erase(it);
-        return result;
+        // Return the handle to the original socket so that it is closed correctly.
+        socket->assign(endpoint.protocol(), native_handle, error_code);
+        return false;
     }
 
-    return nullptr;
+    *socket = std::move(target);
+    return true;
+}
+
+// Removes a session from the list and returns a pointer to it.
+template<class T>
+std::unique_ptr<T> removeSessionT(
+    std::unordered_map<T*, std::unique_ptr<T>>* session_list, T* session)
+{
+    auto it = session_list->find(session);
+    if (it == session_list->end())
+        return nullptr;
+
+    std::unique_ptr<T> result = std::move(it->second);
+    session_list->erase(it);
+    return result;
 }
 
 } // namespace
 
-SessionManager::SessionManager(std::shared_ptr<base::TaskRunner> task_runner, uint16_t port)
-    : task_runner_(std::move(task_runner)),
+SessionManager::SessionManager(std::shared_ptr<base::TaskRunner> task_runner,
+                               uint16_t port,
+                               size_t worker_thread_count)
+    : handle_(std::make_shared<Handle>()),
+      task_runner_(std::move(task_runner)),
+      buffer_pool_(std::make_shared<base::BufferPool>(kMaxCachedBufferSize)),
       acceptor_(base::MessageLoop::current()->pumpAsio()->ioContext(),
                 asio::ip::tcp::endpoint(asio::ip::tcp::v4(), port))
 {
     DCHECK(task_runner_);
+    handle_->manager = this;
+
+    if (!worker_thread_count)
+        worker_thread_count = std::max(std::thread::hardware_concurrency(), 1U);
+
+    LOG(LS_INFO) << "Worker thread count: " << worker_thread_count;
+
+    for (size_t i = 0; i < worker_thread_count; ++i)
+    {
+        worker_threads_.emplace_back(std::make_unique<base::Thread>());
+        worker_threads_.back()->start(base::MessageLoop::Type::ASIO);
+    }
 }
 
 SessionManager::~SessionManager()
 {
+    handle_->manager = nullptr;
+
     std::error_code ignored_code;
     acceptor_.cancel(ignored_code);
     acceptor_.close(ignored_code);
+
+    // Sessions must be destroyed on their own threads before these threads are stopped.
+    for (auto& session : active_sessions_)
+    {
+        std::shared_ptr<base::TaskRunner> session_task_runner = session.second->taskRunner();
+        session_task_runner->deleteSoon(std::move(session.second));
+    }
+
+    active_sessions_.clear();
+    worker_threads_.clear();
+}
+
+void SessionManager::setSessionEngine(Session::Engine engine)
+{
+    session_engine_ = engine;
+}
+
+void SessionManager::setMaxSessionBufferSize(size_t size)
+{
+    max_session_buffer_size_ = size;
+}
+
+void SessionManager::setRateLimit(int64_t session_rate, int64_t total_rate)
+{
+    session_rate_limit_ = session_rate;
+
+    if (total_rate > 0)
+        total_bucket_ = std::make_shared<base::TokenBucket>(total_rate, burstSize(total_rate));
+    else
+        total_bucket_.reset();
 }
 
 void SessionManager::start(std::unique_ptr<SharedPool> shared_pool)
 {
     shared_pool_ = std::move(shared_pool);
+    sample_time_ = std::chrono::steady_clock::now();
+
     SessionManager::doAccept(this);
 }
 
+uint16_t SessionManager::port() const
+{
+    std::error_code ignored_code;
+    return acceptor_.local_endpoint(ignored_code).port();
+}
+
+void SessionManager::stat(proto::RelayStat* stat)
+{
+    const std::chrono::steady_clock::time_point current_time = std::chrono::steady_clock::now();
+    const std::chrono::milliseconds interval =
+        std::chrono::duration_cast<std::chrono::milliseconds>(current_time - sample_time_);
+
+    int64_t bytes_transferred = finished_sessions_bytes_;
+
+    for (const auto& session : active_sessions_)
+    {
+        session.second->stat(interval, stat->add_session());
+        bytes_transferred += session.second->bytesTransferred();
+    }
+
+    stat->set_pending_sessions(static_cast<uint32_t>(pending_sessions_.size()));
+    stat->set_active_sessions(static_cast<uint32_t>(active_sessions_.size()));
+    stat->set_total_sessions(total_sessions_);
+    stat->set_bytes_transferred(bytes_transferred);
+
+    if (interval.count() > 0)
+        stat->set_speed((bytes_transferred - sampled_bytes_) * 1000 / interval.count());
+
+    sampled_bytes_ = bytes_transferred;
+    sample_time_ = current_time;
+}
+
 void SessionManager::onPendingSessionReady(
     PendingSession* session, const proto::PeerToRelay& message)
 {
     // Looking for a key with the specified identifier.
-    const SessionKey& session_key = shared_pool_->key(message.key_id());
-    if (session_key.isValid())
+    std::shared_ptr<const SessionKey> session_key = shared_pool_->key(message.key_id());
+    if (!session_key || !session_key->isValid())
+    {
+        // The key was not found in the pool.
+        removePendingSession(session);
+        return;
+    }
+
+    const uint64_t handshake_id = ++last_handshake_id_;
+    handshakes_[session] = handshake_id;
+
+    // Deriving the shared secret and decrypting the identifiers of peers are expensive, so they are
+    // performed on the worker threads and do not delay accepting new connections.
+    base::Thread* thread = worker_threads_[next_handshake_thread_].get();
+    next_handshake_thread_ = (next_handshake_thread_ + 1) % worker_threads_.size();
+
+    // The task must not access the manager, it can be destroyed while the task is running.
+    std::shared_ptr<base::TaskRunner> task_runner = task_runner_;
+    std::shared_ptr<Handle> handle = handle_;
+
+    thread->taskRunner()->postTask(
+        [task_runner, handle, session, handshake_id, session_key, message]()
     {
-        // Decrypt the identifiers of peers.
-        base::ByteArray secret = decryptSecret(message, session_key);
-        if (!secret.empty())
+        base::ByteArray secret = decryptSecret(message, *session_key);
+        const uint32_t key_id = message.key_id();
+
+        task_runner->postTask(
+            [handle, session, handshake_id, key_id, secret = std::move(secret)]()
         {
-            // Save the identifiers of peers and the identifier of their shared key.
-            session->setIdentify(message.key_id(), secret);
+            SessionManager* manager = handle->manager;
+            if (manager)
+                manager->onHandshakeFinished(session, handshake_id, key_id, secret);
+        });
+    });
+}
 
-            // Trying to find a peer that wants to be connected.
-            for (auto& other_session : pending_sessions_)
+void SessionManager::onHandshakeFinished(PendingSession* session,
+                                         uint64_t handshake_id,
+                                         uint32_t key_id,
+                                         const base::ByteArray& secret)
+{
+    auto handshake = handshakes_.find(session);
+    if (handshake == handshakes_.end() || handshake->second != handshake_id)
+    {
+        // The session was removed while the handshake was in progress.
+        return;
+    }
+
+    handshakes_.erase(handshake);
+
+    if (secret.empty())
+    {
+        // Unable to decrypt the identifiers of peers.
+        removePendingSession(session);
+        return;
+    }
+
+    // Save the identifiers of peers and the identifier of their shared key.
+    session->setIdentify(key_id, secret);
+
+    // Trying to find a peer that wants to be connected.
+    PendingSession* other_session = waiting_sessions_.takePeerOrAdd(session);
+    if (!other_session)
+    {
+        // The opposite peer is not connected yet.
+        return;
+    }
+
+    // Delete the key from the pool. It can no longer be used.
+    shared_pool_->removeKey(key_id);
+
+    // Now the opposite peer is found, start the data transfer between them.
+    std::unique_ptr<Session> new_session =
+        createSession(session->takeSocket(), other_session->takeSocket());
+    if (new_session)
+    {
+        Session* new_session_ptr = new_session.get();
+
+        new_session->setId(++total_sessions_);
+        new_session->setMaxBufferSize(max_session_buffer_size_);
+        new_session->setBufferPool(buffer_pool_);
+
+        if (session_rate_limit_ > 0 || total_bucket_)
+        {
+            std::unique_ptr<base::TokenBucket> session_bucket;
+            if (session_rate_limit_ > 0)
             {
-                if (session->isPeerFor(*other_session))
-                {
-                    // Delete the key from the pool. It can no longer be used.
-                    shared_pool_->removeKey(message.key_id());
-
-                    // Now the opposite peer is found, start the data transfer between them.
-                    active_sessions_.emplace_back(std::make_unique<Session>(
-                        std::make_pair(session->takeSocket(), other_session->takeSocket())));
-                    active_sessions_.back()->start(this);
-
-                    // Pending sessions are no longer needed, remove them.
-                    removePendingSession(other_session.get());
-                    removePendingSession(session);
-                    return;
-                }
+                session_bucket = std::make_unique<base::TokenBucket>(
+                    session_rate_limit_, burstSize(session_rate_limit_));
             }
 
-            return;
+            new_session->setRateLimit(std::move(session_bucket), total_bucket_);
         }
+
+        new_session->taskRunner()->postTask(std::bind(&Session::start, new_session_ptr, this));
+        active_sessions_.emplace(new_session_ptr, std::move(new_session));
     }
 
-    // The key was not found in the pool.
+    // Pending sessions are no longer needed, remove them.
+    removePendingSession(other_session);
     removePendingSession(session);
 }
 
@@ -148,7 +328,15 @@ void SessionManager::onPendingSessionFailed(PendingSession* session)
 
 void SessionManager::onSessionFinished(Session* session)
 {
-    removeSession(session);
+    // The method is called on the session thread.
+    std::shared_ptr<Handle> handle = handle_;
+
+    task_runner_->postTask([handle, session]()
+    {
+        SessionManager* manager = handle->manager;
+        if (manager)
+            manager->removeSession(session);
+    });
 }
 
 // static
@@ -160,10 +348,16 @@ void SessionManager::doAccept(SessionManager* session_manager)
         if (error_code)
             return;
 
+        base::applySocketProfile(
+            &socket, base::SocketProfile::forRole(base::SocketProfile::Role::RELAY_DATA));
+
         // A new peer is connected. Create and start the pending session.
-        session_manager->pending_sessions_.emplace_back(std::make_unique<PendingSession>(
-            session_manager->task_runner_, std::move(socket), session_manager));
-        session_manager->pending_sessions_.back()->start();
+        std::unique_ptr<PendingSession> pending_session = std::make_unique<PendingSession>(
+            session_manager->task_runner_, std::move(socket), session_manager);
+        PendingSession* pending_session_ptr = pending_session.get();
+
+        session_manager->pending_sessions_.emplace(pending_session_ptr, std::move(pending_session));
+        pending_session_ptr->start();
 
         // Waiting for the next connection.
         SessionManager::doAccept(session_manager);
@@ -172,12 +366,67 @@ void SessionManager::doAccept(SessionManager* session_manager)
 
 void SessionManager::removePendingSession(PendingSession* session)
 {
+    // If the session is waiting for the opposite peer, then remove it from the index.
+    waiting_sessions_.remove(session);
+
+    // The result of the handshake in progress (if any) will be ignored.
+    handshakes_.erase(session);
+
+    session->stop();
     task_runner_->deleteSoon(removeSessionT(&pending_sessions_, session));
 }
 
 void SessionManager::removeSession(Session* session)
 {
-    task_runner_->deleteSoon(removeSessionT(&active_sessions_, session));
+    std::unique_ptr<Session> removed_session = removeSessionT(&active_sessions_, session);
+    if (!removed_session)
+        return;
+
+    finished_sessions_bytes_ += removed_session->bytesTransferred();
+
+    // The session is stopped and destroyed on its own thread.
+    std::shared_ptr<base::TaskRunner> session_task_runner = removed_session->taskRunner();
+    session_task_runner->deleteSoon(std::move(removed_session));
+}
+
+std::unique_ptr<Session> SessionManager::createSession(
+    asio::ip::tcp::socket&& first, asio::ip::tcp::socket&& second)
+{
+    DCHECK(!worker_threads_.empty());
+
+    // Worker threads are selected in turn.
+    base::Thread* thread = worker_threads_[next_worker_thread_].get();
+    next_worker_thread_ = (next_worker_thread_ + 1) % worker_threads_.size();
+
+    asio::io_context& io_context = thread->messageLoop()->pumpAsio()->ioContext();
+
+    if (!moveSocket(&first, io_context))
+    {
+        LOG(LS_WARNING) << "Unable to move the session to the worker thread";
+
+        // The session will be processed in the current thread.
+        return std::make_unique<Session>(
+            task_runner_, std::make_pair(std::move(first), std::move(second)), session_engine_);
+    }
+
+    if (!moveSocket(&second, io_context))
+    {
+        LOG(LS_WARNING) << "Unable to move the second socket to the worker thread";
+
+        // Both sockets must be in the same context, so the first one is returned back.
+        if (!moveSocket(&first, base::MessageLoop::current()->pumpAsio()->ioContext()))
+        {
+            LOG(LS_ERROR) << "Unable to move the first socket back to the current thread";
+            return nullptr;
+        }
+
+        // The session will be processed in the current thread.
+        return std::make_unique<Session>(
+            task_runner_, std::make_pair(std::move(first), std::move(second)), session_engine_);
+    }
+
+    return std::make_unique<Session>(
+        thread->taskRunner(), std::make_pair(std::move(first), std::move(second)), session_engine_);
 }
 
 } // namespace relay
@@ -20,12 +20,19 @@
 #define RELAY__SESSION_MANAGER_H
 
 #include "proto/relay_peer.pb.h"
+#include "proto/router_relay.pb.h"
+#include "relay/peer_index.h"
 #include "relay/pending_session.h"
 #include "relay/session.h"
 #include "relay/shared_pool.h"
 
+#include <unordered_map>
+
 namespace base {
+class BufferPool;
 class TaskRunner;
+class Thread;
+class TokenBucket;
 } // namespace base
 
 namespace relay {
@@ -35,11 +42,31 @@ class SessionManager
       public Session::Delegate
 {
 public:
-    SessionManager(std::shared_ptr<base::TaskRunner> task_runner, uint16_t port);
+    // Peer pairs are distributed between |worker_thread_count| threads. If |worker_thread_count|
+    // is zero, then the number of threads is equal to the number of processor cores.
+    SessionManager(std::shared_ptr<base::TaskRunner> task_runner,
+                   uint16_t port,
+                   size_t worker_thread_count);
     ~SessionManager();
 
+    // Sets the engine used to transfer data between peers. Must be called before start().
+    void setSessionEngine(Session::Engine engine);
+
+    // Sets the maximum buffer size for sessions. Must be called before start().
+    void setMaxSessionBufferSize(size_t size);
+
+    // Sets the speed limits (in bytes per second) for each session and for all sessions together.
+    // Zero means no limit. Must be called before start().
+    void setRateLimit(int64_t session_rate, int64_t total_rate);
+
     void start(std::unique_ptr<SharedPool> shared_pool);
 
+    // Returns the port on which peers are accepted. Useful if the manager is created with port 0.
+    uint16_t port() const;
+
+    // Fills in the statistics of the relay and its active sessions.
+    void stat(proto::RelayStat* stat);
+
 protected:
     // PendingSession::Delegate implementation.
     void onPendingSessionReady(
@@ -50,18 +77,65 @@ protected:
     void onSessionFinished(Session* session) override;
 
 private:
+    // Points to the manager while it exists. Tasks posted from the worker threads to the thread
+    // of the manager hold it and do nothing if the manager is already destroyed. Used only on the
+    // thread of the manager.
+    struct Handle
+    {
+        SessionManager* manager = nullptr;
+    };
+
     static void doAccept(SessionManager* session_manager);
+    void onHandshakeFinished(PendingSession* session,
+                             uint64_t handshake_id,
+                             uint32_t key_id,
+                             const base::ByteArray& secret);
     void removePendingSession(PendingSession* sessions);
     void removeSession(Session* session);
+    std::unique_ptr<Session> createSession(
+        asio::ip::tcp::socket&& first, asio::ip::tcp::socket&& second);
 
+    std::shared_ptr<Handle> handle_;
     std::shared_ptr<base::TaskRunner> task_runner_;
 
+    // Threads that forward data between peers. Each of them runs its own I/O context.
+    std::vector<std::unique_ptr<base::Thread>> worker_threads_;
+    size_t next_worker_thread_ = 0;
+    size_t next_handshake_thread_ = 0;
+
+    Session::Engine session_engine_ = Session::Engine::BUFFER;
+    size_t max_session_buffer_size_ = Session::kMaxBufferSize;
+    int64_t session_rate_limit_ = 0;
+
+    // Buffers of sessions are taken from this pool only while there is data to send.
+    std::shared_ptr<base::BufferPool> buffer_pool_;
+
+    // Shared by all sessions. Null if the total speed is not limited.
+    std::shared_ptr<base::TokenBucket> total_bucket_;
+
     asio::ip::tcp::acceptor acceptor_;
-    std::vector<std::unique_ptr<PendingSession>> pending_sessions_;
-    std::vector<std::unique_ptr<Session>> active_sessions_;
+
+    // Sessions are indexed by their pointers, so they are removed in constant time.
+    std::unordered_map<PendingSession*, std::unique_ptr<PendingSession>> pending_sessions_;
+    std::unordered_map<Session*, std::unique_ptr<Session>> active_sessions_;
+
+    // Pending sessions whose messages are being decrypted on the worker threads. Each handshake
+    // has a unique identifier, so a result for an already removed session is ignored even if a
+    // new session has the same address.
+    std::unordered_map<PendingSession*, uint64_t> handshakes_;
+    uint64_t last_handshake_id_ = 0;
+
+    // Pending sessions that are authenticated and are waiting for the opposite peer.
+    PeerIndex waiting_sessions_;
 
     std::unique_ptr<SharedPool> shared_pool_;
 
+    // Aggregate statistics.
+    uint64_t total_sessions_ = 0;
+    int64_t finished_sessions_bytes_ = 0;
+    int64_t sampled_bytes_ = 0;
+    std::chrono::steady_clock::time_point sample_time_;
+
     DISALLOW_COPY_AND_ASSIGN(SessionManager);
 };
 
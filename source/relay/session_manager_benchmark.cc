@@ -0,0 +1,486 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+
+// Benchmark of the relay data plane. Pairs of peers connect to SessionManager over loopback,
+// authenticate with keys of the shared pool and then send data to each other in both directions.
+// The total throughput is measured for each number of worker threads. The peers run on one
+// separate thread, so the result shows how well the relay scales only while that thread and the
+// workers fit on the available cores.
+// The second table shows the rate of handshakes: all peers of the given number of pairs connect at
+// the same time and the time until every peer receives data from the opposite peer is measured.
+// The handshakes of the peers are decrypted on the worker threads of the relay.
+//
+// Switches (all are optional, lists are separated by commas):
+//   --threads=1,2,4,8    Number of worker threads of the relay.
+//   --sessions=64        Number of concurrent sessions.
+//   --pairs=1000         Number of pairs of peers that connect at the same time.
+//   --engine=buffer      Engine of sessions: buffer or splice.
+//   --time=3000          Duration of each run in milliseconds.
+
+#include "base/command_line.h"
+#include "base/endian_util.h"
+#include "base/logging.h"
+#include "base/task_runner.h"
+#include "base/crypto/generic_hash.h"
+#include "base/crypto/key_pair.h"
+#include "base/crypto/message_encryptor_openssl.h"
+#include "base/crypto/random.h"
+#include "base/crypto/scoped_crypto_initializer.h"
+#include "base/message_loop/message_loop.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_printf.h"
+#include "base/strings/string_split.h"
+#include "base/strings/unicode.h"
+#include "relay/session_manager.h"
+
+#include <asio/connect.hpp>
+#include <asio/read.hpp>
+#include <asio/write.hpp>
+
+#include <functional>
+#include <iostream>
+#include <thread>
+
+namespace relay {
+
+namespace {
+
+struct Config
+{
+    size_t threads = 1;
+    size_t sessions = 64;
+    size_t pairs = 1000;
+    Session::Engine engine = Session::Engine::BUFFER;
+    std::chrono::milliseconds duration { 3000 };
+};
+
+// Size of data sent by one write of a peer.
+const size_t kChunkSize = 64 * 1024;
+
+// Size of the secret that identifies a pair of peers.
+const size_t kSecretSize = 16;
+
+// Data received before the measurement starts is not counted. Buffers of the sessions grow during
+// this time.
+const std::chrono::milliseconds kWarmUpTime { 500 };
+
+// Creates the message with which a peer authenticates on the relay: the size of the message in
+// big endian and the serialized proto::PeerToRelay. The secret is encrypted with the session key
+// derived from the key of the relay with the identifier |key_id|.
+std::string createPeerMessage(uint32_t key_id,
+                              const base::ByteArray& relay_public_key,
+                              const base::ByteArray& iv,
+                              const base::ByteArray& secret)
+{
+    base::KeyPair key_pair = base::KeyPair::create(base::KeyPair::Type::X25519);
+    if (!key_pair.isValid())
+        return std::string();
+
+    base::ByteArray session_key = base::GenericHash::hash(
+        base::GenericHash::Type::BLAKE2s256, key_pair.sessionKey(relay_public_key));
+
+    std::unique_ptr<base::MessageEncryptor> encryptor =
+        base::MessageEncryptorOpenssl::createForChaCha20Poly1305(session_key, iv);
+    if (!encryptor)
+        return std::string();
+
+    std::string data;
+    data.resize(encryptor->encryptedDataSize(secret.size()));
+
+    if (!encryptor->encrypt(secret.data(), secret.size(), data.data()))
+        return std::string();
+
+    proto::PeerToRelay message;
+    message.set_key_id(key_id);
+    message.set_public_key(base::toStdString(key_pair.publicKey()));
+    message.set_data(std::move(data));
+
+    std::string serialized = message.SerializeAsString();
+    const uint32_t size = base::Endian::toBig(static_cast<uint32_t>(serialized.size()));
+
+    return std::string(reinterpret_cast<const char*>(&size), sizeof(size)) + serialized;
+}
+
+// One side of a session. Sends the authentication message, then sends data continuously and
+// counts the data received from the opposite peer.
+class Peer
+{
+public:
+    Peer(asio::io_context& io_context, int64_t* received);
+    ~Peer() = default;
+
+    bool connect(const asio::ip::tcp::endpoint& endpoint, const std::string& message);
+
+private:
+    static void doWrite(Peer* peer);
+    static void doRead(Peer* peer);
+
+    asio::ip::tcp::socket socket_;
+    std::vector<uint8_t> write_buffer_;
+    std::vector<uint8_t> read_buffer_;
+    int64_t* received_;
+
+    DISALLOW_COPY_AND_ASSIGN(Peer);
+};
+
+Peer::Peer(asio::io_context& io_context, int64_t* received)
+    : socket_(io_context),
+      write_buffer_(kChunkSize),
+      read_buffer_(kChunkSize),
+      received_(received)
+{
+    // Nothing
+}
+
+bool Peer::connect(const asio::ip::tcp::endpoint& endpoint, const std::string& message)
+{
+    std::error_code error_code;
+    socket_.connect(endpoint, error_code);
+    if (error_code)
+    {
+        LOG(LS_ERROR) << "Unable to connect: " << error_code.message();
+        return false;
+    }
+
+    socket_.set_option(asio::ip::tcp::no_delay(true), error_code);
+
+    // The data sent after the message is forwarded when the opposite peer is connected.
+    asio::write(socket_, asio::buffer(message), error_code);
+    if (error_code)
+    {
+        LOG(LS_ERROR) << "Unable to send the message: " << error_code.message();
+        return false;
+    }
+
+    Peer::doWrite(this);
+    Peer::doRead(this);
+    return true;
+}
+
+// static
+void Peer::doWrite(Peer* peer)
+{
+    asio::async_write(peer->socket_, asio::buffer(peer->write_buffer_),
+                      [peer](const std::error_code& error_code, size_t /* bytes_transferred */)
+    {
+        if (!error_code)
+            Peer::doWrite(peer);
+    });
+}
+
+// static
+void Peer::doRead(Peer* peer)
+{
+    peer->socket_.async_read_some(asio::buffer(peer->read_buffer_),
+        [peer](const std::error_code& error_code, size_t bytes_transferred)
+    {
+        if (error_code)
+            return;
+
+        *peer->received_ += static_cast<int64_t>(bytes_transferred);
+        Peer::doRead(peer);
+    });
+}
+
+// Runs the peers on the current thread and returns the throughput in bytes per second.
+double runPeers(const Config& config, uint16_t port, const std::vector<std::string>& messages)
+{
+    asio::io_context io_context;
+    asio::ip::tcp::endpoint endpoint(asio::ip::address_v4::loopback(), port);
+
+    int64_t received = 0;
+    std::vector<std::unique_ptr<Peer>> peers;
+
+    for (const auto& message : messages)
+    {
+        // Both peers of a pair send the same secret.
+        for (int i = 0; i < 2; ++i)
+        {
+            peers.emplace_back(std::make_unique<Peer>(io_context, &received));
+            if (!peers.back()->connect(endpoint, message))
+                return 0;
+        }
+    }
+
+    using Clock = std::chrono::steady_clock;
+
+    int64_t start_received = 0;
+    Clock::time_point start_time;
+
+    io_context.run_for(kWarmUpTime);
+    start_received = received;
+    start_time = Clock::now();
+
+    io_context.run_for(config.duration);
+
+    const double seconds = std::chrono::duration<double>(Clock::now() - start_time).count();
+    return static_cast<double>(received - start_received) / seconds;
+}
+
+// A peer that connects, authenticates and sends one byte to the opposite peer. The handshake is
+// complete when the byte of the opposite peer is received.
+class HandshakePeer
+{
+public:
+    HandshakePeer(asio::io_context& io_context, const std::string& message, size_t* completed);
+    ~HandshakePeer() = default;
+
+    void start(const asio::ip::tcp::endpoint& endpoint);
+
+private:
+    asio::ip::tcp::socket socket_;
+    std::string message_;
+    uint8_t byte_ = 0;
+    size_t* completed_;
+
+    DISALLOW_COPY_AND_ASSIGN(HandshakePeer);
+};
+
+HandshakePeer::HandshakePeer(asio::io_context& io_context,
+                             const std::string& message,
+                             size_t* completed)
+    : socket_(io_context),
+      message_(message + '\x01'),
+      completed_(completed)
+{
+    // Nothing
+}
+
+void HandshakePeer::start(const asio::ip::tcp::endpoint& endpoint)
+{
+    socket_.async_connect(endpoint, [this](const std::error_code& error_code)
+    {
+        if (error_code)
+        {
+            LOG(LS_ERROR) << "Unable to connect: " << error_code.message();
+            return;
+        }
+
+        // The byte after the message is forwarded when the opposite peer is connected.
+        asio::async_write(socket_, asio::buffer(message_),
+                          [this](const std::error_code& error_code, size_t /* bytes_transferred */)
+        {
+            if (error_code)
+            {
+                LOG(LS_ERROR) << "Unable to send the message: " << error_code.message();
+                return;
+            }
+
+            asio::async_read(socket_, asio::buffer(&byte_, sizeof(byte_)),
+                             [this](const std::error_code& error_code, size_t /* bytes */)
+            {
+                if (error_code)
+                {
+                    LOG(LS_ERROR) << "Unable to receive data: " << error_code.message();
+                    return;
+                }
+
+                ++*completed_;
+            });
+        });
+    });
+}
+
+// Runs the peers on the current thread and returns the number of handshakes per second.
+double runHandshakes(const Config& /* config */,
+                     uint16_t port,
+                     const std::vector<std::string>& messages)
+{
+    asio::io_context io_context;
+    asio::ip::tcp::endpoint endpoint(asio::ip::address_v4::loopback(), port);
+
+    size_t completed = 0;
+    std::vector<std::unique_ptr<HandshakePeer>> peers;
+
+    for (const auto& message : messages)
+    {
+        // Both peers of a pair send the same secret.
+        for (int i = 0; i < 2; ++i)
+            peers.emplace_back(std::make_unique<HandshakePeer>(io_context, message, &completed));
+    }
+
+    const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+    for (auto& peer : peers)
+        peer->start(endpoint);
+
+    // Returns when all peers are completed or failed.
+    io_context.run();
+
+    const double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+    if (completed != peers.size())
+    {
+        LOG(LS_ERROR) << "Completed " << completed << " of " << peers.size() << " handshakes";
+        return 0;
+    }
+
+    return static_cast<double>(completed) / seconds;
+}
+
+using PeersFunction =
+    std::function<double(const Config&, uint16_t, const std::vector<std::string>&)>;
+
+// Starts the relay with a key for each of |pair_count| pairs of peers and runs |peers| on a
+// separate thread. Returns the result of |peers|.
+double runBenchmark(const Config& config, size_t pair_count, const PeersFunction& peers)
+{
+    base::MessageLoop message_loop(base::MessageLoop::Type::ASIO);
+    std::shared_ptr<base::TaskRunner> task_runner = message_loop.taskRunner();
+
+    std::unique_ptr<SharedPool> shared_pool = std::make_unique<SharedPool>(pair_count);
+    std::vector<std::string> messages;
+
+    for (size_t i = 0; i < pair_count; ++i)
+    {
+        SessionKey session_key = SessionKey::create();
+        base::ByteArray public_key = session_key.publicKey();
+        base::ByteArray iv = session_key.iv();
+
+        uint32_t key_id = shared_pool->addKey(std::move(session_key));
+        if (key_id == SharedPool::kInvalidKeyId)
+            return 0;
+
+        messages.emplace_back(
+            createPeerMessage(key_id, public_key, iv, base::Random::byteArray(kSecretSize)));
+        if (messages.back().empty())
+            return 0;
+    }
+
+    SessionManager session_manager(task_runner, 0, config.threads);
+    session_manager.setSessionEngine(config.engine);
+    session_manager.start(std::move(shared_pool));
+
+    const uint16_t port = session_manager.port();
+    double result = 0;
+
+    std::thread peers_thread([&]()
+    {
+        result = peers(config, port, messages);
+        task_runner->postQuit();
+    });
+
+    message_loop.run();
+    peers_thread.join();
+
+    return result;
+}
+
+std::vector<size_t> parseList(const base::CommandLine& command_line,
+                              std::u16string_view name,
+                              const std::vector<size_t>& default_value)
+{
+    if (!command_line.hasSwitch(name))
+        return default_value;
+
+    std::vector<size_t> result;
+
+    for (const auto& item : base::splitString(command_line.switchValue(name), u",",
+                                              base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY))
+    {
+        int64_t value;
+        if (!base::stringToInt64(item, &value) || value <= 0)
+        {
+            std::cout << "Invalid value of --" << base::utf8FromUtf16(name) << ": "
+                      << base::utf8FromUtf16(item) << std::endl;
+            exit(1);
+        }
+
+        result.push_back(static_cast<size_t>(value));
+    }
+
+    return result;
+}
+
+} // namespace
+
+} // namespace relay
+
+int main(int argc, const char* const* argv)
+{
+    base::CommandLine::init(argc, argv);
+    const base::CommandLine& command_line = *base::CommandLine::forCurrentProcess();
+
+    base::ScopedCryptoInitializer crypto_initializer;
+    if (!crypto_initializer.isSucceeded())
+        return 1;
+
+    relay::Config config;
+
+    if (command_line.hasSwitch(u"engine"))
+    {
+        std::u16string engine = command_line.switchValue(u"engine");
+        if (engine == u"splice")
+        {
+            config.engine = relay::Session::Engine::SPLICE;
+        }
+        else if (engine != u"buffer")
+        {
+            std::cout << "Unknown engine: " << base::utf8FromUtf16(engine) << std::endl;
+            return 1;
+        }
+    }
+
+    const std::vector<size_t> threads = relay::parseList(command_line, u"threads", { 1, 2, 4, 8 });
+    config.sessions = relay::parseList(command_line, u"sessions", { 64 })[0];
+    config.pairs = relay::parseList(command_line, u"pairs", { 1000 })[0];
+    config.duration = std::chrono::milliseconds(
+        relay::parseList(command_line, u"time", { 3000 })[0]);
+
+    std::cout << base::stringPrintf("%-36s %10s %14s", "Benchmark", "MB/s", "MB/s per thread")
+              << std::endl;
+
+    for (size_t thread_count : threads)
+    {
+        config.threads = thread_count;
+
+        const double megabytes_per_second =
+            relay::runBenchmark(config, config.sessions, relay::runPeers) / 1e6;
+
+        std::string name = base::stringPrintf(
+            "%s/sessions:%zu/threads:%zu",
+            config.engine == relay::Session::Engine::SPLICE ? "splice" : "buffer",
+            config.sessions, config.threads);
+
+        std::cout << base::stringPrintf("%-36s %10.1f %14.1f", name.c_str(), megabytes_per_second,
+                                        megabytes_per_second / static_cast<double>(thread_count))
+                  << std::endl;
+    }
+
+    std::cout << std::endl << base::stringPrintf(
+        "%-36s %12s %16s", "Benchmark", "Handshakes/s", "Per thread") << std::endl;
+
+    for (size_t thread_count : threads)
+    {
+        config.threads = thread_count;
+
+        const double handshakes_per_second =
+            relay::runBenchmark(config, config.pairs, relay::runHandshakes);
+
+        std::string name = base::stringPrintf(
+            "handshake/pairs:%zu/threads:%zu", config.pairs, config.threads);
+
+        std::cout << base::stringPrintf("%-36s %12.0f %16.0f", name.c_str(), handshakes_per_second,
+                                        handshakes_per_second / static_cast<double>(thread_count))
+                  << std::endl;
+    }
+
+    return 0;
+}
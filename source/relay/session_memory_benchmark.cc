@@ -0,0 +1,292 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+
+// Benchmark of the memory used by idle relay sessions with the buffered engine. The sessions are
+// connected over loopback, one message is sent through each session in both directions and then
+// the peers are silent. The heap size is measured with the global allocation functions of this
+// program, so the memory of the sockets in the kernel is not counted. The heap used by the sockets
+// themselves is excluded too, because they are created before the first measurement. The buffers
+// kept in the pool for reuse are shown separately, because the size of the pool does not depend on
+// the number of sessions.
+// Each session uses four descriptors (two peers and two sockets of the relay), so the limit of
+// open files may need to be raised for large numbers of sessions.
+//
+// Switches (all are optional, lists are separated by commas):
+//   --sessions=100,1000,4000   Number of sessions.
+//   --message=1000             Size of the message sent by each peer in bytes.
+
+#include "base/command_line.h"
+#include "base/task_runner.h"
+#include "base/memory/buffer_pool.h"
+#include "base/message_loop/message_loop.h"
+#include "base/message_loop/message_pump_asio.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_printf.h"
+#include "base/strings/string_split.h"
+#include "base/strings/unicode.h"
+#include "relay/session.h"
+
+#include <asio/read.hpp>
+#include <asio/write.hpp>
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <thread>
+
+namespace {
+
+// Each block is prefixed with its size, so the total size of the allocated blocks is known.
+const size_t kHeaderSize = alignof(std::max_align_t);
+
+std::atomic<int64_t> g_heap_size { 0 };
+
+} // namespace
+
+void* operator new(size_t size)
+{
+    uint8_t* block = reinterpret_cast<uint8_t*>(std::malloc(size + kHeaderSize));
+    if (!block)
+        throw std::bad_alloc();
+
+    *reinterpret_cast<size_t*>(block) = size;
+    g_heap_size.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+
+    return block + kHeaderSize;
+}
+
+void operator delete(void* data) noexcept
+{
+    if (!data)
+        return;
+
+    uint8_t* block = reinterpret_cast<uint8_t*>(data) - kHeaderSize;
+    g_heap_size.fetch_sub(static_cast<int64_t>(*reinterpret_cast<size_t*>(block)),
+                          std::memory_order_relaxed);
+
+    std::free(block);
+}
+
+void operator delete(void* data, size_t /* size */) noexcept
+{
+    operator delete(data);
+}
+
+namespace relay {
+
+namespace {
+
+// Maximum total size of unused buffers kept for reuse (as in SessionManager).
+const size_t kMaxCachedBufferSize = 16 * 1024 * 1024;
+
+// Time for the sessions to complete the forwarding and release the buffers.
+const std::chrono::milliseconds kSettleTime { 200 };
+
+struct Result
+{
+    double started = 0; // Heap bytes per session after the start.
+    double idle = 0; // Heap bytes per session after the message was forwarded (without the pool).
+    size_t cached = 0; // Total size of the buffers in the pool.
+};
+
+class Delegate : public Session::Delegate
+{
+public:
+    Delegate() = default;
+    ~Delegate() override = default;
+
+    // Session::Delegate implementation.
+    void onSessionFinished(Session* /* session */) override
+    {
+        // Nothing
+    }
+
+private:
+    DISALLOW_COPY_AND_ASSIGN(Delegate);
+};
+
+// Sends the message from each peer and receives the message of the opposite peer.
+bool exchangeMessages(std::vector<std::unique_ptr<asio::ip::tcp::socket>>* peers,
+                      size_t message_size)
+{
+    std::vector<uint8_t> message(message_size);
+    std::error_code error_code;
+
+    for (auto& peer : *peers)
+    {
+        asio::write(*peer, asio::buffer(message), error_code);
+        if (error_code)
+            return false;
+    }
+
+    for (auto& peer : *peers)
+    {
+        asio::read(*peer, asio::buffer(message), error_code);
+        if (error_code)
+            return false;
+    }
+
+    return true;
+}
+
+Result runBenchmark(size_t session_count, size_t message_size)
+{
+    base::MessageLoop message_loop(base::MessageLoop::Type::ASIO);
+    std::shared_ptr<base::TaskRunner> task_runner = message_loop.taskRunner();
+
+    asio::ip::tcp::acceptor acceptor(message_loop.pumpAsio()->ioContext(),
+                                     asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+
+    // The peers use blocking operations on a separate thread.
+    asio::io_context peers_io_context;
+    std::vector<std::unique_ptr<asio::ip::tcp::socket>> peers;
+    std::vector<std::pair<asio::ip::tcp::socket, asio::ip::tcp::socket>> sockets;
+
+    for (size_t i = 0; i < session_count; ++i)
+    {
+        asio::ip::tcp::socket accepted[2] =
+        {
+            asio::ip::tcp::socket(peers_io_context),
+            asio::ip::tcp::socket(peers_io_context)
+        };
+
+        for (int side = 0; side < 2; ++side)
+        {
+            std::error_code error_code;
+
+            peers.emplace_back(std::make_unique<asio::ip::tcp::socket>(peers_io_context));
+            peers.back()->connect(acceptor.local_endpoint(), error_code);
+            if (!error_code)
+                accepted[side] = acceptor.accept(error_code);
+
+            if (error_code)
+            {
+                std::cout << "Unable to connect: " << error_code.message() << std::endl;
+                return Result();
+            }
+        }
+
+        sockets.emplace_back(std::move(accepted[0]), std::move(accepted[1]));
+    }
+
+    std::shared_ptr<base::BufferPool> buffer_pool =
+        std::make_shared<base::BufferPool>(kMaxCachedBufferSize);
+    std::vector<std::unique_ptr<Session>> sessions;
+    Delegate delegate;
+
+    sessions.reserve(session_count);
+
+    const int64_t initial_heap_size = g_heap_size.load();
+
+    for (auto& pair : sockets)
+    {
+        sessions.emplace_back(std::make_unique<Session>(task_runner, std::move(pair),
+                                                        Session::Engine::BUFFER));
+        sessions.back()->setBufferPool(buffer_pool);
+        sessions.back()->start(&delegate);
+    }
+
+    Result result;
+
+    std::thread peers_thread([&]()
+    {
+        std::this_thread::sleep_for(kSettleTime);
+        result.started =
+            static_cast<double>(g_heap_size.load() - initial_heap_size) / session_count;
+
+        if (exchangeMessages(&peers, message_size))
+        {
+            std::this_thread::sleep_for(kSettleTime);
+            result.cached = buffer_pool->cachedSize();
+            result.idle = static_cast<double>(
+                g_heap_size.load() - initial_heap_size - static_cast<int64_t>(result.cached)) /
+                session_count;
+        }
+        else
+        {
+            std::cout << "Unable to exchange messages" << std::endl;
+        }
+
+        task_runner->postQuit();
+    });
+
+    message_loop.run();
+    peers_thread.join();
+
+    return result;
+}
+
+std::vector<size_t> parseList(const base::CommandLine& command_line,
+                              std::u16string_view name,
+                              const std::vector<size_t>& default_value)
+{
+    if (!command_line.hasSwitch(name))
+        return default_value;
+
+    std::vector<size_t> result;
+
+    for (const auto& item : base::splitString(command_line.switchValue(name), u",",
+                                              base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY))
+    {
+        int64_t value;
+        if (!base::stringToInt64(item, &value) || value <= 0)
+        {
+            std::cout << "Invalid value of --" << base::utf8FromUtf16(name) << ": "
+                      << base::utf8FromUtf16(item) << std::endl;
+            exit(1);
+        }
+
+        result.push_back(static_cast<size_t>(value));
+    }
+
+    return result;
+}
+
+} // namespace
+
+} // namespace relay
+
+int main(int argc, const char* const* argv)
+{
+    base::CommandLine::init(argc, argv);
+    const base::CommandLine& command_line = *base::CommandLine::forCurrentProcess();
+
+    const std::vector<size_t> session_counts =
+        relay::parseList(command_line, u"sessions", { 100, 1000, 4000 });
+    const size_t message_size = relay::parseList(command_line, u"message", { 1000 })[0];
+
+    std::cout << base::stringPrintf("%-36s %14s %14s %12s",
+                                    "Benchmark", "Started B/ses", "Idle B/ses", "Pool KB")
+              << std::endl;
+
+    for (size_t session_count : session_counts)
+    {
+        const relay::Result result = relay::runBenchmark(session_count, message_size);
+
+        std::string name = base::stringPrintf(
+            "idle/sessions:%zu/message:%zu", session_count, message_size);
+
+        std::cout << base::stringPrintf("%-36s %14.0f %14.0f %12zu", name.c_str(), result.started,
+                                        result.idle, result.cached / 1024)
+                  << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,261 @@
+//
+// Aspia Project
+// Copyright (C) 2020 Dmitry Chapyshev <dmitry@aspia.ru>
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <https://www.gnu.org/licenses/>.
+//
+
+
+#include "relay/session.h"
+
+#include "base/task_runner.h"
+#include "base/message_loop/message_loop.h"
+#include "base/message_loop/message_pump_asio.h"
+#include "base/net/token_bucket.h"
+
+#include <asio/write.hpp>
+#include <gtest/gtest.h>
+
+#include <thread>
+
+namespace relay {
+
+namespace {
+
+// Data received before the measurement starts is not counted. The buckets are initially full, so
+// the sessions transfer data faster than the limit during this time.
+const std::chrono::milliseconds kWarmUpTime { 300 };
+const std::chrono::milliseconds kMeasureTime { 1500 };
+
+const size_t kChunkSize = 16 * 1024;
+
+class Delegate : public Session::Delegate
+{
+public:
+    Delegate() = default;
+    ~Delegate() override = default;
+
+    // Session::Delegate implementation.
+    void onSessionFinished(Session* /* session */) override
+    {
+        // Nothing
+    }
+
+private:
+    DISALLOW_COPY_AND_ASSIGN(Delegate);
+};
+
+// The first peer sends data continuously, the second one receives it through the session.
+class Peers
+{
+public:
+    explicit Peers(asio::io_context& io_context)
+        : sender(io_context),
+          receiver(io_context),
+          write_buffer_(kChunkSize),
+          read_buffer_(kChunkSize)
+    {
+        // Nothing
+    }
+
+    void start()
+    {
+        Peers::doWrite(this);
+        Peers::doRead(this);
+    }
+
+    asio::ip::tcp::socket sender;
+    asio::ip::tcp::socket receiver;
+    int64_t received = 0;
+
+private:
+    static void doWrite(Peers* peers)
+    {
+        asio::async_write(peers->sender, asio::buffer(peers->write_buffer_),
+                          [peers](const std::error_code& error_code, size_t /* bytes */)
+        {
+            if (!error_code)
+                Peers::doWrite(peers);
+        });
+    }
+
+    static void doRead(Peers* peers)
+    {
+        peers->receiver.async_read_some(asio::buffer(peers->read_buffer_),
+            [peers](const std::error_code& error_code, size_t bytes_transferred)
+        {
+            if (error_code)
+                return;
+
+            peers->received += static_cast<int64_t>(bytes_transferred);
+            Peers::doRead(peers);
+        });
+    }
+
+    std::vector<uint8_t> write_buffer_;
+    std::vector<uint8_t> read_buffer_;
+
+    DISALLOW_COPY_AND_ASSIGN(Peers);
+};
+
+int64_t burstSize(int64_t rate)
+{
+    return std::max(rate / 10, int64_t(16 * 1024));
+}
+
+// Transfers data through several concurrent sessions over loopback and returns the speed of each
+// session in bytes per second. Session i is limited by its own bucket if |session_rates[i]| is not
+// zero. All sessions share a bucket with rate |total_rate|.
+std::vector<double> measureSpeed(const std::vector<int64_t>& session_rates, int64_t total_rate)
+{
+    base::MessageLoop message_loop(base::MessageLoop::Type::ASIO);
+    std::shared_ptr<base::TaskRunner> task_runner = message_loop.taskRunner();
+
+    asio::ip::tcp::acceptor acceptor(message_loop.pumpAsio()->ioContext(),
+                                     asio::ip::tcp::endpoint(asio::ip::address_v4::loopback(), 0));
+
+    std::shared_ptr<base::TokenBucket> total_bucket =
+        std::make_shared<base::TokenBucket>(total_rate, burstSize(total_rate));
+
+    // The peers run their own I/O context on a separate thread.
+    asio::io_context peers_io_context;
+    std::vector<std::unique_ptr<Peers>> peers;
+    std::vector<std::unique_ptr<Session>> sessions;
+    Delegate delegate;
+
+    for (int64_t session_rate : session_rates)
+    {
+        peers.emplace_back(std::make_unique<Peers>(peers_io_context));
+
+        std::error_code error_code;
+        peers.back()->sender.connect(acceptor.local_endpoint(), error_code);
+        asio::ip::tcp::socket first = acceptor.accept(error_code);
+        peers.back()->receiver.connect(acceptor.local_endpoint(), error_code);
+        asio::ip::tcp::socket second = acceptor.accept(error_code);
+
+        if (error_code)
+        {
+            ADD_FAILURE() << "Unable to connect: " << error_code.message();
+            return std::vector<double>();
+        }
+
+        std::unique_ptr<base::TokenBucket> session_bucket;
+        if (session_rate)
+        {
+            session_bucket =
+                std::make_unique<base::TokenBucket>(session_rate, burstSize(session_rate));
+        }
+
+        sessions.emplace_back(std::make_unique<Session>(
+            task_runner, std::make_pair(std::move(first), std::move(second)),
+            Session::Engine::BUFFER));
+        sessions.back()->setRateLimit(std::move(session_bucket), total_bucket);
+        sessions.back()->start(&delegate);
+
+        peers.back()->start();
+    }
+
+    std::vector<double> speed;
+
+    std::thread peers_thread([&]()
+    {
+        peers_io_context.run_for(kWarmUpTime);
+
+        std::vector<int64_t> start_received;
+        for (const auto& item : peers)
+            start_received.push_back(item->received);
+
+        const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+        peers_io_context.run_for(kMeasureTime);
+
+        const double seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+        for (size_t i = 0; i < peers.size(); ++i)
+        {
+            speed.push_back(
+                static_cast<double>(peers[i]->received - start_received[i]) / seconds);
+        }
+
+        // Complete the handlers before the peers are destroyed.
+        for (auto& item : peers)
+        {
+            std::error_code ignored_code;
+            item->sender.close(ignored_code);
+            item->receiver.close(ignored_code);
+        }
+
+        peers_io_context.run();
+        task_runner->postQuit();
+    });
+
+    message_loop.run();
+    peers_thread.join();
+
+    return speed;
+}
+
+} // namespace
+
+TEST(SessionTest, EqualShareOfTotalLimit)
+{
+    const size_t kSessionCount = 8;
+    const int64_t kTotalRate = 4 * 1024 * 1024;
+
+    std::vector<double> speed = measureSpeed(std::vector<int64_t>(kSessionCount, 0), kTotalRate);
+    ASSERT_EQ(speed.size(), kSessionCount);
+
+    double total_speed = 0;
+    for (double session_speed : speed)
+        total_speed += session_speed;
+
+    EXPECT_LT(total_speed, kTotalRate * 1.15);
+    EXPECT_GT(total_speed, kTotalRate * 0.85);
+
+    // No session takes the bandwidth of the others.
+    const double fair_share = static_cast<double>(kTotalRate) / kSessionCount;
+    for (size_t i = 0; i < kSessionCount; ++i)
+    {
+        EXPECT_GT(speed[i], fair_share * 0.7) << "Session " << i;
+        EXPECT_LT(speed[i], fair_share * 1.3) << "Session " << i;
+    }
+}
+
+TEST(SessionTest, SessionLimitWithinTotalLimit)
+{
+    const size_t kSessionCount = 8;
+    const int64_t kSessionRate = 256 * 1024;
+    const int64_t kTotalRate = 4 * 1024 * 1024;
+
+    // Only the first session has its own limit.
+    std::vector<int64_t> session_rates(kSessionCount, 0);
+    session_rates[0] = kSessionRate;
+
+    std::vector<double> speed = measureSpeed(session_rates, kTotalRate);
+    ASSERT_EQ(speed.size(), kSessionCount);
+
+    EXPECT_GT(speed[0], kSessionRate * 0.85);
+    EXPECT_LT(speed[0], kSessionRate * 1.15);
+
+    // The rest of the total bandwidth is shared equally by the other sessions.
+    const double fair_share =
+        static_cast<double>(kTotalRate - kSessionRate) / (kSessionCount - 1);
+    for (size_t i = 1; i < kSessionCount; ++i)
+    {
+        EXPECT_GT(speed[i], fair_share * 0.7) << "Session " << i;
+        EXPECT_LT(speed[i], fair_share * 1.3) << "Session " << i;
+    }
+}
+
+} // namespace relay
@@ -78,4 +78,74 @@ size_t Settings::maxPeerCount() const
     return impl_.get<size_t>("MaxPeerCount", 100);
 }
 
+void Settings::setWorkerThreadCount(size_t count)
+{
+    impl_.set<size_t>("WorkerThreadCount", count);
+}
+
+size_t Settings::workerThreadCount() const
+{
+    return impl_.get<size_t>("WorkerThreadCount", 0);
+}
+
+void Settings::setMaxSessionBufferSize(size_t size)
+{
+    impl_.set<size_t>("MaxSessionBufferSize", size);
+}
+
+size_t Settings::maxSessionBufferSize() const
+{
+    return impl_.get<size_t>("MaxSessionBufferSize", 256 * 1024);
+}
+
+void Settings::setZeroCopyForwarding(bool enable)
+{
+    impl_.set<bool>("ZeroCopyForwarding", enable);
+}
+
+bool Settings::zeroCopyForwarding() const
+{
+    return impl_.get<bool>("ZeroCopyForwarding", false);
+}
+
+void Settings::setSessionRateLimit(int64_t rate)
+{
+    impl_.set<int64_t>("SessionRateLimit", rate);
+}
+
+int64_t Settings::sessionRateLimit() const
+{
+    return impl_.get<int64_t>("SessionRateLimit", 0);
+}
+
+void Settings::setTotalRateLimit(int64_t rate)
+{
+    impl_.set<int64_t>("TotalRateLimit", rate);
+}
+
+int64_t Settings::totalRateLimit() const
+{
+    return impl_.get<int64_t>("TotalRateLimit", 0);
+}
+
+void Settings::setStatInterval(uint32_t seconds)
+{
+    impl_.set<uint32_t>("StatInterval", seconds);
+}
+
+uint32_t Settings::statInterval() const
+{
+    return impl_.get<uint32_t>("StatInterval", 60);
+}
+
+void Settings::setStatFile(const std::u16string& file)
+{
+    impl_.set<std::u16string>("StatFile", file);
+}
+
+std::u16string Settings::statFile() const
+{
+    return impl_.get<std::u16string>("StatFile");
+}
+
 } // namespace relay
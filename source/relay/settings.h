@@ -44,6 +44,39 @@ public:
     void setMaxPeerCount(size_t count);
     size_t maxPeerCount() const;
 
+    // Number of threads that forward data between peers. If zero, then the number of threads is
+    // equal to the number of processor cores.
+    void setWorkerThreadCount(size_t count);
+    size_t workerThreadCount() const;
+
+    // Maximum size of the buffer for each direction of data transfer in a session (in bytes).
+    void setMaxSessionBufferSize(size_t size);
+    size_t maxSessionBufferSize() const;
+
+    // Enables forwarding of data between peers inside the kernel (only on Linux).
+    void setZeroCopyForwarding(bool enable);
+    bool zeroCopyForwarding() const;
+
+    // Speed limit (in bytes per second) for each session in both directions together. If zero,
+    // then the speed is not limited.
+    void setSessionRateLimit(int64_t rate);
+    int64_t sessionRateLimit() const;
+
+    // Speed limit (in bytes per second) for all sessions together. If zero, then the speed is not
+    // limited.
+    void setTotalRateLimit(int64_t rate);
+    int64_t totalRateLimit() const;
+
+    // Interval (in seconds) of sending statistics to the router and writing them to the file. If
+    // zero, then statistics are not collected.
+    void setStatInterval(uint32_t seconds);
+    uint32_t statInterval() const;
+
+    // Path to the file to which statistics are written in the Prometheus text format. If empty,
+    // then statistics are only sent to the router.
+    void setStatFile(const std::u16string& file);
+    std::u16string statFile() const;
+
 private:
     base::JsonSettings impl_;
 };
@@ -18,58 +18,54 @@
 
 #include "relay/shared_pool.h"
 
-namespace relay {
-
-namespace {
-
-const SessionKey kInvalidKey;
+#include "base/threading/concurrent_id_map.h"
 
-} // namespace
+namespace relay {
 
 class SharedPool::Pool
 {
 public:
-    Pool() = default;
+    explicit Pool(size_t capacity);
     ~Pool() = default;
 
     uint32_t addKey(SessionKey&& session_key);
     bool removeKey(uint32_t key_id);
-    const SessionKey& key(uint32_t key_id) const;
+    std::shared_ptr<const SessionKey> key(uint32_t key_id) const;
     void clear();
 
 private:
-    std::map<uint32_t, SessionKey> map_;
-    uint32_t current_key_id_ = 0;
+    base::ConcurrentIdMap<SessionKey> map_;
+    std::atomic<uint32_t> current_key_id_ { 0 };
 
     DISALLOW_COPY_AND_ASSIGN(Pool);
 };
 
+SharedPool::Pool::Pool(size_t capacity)
+    : map_(capacity)
+{
+    // Nothing
+}
+
 uint32_t SharedPool::Pool::addKey(SessionKey&& session_key)
 {
-    uint32_t key_id = current_key_id_++;
-    map_.emplace(key_id, std::move(session_key));
+    uint32_t key_id = current_key_id_.fetch_add(1, std::memory_order_relaxed);
+    if (key_id == kInvalidKeyId)
+        key_id = current_key_id_.fetch_add(1, std::memory_order_relaxed);
+
+    if (!map_.add(key_id, std::make_shared<const SessionKey>(std::move(session_key))))
+        return kInvalidKeyId;
+
     return key_id;
 }
 
 bool SharedPool::Pool::removeKey(uint32_t key_id)
 {
-    auto result = map_.find(key_id);
-    if (result != map_.end())
-    {
-        map_.erase(result);
-        return true;
-    }
-
-    return false;
+    return map_.remove(key_id);
 }
 
-const SessionKey& SharedPool::Pool::key(uint32_t key_id) const
+std::shared_ptr<const SessionKey> SharedPool::Pool::key(uint32_t key_id) const
 {
-    auto result = map_.find(key_id);
-    if (result == map_.end())
-        return kInvalidKey;
-
-    return result->second;
+    return map_.find(key_id);
 }
 
 void SharedPool::Pool::clear()
@@ -77,8 +73,8 @@ void SharedPool::Pool::clear()
     map_.clear();
 }
 
-SharedPool::SharedPool()
-    : pool_(std::make_shared<Pool>())
+SharedPool::SharedPool(size_t capacity)
+    : pool_(std::make_shared<Pool>(capacity))
 {
     // Nothing
 }
@@ -106,7 +102,7 @@ bool SharedPool::removeKey(uint32_t key_id)
     return pool_->removeKey(key_id);
 }
 
-const SessionKey& SharedPool::key(uint32_t key_id) const
+std::shared_ptr<const SessionKey> SharedPool::key(uint32_t key_id) const
 {
     return pool_->key(key_id);
 }
@@ -21,21 +21,38 @@
 
 #include "relay/session_key.h"
 
+#include <limits>
+
 namespace relay {
 
+// Pool of session keys shared between several owners. The methods of the class are thread safe
+// and do not use locks, so the keys can be added on one thread while other threads find and
+// remove them.
 class SharedPool
 {
 public:
-    SharedPool();
+    // |capacity| is the maximum number of keys in the pool.
+    explicit SharedPool(size_t capacity = kDefaultCapacity);
     ~SharedPool();
 
     std::unique_ptr<SharedPool> share();
 
+    // Adds a key to the pool and returns its identifier. If the pool is full, then returns
+    // kInvalidKeyId.
     uint32_t addKey(SessionKey&& session_key);
     bool removeKey(uint32_t key_id);
-    const SessionKey& key(uint32_t key_id) const;
+
+    // Returns the key with identifier |key_id| or nullptr if it is not found. The key remains
+    // valid even if it is removed from the pool by another thread.
+    std::shared_ptr<const SessionKey> key(uint32_t key_id) const;
     void clear();
 
+    // The number of slots in the pool. The pool does not grow, because the lock-free map has a fixed
+    // number of slots. The router keeps much fewer unused keys for one relay, so keys are added
+    // to a full pool only if the router requests keys faster than the clients use them.
+    static const size_t kDefaultCapacity = 4096;
+    static const uint32_t kInvalidKeyId = std::numeric_limits<uint32_t>::max();
+
 private:
     class Pool;
     explicit SharedPool(std::shared_ptr<Pool> pool);
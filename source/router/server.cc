@@ -126,7 +126,21 @@ bool Server::start()
         proto::ROUTER_SESSION_HOST | proto::ROUTER_SESSION_RELAY);
 
     server_ = std::make_unique<base::NetworkServer>();
-    server_->start(port, this);
+
+    size_t accept_thread_count = settings.acceptThreadCount();
+    if (accept_thread_count == 1)
+    {
+        server_->start(port, this);
+    }
+    else
+    {
+        // Connections are accepted and authenticated on separate threads. Sessions are created on
+        // the current thread.
+        server_->start(port, accept_thread_count, [this]()
+        {
+            return authenticator_manager_->createThreadDelegate();
+        });
+    }
 
     return true;
 }
@@ -149,6 +163,7 @@ std::unique_ptr<proto::RelayList> Server::relayList() const
         relay->mutable_version()->CopyFrom(session_relay->version().toProto());
         relay->set_os_name(base::utf8FromUtf16(session_relay->osName()));
         relay->set_computer_name(base::utf8FromUtf16(session_relay->computerName()));
+        relay->mutable_stat()->CopyFrom(session_relay->stat());
     }
 
     result->set_error_code(proto::RelayList::SUCCESS);
@@ -237,6 +252,9 @@ void Server::onNewSession(base::ServerAuthenticatorManager::SessionInfo&& sessio
     LOG(LS_INFO) << "New session: " << sessionTypeToString(session_type)
                  << " (" << session_info.channel->peerAddress() << ")";
 
+    session_info.channel->setSocketProfile(
+        base::SocketProfile::forRole(base::SocketProfile::Role::ROUTER_CONTROL));
+
     std::unique_ptr<Session> session;
 
     switch (session_info.session_type)
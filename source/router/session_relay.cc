@@ -61,6 +61,10 @@ void SessionRelay::onMessageReceived(const base::ByteArray& buffer)
     {
         readKeyPool(message.key_pool());
     }
+    else if (message.has_stat())
+    {
+        stat_ = std::move(*message.mutable_stat());
+    }
     else
     {
         LOG(LS_WARNING) << "Unhandled message from relay server";
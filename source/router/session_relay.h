@@ -33,6 +33,9 @@ public:
 
     uint32_t poolSize() const;
 
+    // Returns the last statistics received from the relay.
+    const proto::RelayStat& stat() const { return stat_; }
+
 protected:
     // Session implementation.
     void onSessionReady() override;
@@ -46,6 +49,7 @@ private:
     void readKeyPool(const proto::RelayKeyPool& key_pool);
 
     std::vector<proto::RelayKey> pool_;
+    proto::RelayStat stat_;
 
     DISALLOW_COPY_AND_ASSIGN(SessionRelay);
 };
@@ -48,4 +48,14 @@ base::ByteArray Settings::privateKey() const
     return base::fromHex(impl_.get<std::string>("PrivateKey"));
 }
 
+void Settings::setAcceptThreadCount(size_t count)
+{
+    impl_.set<size_t>("AcceptThreadCount", count);
+}
+
+size_t Settings::acceptThreadCount() const
+{
+    return impl_.get<size_t>("AcceptThreadCount", 1);
+}
+
 } // namespace router
@@ -35,6 +35,11 @@ public:
     void setPrivateKey(const base::ByteArray& private_key);
     base::ByteArray privateKey() const;
 
+    // Number of threads that accept and authenticate connections. If the value is 0, then the
+    // number of processors is used.
+    void setAcceptThreadCount(size_t count);
+    size_t acceptThreadCount() const;
+
 private:
     base::JsonSettings impl_;
 };